@@ -837,6 +837,9 @@ int main(int argc, char *argv[])
 	struct pollfd  pfd[NUM_POLL_FDS];
 	pid_t process;
 	char buf[128];
+#ifdef MEMSHR
+	char *scan_budget;
+#endif
 
 	__init_blkif();
 	snprintf(buf, sizeof(buf), "BLKTAPCTRL[%d]", getpid());
@@ -861,6 +864,10 @@ int main(int argc, char *argv[])
 	}
 
 #ifdef MEMSHR
+	/* Content scanner CPU budget in percent, 0 disables it */
+	scan_budget = getenv("MEMSHR_SCAN_BUDGET");
+	if (scan_budget != NULL)
+		memshr_set_scan_budget(atoi(scan_budget));
 	memshr_daemon_initialize();
 #endif
 
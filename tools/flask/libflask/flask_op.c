@@ -443,6 +443,21 @@ int flask_avc_cachestats(int xc_handle, char *buf, int size)
     return 0;
 }
 
+int flask_hook_stats(int xc_handle, char *buf, int size)
+{
+    int err;
+    flask_op_t op;
+
+    op.cmd = FLASK_HOOK_STATS;
+    op.buf = buf;
+    op.size = size;
+
+    if ( (err = xc_flask_op(xc_handle, &op)) != 0 )
+        return err;
+
+    return 0;
+}
+
 int flask_policyvers(int xc_handle, char *buf, int size)
 {
     int err;
@@ -36,6 +36,7 @@ int flask_access(int xc_handle, const char *scon, const char *tcon,
                   u_int32_t *auditallow, u_int32_t *auditdeny,
                   u_int32_t *seqno);
 int flask_avc_cachestats(int xc_handle, char *buf, int size);
+int flask_hook_stats(int xc_handle, char *buf, int size);
 int flask_policyvers(int xc_handle, char *buf, int size);
 int flask_avc_hashstats(int xc_handle, char *buf, int size);
 int flask_getavc_threshold(int xc_handle);
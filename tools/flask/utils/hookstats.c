@@ -0,0 +1,71 @@
+/*
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License version 2,
+ *  as published by the Free Software Foundation.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <stdio.h>
+#include <xenctrl.h>
+#include <string.h>
+#include <unistd.h>
+#include <libflask.h>
+
+#define STATS_BUF_SIZE (64 * 1024)
+
+static void usage (int argCnt, const char *args[])
+{
+    fprintf(stderr, "Usage: %s\n", args[0]);
+    fprintf(stderr, "Print the permission checks made by each FLASK hook, "
+            "how many of them\nmissed the AVC, and how many cycles they "
+            "took.\n");
+    exit(1);
+}
+
+int main (int argCnt, const char *args[])
+{
+    int ret;
+    int xch = 0;
+    char *buf = NULL;
+
+    if (argCnt != 1)
+        usage(argCnt, args);
+
+    xch = xc_interface_open();
+    if ( xch < 0 )
+    {
+        fprintf(stderr, "Unable to create interface to xenctrl: %s\n",
+                strerror(errno));
+        ret = -1;
+        goto done;
+    }
+
+    buf = calloc(1, STATS_BUF_SIZE);
+    if ( buf == NULL )
+    {
+        fprintf(stderr, "Unable to allocate stats buffer\n");
+        ret = -1;
+        goto done;
+    }
+
+    ret = flask_hook_stats(xch, buf, STATS_BUF_SIZE - 1);
+    if ( ret < 0 )
+    {
+        errno = -ret;
+        fprintf(stderr, "Unable to get hook statistics: %s\n",
+                strerror(errno));
+        ret = -1;
+        goto done;
+    }
+
+    printf("%s", buf);
+
+done:
+    free(buf);
+    if ( xch )
+        xc_interface_close(xch);
+
+    return ret;
+}
@@ -0,0 +1 @@
+../../../xen/include/public/arch-x86_64.h
\ No newline at end of file
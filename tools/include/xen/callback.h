@@ -0,0 +1 @@
+../../../xen/include/public/callback.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../xen/include/public/domctl.h
\ No newline at end of file
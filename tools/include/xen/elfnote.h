@@ -0,0 +1 @@
+../../../xen/include/public/elfnote.h
\ No newline at end of file
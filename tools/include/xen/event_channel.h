@@ -0,0 +1 @@
+../../../xen/include/public/event_channel.h
\ No newline at end of file
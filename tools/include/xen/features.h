@@ -0,0 +1 @@
+../../../xen/include/public/features.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../xen/include/public/mem_event.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../xen/include/public/memory.h
\ No newline at end of file
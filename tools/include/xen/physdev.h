@@ -0,0 +1 @@
+../../../xen/include/public/physdev.h
\ No newline at end of file
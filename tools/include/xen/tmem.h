@@ -0,0 +1 @@
+../../../xen/include/public/tmem.h
\ No newline at end of file
@@ -0,0 +1 @@
+../../../xen/include/public/xenoprof.h
\ No newline at end of file
@@ -419,6 +419,83 @@ get_guest_width(int xc_handle,
     return 0;
 }
 
+/*
+ * Map a batch of guest frames with one bulk mapping and hand them to
+ * dump_rtn, mapping them one by one if the bulk mapping fails as a whole.
+ * Frames that cannot be mapped are dropped from the dump, as with the
+ * former page-at-a-time loop; the remaining ones are compacted into
+ * dump_mem before being written.
+ */
+static int
+dump_page_batch(int xc_handle, uint32_t domid, void *args,
+                dumpcore_rtn_t dump_rtn, char *dump_mem,
+                const uint64_t *pfns, const xen_pfn_t *gmfns, int *errs,
+                unsigned int nr, struct xen_dumpcore_p2m *p2m_array,
+                uint64_t *pfn_array, unsigned long *nr_dumped)
+{
+    char *vaddr, *page;
+    unsigned int i, n, nr_mapped = 0;
+    int sts;
+
+    if ( nr == 0 )
+        return 0;
+
+    vaddr = xc_map_foreign_bulk(xc_handle, domid, PROT_READ, gmfns, errs, nr);
+    if ( vaddr == NULL )
+    {
+        /* the batch as a whole couldn't be mapped: fall back to single pages */
+        for ( i = n = 0; i < nr; i++ )
+        {
+            page = xc_map_foreign_range(xc_handle, domid, PAGE_SIZE,
+                                        PROT_READ, gmfns[i]);
+            errs[i] = (page == NULL);
+            if ( page == NULL )
+                continue;
+            memcpy(dump_mem + (n++ * PAGE_SIZE), page, PAGE_SIZE);
+            munmap(page, PAGE_SIZE);
+        }
+    }
+
+    for ( i = 0; i < nr; i++ )
+    {
+        if ( errs[i] )
+            continue;
+
+        if ( p2m_array != NULL )
+        {
+            p2m_array[*nr_dumped].pfn = pfns[i];
+            p2m_array[*nr_dumped].gmfn = gmfns[i];
+        }
+        else
+            pfn_array[*nr_dumped] = pfns[i];
+        (*nr_dumped)++;
+        nr_mapped++;
+    }
+
+    /* the single pages are already compacted into dump_mem */
+    if ( vaddr == NULL )
+        return dump_rtn(args, dump_mem, nr_mapped * PAGE_SIZE);
+
+    if ( nr_mapped == nr )
+    {
+        /* common case: write straight from the mapping */
+        sts = dump_rtn(args, vaddr, nr * PAGE_SIZE);
+    }
+    else
+    {
+        nr_mapped = 0;
+        for ( i = 0; i < nr; i++ )
+            if ( !errs[i] )
+                memcpy(dump_mem + (nr_mapped++ * PAGE_SIZE),
+                       vaddr + (i * PAGE_SIZE), PAGE_SIZE);
+        sts = dump_rtn(args, dump_mem, nr_mapped * PAGE_SIZE);
+    }
+
+    munmap(vaddr, nr * PAGE_SIZE);
+
+    return sts;
+}
+
 int
 xc_domain_dumpcore_via_callback(int xc_handle,
                                 uint32_t domid,
@@ -431,7 +508,7 @@ xc_domain_dumpcore_via_callback(int xc_handle,
     struct domain_info_context *dinfo = &_dinfo;
 
     int nr_vcpus = 0;
-    char *dump_mem, *dump_mem_start = NULL;
+    char *dump_mem_start = NULL;
     vcpu_guest_context_any_t *ctxt = NULL;
     struct xc_core_arch_context arch_ctxt;
     char dummy[PAGE_SIZE];
@@ -442,6 +519,11 @@ xc_domain_dumpcore_via_callback(int xc_handle,
     unsigned long j;
     unsigned long nr_pages;
 
+    uint64_t *batch_pfn = NULL;
+    xen_pfn_t *batch_gmfn = NULL;
+    int *batch_err = NULL;
+    unsigned int nr_batch;
+
     xc_core_memory_map_t *memory_map = NULL;
     unsigned int nr_memory_map;
     unsigned int map_idx;
@@ -474,6 +556,14 @@ xc_domain_dumpcore_via_callback(int xc_handle,
         PERROR("Could not allocate dump_mem");
         goto out;
     }
+    batch_pfn = malloc(DUMP_INCREMENT * sizeof(batch_pfn[0]));
+    batch_gmfn = malloc(DUMP_INCREMENT * sizeof(batch_gmfn[0]));
+    batch_err = malloc(DUMP_INCREMENT * sizeof(batch_err[0]));
+    if ( batch_pfn == NULL || batch_gmfn == NULL || batch_err == NULL )
+    {
+        PERROR("Could not allocate page batch");
+        goto out;
+    }
 
     if ( xc_domain_getinfo(xc_handle, domid, 1, &info) != 1 )
     {
@@ -780,7 +870,7 @@ xc_domain_dumpcore_via_callback(int xc_handle,
 
     /* dump pages: .xen_pages */
     j = 0;
-    dump_mem = dump_mem_start;
+    nr_batch = 0;
     for ( map_idx = 0; map_idx < nr_memory_map; map_idx++ )
     {
         uint64_t pfn_start;
@@ -791,8 +881,19 @@ xc_domain_dumpcore_via_callback(int xc_handle,
         for ( i = pfn_start; i < pfn_end; i++ )
         {
             uint64_t gmfn;
-            void *vaddr;
-            
+
+            if ( j + nr_batch >= nr_pages )
+            {
+                /* frames of the pending batch may still fail to map */
+                sts = dump_page_batch(xc_handle, domid, args, dump_rtn,
+                                      dump_mem_start, batch_pfn, batch_gmfn,
+                                      batch_err, nr_batch, p2m_array,
+                                      pfn_array, &j);
+                if ( sts != 0 )
+                    goto out;
+                nr_batch = 0;
+            }
+
             if ( j >= nr_pages )
             {
                 /*
@@ -820,9 +921,6 @@ xc_domain_dumpcore_via_callback(int xc_handle,
                     if ( gmfn == (uint32_t)INVALID_P2M_ENTRY )
                        continue;
                 }
-
-                p2m_array[j].pfn = i;
-                p2m_array[j].gmfn = gmfn;
             }
             else
             {
@@ -830,33 +928,30 @@ xc_domain_dumpcore_via_callback(int xc_handle,
                     continue;
 
                 gmfn = i;
-                pfn_array[j] = i;
             }
 
-            vaddr = xc_map_foreign_range(
-                xc_handle, domid, PAGE_SIZE, PROT_READ, gmfn);
-            if ( vaddr == NULL )
-                continue;
-            memcpy(dump_mem, vaddr, PAGE_SIZE);
-            munmap(vaddr, PAGE_SIZE);
-            dump_mem += PAGE_SIZE;
-            if ( (j + 1) % DUMP_INCREMENT == 0 )
+            batch_pfn[nr_batch] = i;
+            batch_gmfn[nr_batch] = gmfn;
+            if ( ++nr_batch == DUMP_INCREMENT )
             {
-                sts = dump_rtn(
-                    args, dump_mem_start, dump_mem - dump_mem_start);
+                sts = dump_page_batch(xc_handle, domid, args, dump_rtn,
+                                      dump_mem_start, batch_pfn, batch_gmfn,
+                                      batch_err, nr_batch, p2m_array,
+                                      pfn_array, &j);
                 if ( sts != 0 )
                     goto out;
-                dump_mem = dump_mem_start;
+                nr_batch = 0;
             }
-
-            j++;
         }
     }
 
-copy_done:
-    sts = dump_rtn(args, dump_mem_start, dump_mem - dump_mem_start);
+    sts = dump_page_batch(xc_handle, domid, args, dump_rtn, dump_mem_start,
+                          batch_pfn, batch_gmfn, batch_err, nr_batch,
+                          p2m_array, pfn_array, &j);
     if ( sts != 0 )
         goto out;
+
+copy_done:
     if ( j < nr_pages )
     {
         /* When live dump-mode (-L option) is specified,
@@ -912,6 +1007,9 @@ out:
         free(ctxt);
     if ( dump_mem_start != NULL )
         free(dump_mem_start);
+    free(batch_pfn);
+    free(batch_gmfn);
+    free(batch_err);
     if ( live_shinfo != NULL )
         munmap(live_shinfo, PAGE_SIZE);
     xc_core_arch_context_free(&arch_ctxt);
@@ -924,15 +1022,49 @@ struct dump_args {
     int     fd;
 };
 
-/* Callback routine for writing to a local dump file. */
+static int page_is_zero(const char *page)
+{
+    const unsigned long *p = (const unsigned long *)page;
+    unsigned int i;
+
+    for ( i = 0; i < PAGE_SIZE / sizeof(*p); i++ )
+        if ( p[i] )
+            return 0;
+    return 1;
+}
+
+/*
+ * Callback routine for writing to a local dump file.  Whole zero pages are
+ * skipped with lseek() so they end up as holes: the file reads back
+ * identically but a mostly idle guest no longer costs its full size on disk.
+ */
 static int local_file_dump(void *args, char *buffer, unsigned int length)
 {
     struct dump_args *da = args;
+    unsigned int done, chunk;
 
-    if ( write_exact(da->fd, buffer, length) == -1 )
+    for ( done = 0; done < length; done += chunk )
     {
-        PERROR("Failed to write buffer");
-        return -errno;
+        chunk = length - done;
+        if ( chunk >= PAGE_SIZE )
+        {
+            chunk = PAGE_SIZE;
+            if ( page_is_zero(buffer + done) )
+            {
+                if ( lseek(da->fd, PAGE_SIZE, SEEK_CUR) == -1 )
+                {
+                    PERROR("Failed to seek over zero page");
+                    return -errno;
+                }
+                continue;
+            }
+        }
+
+        if ( write_exact(da->fd, buffer + done, chunk) == -1 )
+        {
+            PERROR("Failed to write buffer");
+            return -errno;
+        }
     }
 
     if ( length >= (DUMP_INCREMENT * PAGE_SIZE) )
@@ -951,6 +1083,7 @@ xc_domain_dumpcore(int xc_handle,
                    const char *corename)
 {
     struct dump_args da;
+    off_t end;
     int sts;
 
     if ( (da.fd = open(corename, O_CREAT|O_RDWR|O_TRUNC, S_IWUSR|S_IRUSR)) < 0 )
@@ -962,6 +1095,14 @@ xc_domain_dumpcore(int xc_handle,
     sts = xc_domain_dumpcore_via_callback(
         xc_handle, domid, &da, &local_file_dump);
 
+    /* a trailing hole only exists once the file size covers it */
+    end = lseek(da.fd, 0, SEEK_CUR);
+    if ( sts == 0 && end != -1 && ftruncate(da.fd, end) == -1 )
+    {
+        PERROR("Could not extend corefile %s", corename);
+        sts = -errno;
+    }
+
     /* flush and discard any remaining portion of the file from cache */
     discard_file_cache(da.fd, 1/* flush first*/);
 
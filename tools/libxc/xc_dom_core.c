@@ -16,6 +16,9 @@
 #include <stdarg.h>
 #include <inttypes.h>
 #include <zlib.h>
+#ifndef __MINIOS__
+#include <pthread.h>
+#endif
 
 #include "xg_private.h"
 #include "xc_dom.h"
@@ -266,7 +269,8 @@ int xc_dom_try_gunzip(struct xc_dom_image *dom, void **blob, size_t * size)
     if ( unziplen == 0 )
         return 0;
 
-    unzip = xc_dom_malloc(dom, unziplen);
+    /* anonymous mapping: no need to clear memory we are about to fill */
+    unzip = xc_dom_malloc_page_aligned(dom, unziplen);
     if ( unzip == NULL )
         return -1;
 
@@ -724,9 +728,34 @@ int xc_dom_update_guest_p2m(struct xc_dom_image *dom)
     return 0;
 }
 
+#ifndef __MINIOS__
+struct ramdisk_unzip {
+    void *src;
+    size_t srclen;
+    void *dst;
+    size_t dstlen;
+    int rc;
+};
+
+static void *ramdisk_unzip_thread(void *arg)
+{
+    struct ramdisk_unzip *unzip = arg;
+
+    unzip->rc = xc_dom_do_gunzip(unzip->src, unzip->srclen,
+                                 unzip->dst, unzip->dstlen);
+    return NULL;
+}
+#endif
+
 int xc_dom_build_image(struct xc_dom_image *dom)
 {
     unsigned int page_size;
+    int rc = 0;
+#ifndef __MINIOS__
+    struct ramdisk_unzip unzip;
+    pthread_t unzip_thread;
+    int unzip_running = 0;
+#endif
 
     xc_dom_printf("%s: called\n", __FUNCTION__);
 
@@ -745,10 +774,12 @@ int xc_dom_build_image(struct xc_dom_image *dom)
                               dom->kernel_seg.vend -
                               dom->kernel_seg.vstart) != 0 )
         goto err;
-    if ( dom->kernel_loader->loader(dom) != 0 )
-        goto err;
 
-    /* load ramdisk */
+    /*
+     * Load the ramdisk. Its segment directly follows the kernel, so it can
+     * be placed before the kernel is loaded; a compressed ramdisk is then
+     * inflated into guest memory while the kernel loader runs.
+     */
     if ( dom->ramdisk_blob )
     {
         size_t unziplen, ramdisklen;
@@ -762,6 +793,16 @@ int xc_dom_build_image(struct xc_dom_image *dom)
         ramdiskmap = xc_dom_seg_to_ptr(dom, &dom->ramdisk_seg);
         if ( unziplen )
         {
+#ifndef __MINIOS__
+            unzip.src = dom->ramdisk_blob;
+            unzip.srclen = dom->ramdisk_size;
+            unzip.dst = ramdiskmap;
+            unzip.dstlen = ramdisklen;
+            unzip.rc = 0;
+            unzip_running = !pthread_create(&unzip_thread, NULL,
+                                            ramdisk_unzip_thread, &unzip);
+            if ( !unzip_running )
+#endif
             if ( xc_dom_do_gunzip(dom->ramdisk_blob, dom->ramdisk_size,
                                   ramdiskmap, ramdisklen) == -1 )
                 goto err;
@@ -770,6 +811,19 @@ int xc_dom_build_image(struct xc_dom_image *dom)
             memcpy(ramdiskmap, dom->ramdisk_blob, dom->ramdisk_size);
     }
 
+    rc = dom->kernel_loader->loader(dom);
+
+#ifndef __MINIOS__
+    if ( unzip_running )
+    {
+        pthread_join(unzip_thread, NULL);
+        if ( unzip.rc == -1 )
+            rc = -1;
+    }
+#endif
+    if ( rc != 0 )
+        goto err;
+
     /* allocate other pages */
     if ( dom->arch_hooks->alloc_magic_pages(dom) != 0 )
         goto err;
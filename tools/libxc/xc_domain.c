@@ -71,24 +71,25 @@ int xc_domain_shutdown(int xc_handle,
                        int reason)
 {
     int ret = -1;
-    sched_remote_shutdown_t arg;
+    sched_remote_shutdown_t arg, *parg = &arg;
     DECLARE_HYPERCALL;
 
-    hypercall.op     = __HYPERVISOR_sched_op;
-    hypercall.arg[0] = (unsigned long)SCHEDOP_remote_shutdown;
-    hypercall.arg[1] = (unsigned long)&arg;
     arg.domain_id = domid;
     arg.reason = reason;
 
-    if ( lock_pages(&arg, sizeof(arg)) != 0 )
+    if ( hcall_buf_prep((void **)&parg, sizeof(arg)) != 0 )
     {
         PERROR("Could not lock memory for Xen hypercall");
         goto out1;
     }
 
+    hypercall.op     = __HYPERVISOR_sched_op;
+    hypercall.arg[0] = (unsigned long)SCHEDOP_remote_shutdown;
+    hypercall.arg[1] = (unsigned long)parg;
+
     ret = do_xen_hypercall(xc_handle, &hypercall);
 
-    unlock_pages(&arg, sizeof(arg));
+    hcall_buf_release((void **)&parg, sizeof(arg));
 
  out1:
     return ret;
@@ -115,19 +116,19 @@ int xc_vcpu_setaffinity(int xc_handle,
 
     bitmap_64_to_byte(local, cpumap, cpusize * 8);
 
-    set_xen_guest_handle(domctl.u.vcpuaffinity.cpumap.bitmap, local);
-
     domctl.u.vcpuaffinity.cpumap.nr_cpus = cpusize * 8;
     
-    if ( lock_pages(local, cpusize) != 0 )
+    if ( hcall_buf_prep((void **)&local, cpusize) != 0 )
     {
         PERROR("Could not lock memory for Xen hypercall");
         goto out;
     }
 
+    set_xen_guest_handle(domctl.u.vcpuaffinity.cpumap.bitmap, local);
+
     ret = do_domctl(xc_handle, &domctl);
 
-    unlock_pages(local, cpusize);
+    hcall_buf_release((void **)&local, cpusize);
 
  out:
     free(local);
@@ -155,18 +156,19 @@ int xc_vcpu_getaffinity(int xc_handle,
     domctl.u.vcpuaffinity.vcpu = vcpu;
 
 
-    set_xen_guest_handle(domctl.u.vcpuaffinity.cpumap.bitmap, local);
     domctl.u.vcpuaffinity.cpumap.nr_cpus = cpusize * 8;
     
-    if ( lock_pages(local, sizeof(local)) != 0 )
+    if ( hcall_buf_prep((void **)&local, cpusize) != 0 )
     {
         PERROR("Could not lock memory for Xen hypercall");
         goto out;
     }
 
+    set_xen_guest_handle(domctl.u.vcpuaffinity.cpumap.bitmap, local);
+
     ret = do_domctl(xc_handle, &domctl);
 
-    unlock_pages(local, sizeof (local));
+    hcall_buf_release((void **)&local, cpusize);
     bitmap_byte_to_64(cpumap, local, cpusize * 8);
 out:
     free(local);
@@ -242,7 +244,8 @@ int xc_domain_getinfolist(int xc_handle,
     int ret = 0;
     DECLARE_SYSCTL;
 
-    if ( lock_pages(info, max_domains*sizeof(xc_domaininfo_t)) != 0 )
+    if ( hcall_buf_prep((void **)&info,
+                        max_domains*sizeof(xc_domaininfo_t)) != 0 )
         return -1;
 
     sysctl.cmd = XEN_SYSCTL_getdomaininfolist;
@@ -255,7 +258,7 @@ int xc_domain_getinfolist(int xc_handle,
     else
         ret = sysctl.u.getdomaininfolist.num_domains;
 
-    unlock_pages(info, max_domains*sizeof(xc_domaininfo_t));
+    hcall_buf_release((void **)&info, max_domains*sizeof(xc_domaininfo_t));
 
     return ret;
 }
@@ -269,19 +272,19 @@ int xc_domain_hvm_getcontext(int xc_handle,
     int ret;
     DECLARE_DOMCTL;
 
+    if ( ctxt_buf ) 
+        if ( (ret = hcall_buf_prep((void **)&ctxt_buf, size)) != 0 )
+            return ret;
+
     domctl.cmd = XEN_DOMCTL_gethvmcontext;
     domctl.domain = (domid_t)domid;
     domctl.u.hvmcontext.size = size;
     set_xen_guest_handle(domctl.u.hvmcontext.buffer, ctxt_buf);
 
-    if ( ctxt_buf ) 
-        if ( (ret = lock_pages(ctxt_buf, size)) != 0 )
-            return ret;
-
     ret = do_domctl(xc_handle, &domctl);
 
     if ( ctxt_buf ) 
-        unlock_pages(ctxt_buf, size);
+        hcall_buf_release((void **)&ctxt_buf, size);
 
     return (ret < 0 ? -1 : domctl.u.hvmcontext.size);
 }
@@ -305,15 +308,15 @@ int xc_domain_hvm_getcontext_partial(int xc_handle,
     domctl.domain = (domid_t) domid;
     domctl.u.hvmcontext_partial.type = typecode;
     domctl.u.hvmcontext_partial.instance = instance;
-    set_xen_guest_handle(domctl.u.hvmcontext_partial.buffer, ctxt_buf);
 
-    if ( (ret = lock_pages(ctxt_buf, size)) != 0 )
+    if ( (ret = hcall_buf_prep(&ctxt_buf, size)) != 0 )
         return ret;
+
+    set_xen_guest_handle(domctl.u.hvmcontext_partial.buffer, ctxt_buf);
     
     ret = do_domctl(xc_handle, &domctl);
 
-    if ( ctxt_buf ) 
-        unlock_pages(ctxt_buf, size);
+    hcall_buf_release(&ctxt_buf, size);
 
     return ret ? -1 : 0;
 }
@@ -327,17 +330,17 @@ int xc_domain_hvm_setcontext(int xc_handle,
     int ret;
     DECLARE_DOMCTL;
 
+    if ( (ret = hcall_buf_prep((void **)&ctxt_buf, size)) != 0 )
+        return ret;
+
     domctl.cmd = XEN_DOMCTL_sethvmcontext;
     domctl.domain = domid;
     domctl.u.hvmcontext.size = size;
     set_xen_guest_handle(domctl.u.hvmcontext.buffer, ctxt_buf);
 
-    if ( (ret = lock_pages(ctxt_buf, size)) != 0 )
-        return ret;
-
     ret = do_domctl(xc_handle, &domctl);
 
-    unlock_pages(ctxt_buf, size);
+    hcall_buf_release((void **)&ctxt_buf, size);
 
     return ret;
 }
@@ -351,16 +354,16 @@ int xc_vcpu_getcontext(int xc_handle,
     DECLARE_DOMCTL;
     size_t sz = sizeof(vcpu_guest_context_any_t);
 
+    if ( (rc = hcall_buf_prep((void **)&ctxt, sz)) != 0 )
+        return rc;
+
     domctl.cmd = XEN_DOMCTL_getvcpucontext;
     domctl.domain = (domid_t)domid;
     domctl.u.vcpucontext.vcpu   = (uint16_t)vcpu;
     set_xen_guest_handle(domctl.u.vcpucontext.ctxt, &ctxt->c);
 
-    
-    if ( (rc = lock_pages(ctxt, sz)) != 0 )
-        return rc;
     rc = do_domctl(xc_handle, &domctl);
-    unlock_pages(ctxt, sz);
+    hcall_buf_release((void **)&ctxt, sz);
 
     return rc;
 }
@@ -443,20 +446,29 @@ int xc_domain_set_memmap_limit(int xc_handle,
         .type = E820_RAM
     };
 
-    set_xen_guest_handle(fmap.map.buffer, &e820);
+    struct xen_foreign_memory_map *pfmap = &fmap;
+    struct e820entry *pe820 = &e820;
 
-    if ( lock_pages(&fmap, sizeof(fmap)) || lock_pages(&e820, sizeof(e820)) )
+    if ( hcall_buf_prep((void **)&pe820, sizeof(e820)) != 0 )
+    {
+        PERROR("Could not lock memory for Xen hypercall");
+        return -1;
+    }
+
+    set_xen_guest_handle(fmap.map.buffer, pe820);
+
+    if ( hcall_buf_prep((void **)&pfmap, sizeof(fmap)) != 0 )
     {
         PERROR("Could not lock memory for Xen hypercall");
         rc = -1;
         goto out;
     }
 
-    rc = xc_memory_op(xc_handle, XENMEM_set_memory_map, &fmap);
+    rc = xc_memory_op(xc_handle, XENMEM_set_memory_map, pfmap);
 
+    hcall_buf_release((void **)&pfmap, sizeof(fmap));
  out:
-    unlock_pages(&fmap, sizeof(fmap));
-    unlock_pages(&e820, sizeof(e820));
+    hcall_buf_release((void **)&pe820, sizeof(e820));
     return rc;
 }
 #else
@@ -516,14 +528,15 @@ int xc_domain_get_tsc_info(int xc_handle,
 {
     int rc;
     DECLARE_DOMCTL;
-    xen_guest_tsc_info_t info = { 0 };
+    xen_guest_tsc_info_t info = { 0 }, *pinfo = &info;
 
+    if ( (rc = hcall_buf_prep((void **)&pinfo, sizeof(info))) != 0 )
+        return rc;
     domctl.cmd = XEN_DOMCTL_gettscinfo;
     domctl.domain = (domid_t)domid;
-    set_xen_guest_handle(domctl.u.tsc_info.out_info, &info);
-    if ( (rc = lock_pages(&info, sizeof(info))) != 0 )
-        return rc;
+    set_xen_guest_handle(domctl.u.tsc_info.out_info, pinfo);
     rc = do_domctl(xc_handle, &domctl);
+    hcall_buf_release((void **)&pinfo, sizeof(info));
     if ( rc == 0 )
     {
         *tsc_mode = info.tsc_mode;
@@ -531,7 +544,6 @@ int xc_domain_get_tsc_info(int xc_handle,
         *gtsc_khz = info.gtsc_khz;
         *incarnation = info.incarnation;
     }
-    unlock_pages(&info,sizeof(info));
     return rc;
 }
 
@@ -748,6 +760,36 @@ int xc_vcpu_getinfo(int xc_handle,
     return rc;
 }
 
+int xc_vcpu_getinfolist(int xc_handle,
+                        uint32_t first_domain,
+                        unsigned int max_vcpus,
+                        xc_vcpuinfolist_t *info,
+                        uint32_t *next_domain)
+{
+    int ret = 0;
+    DECLARE_SYSCTL;
+
+    if ( hcall_buf_prep((void **)&info, max_vcpus*sizeof(*info)) != 0 )
+        return -1;
+
+    sysctl.cmd = XEN_SYSCTL_getvcpuinfolist;
+    sysctl.u.getvcpuinfolist.first_domain = first_domain;
+    sysctl.u.getvcpuinfolist.max_vcpus    = max_vcpus;
+    set_xen_guest_handle(sysctl.u.getvcpuinfolist.buffer, info);
+
+    if ( xc_sysctl(xc_handle, &sysctl) < 0 )
+        ret = -1;
+    else
+    {
+        ret = sysctl.u.getvcpuinfolist.num_vcpus;
+        *next_domain = sysctl.u.getvcpuinfolist.next_domain;
+    }
+
+    hcall_buf_release((void **)&info, max_vcpus*sizeof(*info));
+
+    return ret;
+}
+
 int xc_domain_ioport_permission(int xc_handle,
                                 uint32_t domid,
                                 uint32_t first_port,
@@ -801,16 +843,17 @@ int xc_vcpu_setcontext(int xc_handle,
         return -1;
     }
 
+    if ( (rc = hcall_buf_prep((void **)&ctxt, sz)) != 0 )
+        return rc;
+
     domctl.cmd = XEN_DOMCTL_setvcpucontext;
     domctl.domain = domid;
     domctl.u.vcpucontext.vcpu = vcpu;
     set_xen_guest_handle(domctl.u.vcpucontext.ctxt, &ctxt->c);
 
-    if ( (rc = lock_pages(ctxt, sz)) != 0 )
-        return rc;
     rc = do_domctl(xc_handle, &domctl);
     
-    unlock_pages(ctxt, sz);
+    hcall_buf_release((void **)&ctxt, sz);
 
     return rc;
 }
@@ -865,37 +908,37 @@ int xc_domain_send_trigger(int xc_handle,
 int xc_set_hvm_param(int handle, domid_t dom, int param, unsigned long value)
 {
     DECLARE_HYPERCALL;
-    xen_hvm_param_t arg;
+    xen_hvm_param_t arg, *parg = &arg;
     int rc;
 
-    hypercall.op     = __HYPERVISOR_hvm_op;
-    hypercall.arg[0] = HVMOP_set_param;
-    hypercall.arg[1] = (unsigned long)&arg;
     arg.domid = dom;
     arg.index = param;
     arg.value = value;
-    if ( lock_pages(&arg, sizeof(arg)) != 0 )
+    if ( hcall_buf_prep((void **)&parg, sizeof(arg)) != 0 )
         return -1;
+    hypercall.op     = __HYPERVISOR_hvm_op;
+    hypercall.arg[0] = HVMOP_set_param;
+    hypercall.arg[1] = (unsigned long)parg;
     rc = do_xen_hypercall(handle, &hypercall);
-    unlock_pages(&arg, sizeof(arg));
+    hcall_buf_release((void **)&parg, sizeof(arg));
     return rc;
 }
 
 int xc_get_hvm_param(int handle, domid_t dom, int param, unsigned long *value)
 {
     DECLARE_HYPERCALL;
-    xen_hvm_param_t arg;
+    xen_hvm_param_t arg, *parg = &arg;
     int rc;
 
-    hypercall.op     = __HYPERVISOR_hvm_op;
-    hypercall.arg[0] = HVMOP_get_param;
-    hypercall.arg[1] = (unsigned long)&arg;
     arg.domid = dom;
     arg.index = param;
-    if ( lock_pages(&arg, sizeof(arg)) != 0 )
+    if ( hcall_buf_prep((void **)&parg, sizeof(arg)) != 0 )
         return -1;
+    hypercall.op     = __HYPERVISOR_hvm_op;
+    hypercall.arg[0] = HVMOP_get_param;
+    hypercall.arg[1] = (unsigned long)parg;
     rc = do_xen_hypercall(handle, &hypercall);
-    unlock_pages(&arg, sizeof(arg));
+    hcall_buf_release((void **)&parg, sizeof(arg));
     *value = arg.value;
     return rc;
 }
@@ -943,15 +986,15 @@ int xc_get_device_group(
     domctl.u.get_device_group.machine_bdf = machine_bdf;
     domctl.u.get_device_group.max_sdevs = max_sdevs;
 
-    set_xen_guest_handle(domctl.u.get_device_group.sdev_array, sdev_array);
-
-    if ( lock_pages(sdev_array, max_sdevs * sizeof(*sdev_array)) != 0 )
+    if ( hcall_buf_prep((void **)&sdev_array,
+                        max_sdevs * sizeof(*sdev_array)) != 0 )
     {
         PERROR("Could not lock memory for xc_get_device_group\n");
         return -ENOMEM;
     }
+    set_xen_guest_handle(domctl.u.get_device_group.sdev_array, sdev_array);
     rc = do_domctl(xc_handle, &domctl);
-    unlock_pages(sdev_array, max_sdevs * sizeof(*sdev_array));
+    hcall_buf_release((void **)&sdev_array, max_sdevs * sizeof(*sdev_array));
 
     *num_sdevs = domctl.u.get_device_group.num_sdevs;
     return rc;
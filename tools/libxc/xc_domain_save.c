@@ -45,9 +45,11 @@ struct outbuf {
     void* buf;
     size_t size;
     size_t pos;
+    int growable; /* grow rather than flush while the guest is suspended */
 };
 
 #define OUTBUF_SIZE (16384 * 1024)
+#define OUTBUF_MAX_SIZE (1024UL * 1024 * 1024)
 
 /* grep fodder: machine_to_phys */
 
@@ -180,6 +182,35 @@ static inline int outbuf_write(struct outbuf* ob, void* buf, size_t len)
     return 0;
 }
 
+/*
+ * Enlarge the buffer so that len more bytes fit, so that a checkpoint's
+ * dirty pages can be buffered without writing to the stream while the
+ * guest is suspended. The buffer is kept across checkpoints and only
+ * released when the save loop exits.
+ */
+static int outbuf_grow(struct outbuf* ob, size_t len)
+{
+    size_t size = ob->size;
+    void* buf;
+
+    while ( size - ob->pos < len )
+    {
+        if ( size >= OUTBUF_MAX_SIZE )
+            return -1;
+        size *= 2;
+    }
+
+    if ( !(buf = realloc(ob->buf, size)) ) {
+        DPRINTF("error growing output buffer to %zu\n", size);
+        return -1;
+    }
+
+    ob->buf = buf;
+    ob->size = size;
+
+    return 0;
+}
+
 /* prep for nonblocking I/O */
 static int outbuf_flush(struct outbuf* ob, int fd)
 {
@@ -216,6 +247,10 @@ static inline int outbuf_hardwrite(struct outbuf* ob, int fd, void* buf,
     if ( !outbuf_write(ob, buf, len) )
         return 0;
 
+    /* avoid blocking on the stream while a checkpoint is in progress */
+    if ( ob->growable && !outbuf_grow(ob, len) )
+        return outbuf_write(ob, buf, len);
+
     if ( outbuf_flush(ob, fd) < 0 )
         return -1;
 
@@ -921,6 +956,10 @@ int xc_domain_save(int xc_handle, int io_fd, uint32_t dom, uint32_t max_iters,
 
     int completed = 0;
 
+    /* checkpoint instrumentation */
+    unsigned int epoch = 0;
+    uint64_t suspend_start = 0;
+
     outbuf_init(&ob, OUTBUF_SIZE);
 
     /* If no explicit control parameters given, use defaults */
@@ -998,6 +1037,7 @@ int xc_domain_save(int xc_handle, int io_fd, uint32_t dom, uint32_t max_iters,
     else
     {
         /* This is a non-live suspend. Suspend the domain .*/
+        suspend_start = llgettimeofday();
         if ( suspend_and_state(callbacks->suspend, callbacks->data, xc_handle,
                                io_fd, dom, &info) )
         {
@@ -1479,6 +1519,7 @@ int xc_domain_save(int xc_handle, int io_fd, uint32_t dom, uint32_t max_iters,
                 DPRINTF("Start last iteration\n");
                 last_iter = 1;
 
+                suspend_start = llgettimeofday();
                 if ( suspend_and_state(callbacks->suspend, callbacks->data,
                                        xc_handle, io_fd, dom, &info) )
                 {
@@ -1780,6 +1821,11 @@ int xc_domain_save(int xc_handle, int io_fd, uint32_t dom, uint32_t max_iters,
     if ( !rc && callbacks->postcopy )
         callbacks->postcopy(callbacks->data);
 
+    if ( !rc && callbacks->checkpoint && suspend_start )
+        DPRINTF("Checkpoint %u: suspended for %"PRIu64" us, "
+                "%zu bytes buffered (buffer %zu bytes)\n", epoch++,
+                llgettimeofday() - suspend_start, ob.pos, ob.size);
+
     /* Flush last write and discard cache for file. */
     if ( outbuf_flush(&ob, io_fd) < 0 ) {
         ERROR("Error when flushing output buffer\n");
@@ -1797,6 +1843,9 @@ int xc_domain_save(int xc_handle, int io_fd, uint32_t dom, uint32_t max_iters,
 
         rc = 1;
         /* last_iter = 1; */
+        /* from now on only checkpoints are buffered: grow, don't flush */
+        ob.growable = 1;
+        suspend_start = llgettimeofday();
         if ( suspend_and_state(callbacks->suspend, callbacks->data, xc_handle,
                                io_fd, dom, &info) )
         {
@@ -1844,6 +1893,7 @@ int xc_domain_save(int xc_handle, int io_fd, uint32_t dom, uint32_t max_iters,
     free(to_send);
     free(to_fix);
     free(to_skip);
+    free(ob.buf);
 
     DPRINTF("Save exit rc=%d\n",rc);
 
@@ -57,6 +57,73 @@ int xc_mem_paging_resume(int xc_handle, domid_t domain_id, unsigned long gfn)
                                 gfn);
 }
 
+int xc_mem_paging_restore(int xc_handle, domid_t domain_id, unsigned long gfn)
+{
+    return xc_mem_event_control(xc_handle, domain_id,
+                                XEN_DOMCTL_MEM_EVENT_OP_PAGING_RESTORE,
+                                XEN_DOMCTL_MEM_EVENT_OP_PAGING, NULL, NULL,
+                                gfn);
+}
+
+static int xc_mem_paging_batch(int xc_handle, domid_t domain_id,
+                               unsigned int op, uint64_t *gfns, int *errs,
+                               unsigned int nr)
+{
+    DECLARE_DOMCTL;
+    unsigned int done = 0;
+    int rc = -1;
+
+    if ( lock_pages(gfns, nr * sizeof(*gfns)) != 0 )
+    {
+        PERROR("Could not lock gfn array");
+        return -1;
+    }
+    if ( lock_pages(errs, nr * sizeof(*errs)) != 0 )
+    {
+        PERROR("Could not lock error array");
+        goto out;
+    }
+
+    /* Xen processes as many gfns as it can before it needs to preempt */
+    while ( done < nr )
+    {
+        domctl.cmd = XEN_DOMCTL_mem_event_op;
+        domctl.domain = domain_id;
+        domctl.u.mem_event_op.op = op;
+        domctl.u.mem_event_op.mode = XEN_DOMCTL_MEM_EVENT_OP_PAGING;
+        set_xen_guest_handle(domctl.u.mem_event_op.gfns, gfns + done);
+        set_xen_guest_handle(domctl.u.mem_event_op.errs, errs + done);
+        domctl.u.mem_event_op.nr = nr - done;
+
+        rc = do_domctl(xc_handle, &domctl);
+        if ( rc != 0 )
+            break;
+
+        done += domctl.u.mem_event_op.nr;
+    }
+
+    unlock_pages(errs, nr * sizeof(*errs));
+ out:
+    unlock_pages(gfns, nr * sizeof(*gfns));
+    return rc;
+}
+
+int xc_mem_paging_nominate_batch(int xc_handle, domid_t domain_id,
+                                 uint64_t *gfns, int *errs, unsigned int nr)
+{
+    return xc_mem_paging_batch(xc_handle, domain_id,
+                               XEN_DOMCTL_MEM_EVENT_OP_PAGING_NOMINATE_BATCH,
+                               gfns, errs, nr);
+}
+
+int xc_mem_paging_evict_batch(int xc_handle, domid_t domain_id,
+                              uint64_t *gfns, int *errs, unsigned int nr)
+{
+    return xc_mem_paging_batch(xc_handle, domain_id,
+                               XEN_DOMCTL_MEM_EVENT_OP_PAGING_EVICT_BATCH,
+                               gfns, errs, nr);
+}
+
 
 /*
  * Local variables:
@@ -104,6 +104,61 @@ int xc_memshr_share(int xc_handle,
     return do_domctl(xc_handle, &domctl);
 }
 
+static int xc_memshr_batch(int xc_handle,
+                           uint8_t op,
+                           xen_mem_sharing_batch_entry_t *entries,
+                           unsigned int nr)
+{
+    DECLARE_DOMCTL;
+    struct xen_domctl_mem_sharing_op *mop;
+    unsigned int done = 0;
+    int ret = -1;
+
+    if ( lock_pages(entries, nr * sizeof(*entries)) != 0 )
+    {
+        PERROR("Could not lock batch entries");
+        return -1;
+    }
+
+    /* Xen processes as many entries as it can before it needs to preempt */
+    while ( done < nr )
+    {
+        domctl.cmd = XEN_DOMCTL_mem_sharing_op;
+        domctl.interface_version = XEN_DOMCTL_INTERFACE_VERSION;
+        domctl.domain = 0;
+        mop = &(domctl.u.mem_sharing_op);
+        mop->op = op;
+        set_xen_guest_handle(mop->u.batch.entries, entries + done);
+        mop->u.batch.nr = nr - done;
+
+        ret = do_domctl(xc_handle, &domctl);
+        if ( ret != 0 )
+            break;
+
+        done += mop->u.batch.nr;
+    }
+
+    unlock_pages(entries, nr * sizeof(*entries));
+    return ret;
+}
+
+int xc_memshr_nominate_gfn_batch(int xc_handle,
+                                 xen_mem_sharing_batch_entry_t *entries,
+                                 unsigned int nr)
+{
+    return xc_memshr_batch(xc_handle,
+                           XEN_DOMCTL_MEM_SHARING_OP_NOMINATE_GFN_BATCH,
+                           entries, nr);
+}
+
+int xc_memshr_share_batch(int xc_handle,
+                          xen_mem_sharing_batch_entry_t *entries,
+                          unsigned int nr)
+{
+    return xc_memshr_batch(xc_handle, XEN_DOMCTL_MEM_SHARING_OP_SHARE_BATCH,
+                           entries, nr);
+}
+
 int xc_memshr_domain_resume(int xc_handle,
                             uint32_t domid)
 {
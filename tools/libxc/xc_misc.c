@@ -172,16 +172,16 @@ int xc_getcpuinfo(int xc_handle, int max_cpus,
     int rc;
     DECLARE_SYSCTL;
 
+    if ( (rc = hcall_buf_prep((void **)&info, max_cpus*sizeof(*info))) != 0 )
+        return rc;
+
     sysctl.cmd = XEN_SYSCTL_getcpuinfo;
     sysctl.u.getcpuinfo.max_cpus = max_cpus; 
     set_xen_guest_handle(sysctl.u.getcpuinfo.info, info); 
 
-    if ( (rc = lock_pages(info, max_cpus*sizeof(*info))) != 0 )
-        return rc;
-
     rc = do_sysctl(xc_handle, &sysctl);
 
-    unlock_pages(info, max_cpus*sizeof(*info));
+    hcall_buf_release((void **)&info, max_cpus*sizeof(*info));
 
     if ( nr_cpus )
         *nr_cpus = sysctl.u.getcpuinfo.nr_cpus; 
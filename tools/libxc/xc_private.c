@@ -137,6 +137,11 @@ void unlock_pages(void *addr, size_t len) { }
 int hcall_buf_prep(void **addr, size_t len) { return 0; }
 void hcall_buf_release(void **addr, size_t len) { }
 
+void xc_hcall_buf_stats(uint64_t *hits, uint64_t *misses)
+{
+    *hits = *misses = 0;
+}
+
 #else /* !__sun__ */
 
 int lock_pages(void *addr, size_t len)
@@ -157,23 +162,44 @@ void unlock_pages(void *addr, size_t len)
     safe_munlock(laddr, llen);
 }
 
+/*
+ * Each thread keeps a few pre-locked, page-aligned bounce buffers.  Small
+ * hypercall arguments are copied through them instead of mlock()ing and
+ * munlock()ing the caller's memory around every hypercall.  Several slots
+ * are needed because a thread may hold more than one buffer at a time
+ * (e.g. a sysctl and the array it points to).
+ */
+#define HCALL_BUF_SLOTS     4
+#define HCALL_BUF_MAX_PAGES 16
+
 static pthread_key_t hcall_buf_pkey;
 static pthread_once_t hcall_buf_pkey_once = PTHREAD_ONCE_INIT;
 struct hcall_buf {
-    void *buf;
-    void *oldbuf;
+    struct {
+        void *buf;
+        void *oldbuf;
+        unsigned int nr_pages;
+        int in_use;
+    } slot[HCALL_BUF_SLOTS];
 };
 
+/* mlock/munlock pairs avoided, and buffers that had to be locked in place */
+static uint64_t hcall_buf_hits, hcall_buf_misses;
+
 static void _xc_clean_hcall_buf(void *m)
 {
     struct hcall_buf *hcall_buf = m;
+    int i;
 
     if ( hcall_buf )
     {
-        if ( hcall_buf->buf )
+        for ( i = 0; i < HCALL_BUF_SLOTS; i++ )
         {
-            unlock_pages(hcall_buf->buf, PAGE_SIZE);
-            free(hcall_buf->buf);
+            if ( !hcall_buf->slot[i].buf )
+                continue;
+            unlock_pages(hcall_buf->slot[i].buf,
+                         hcall_buf->slot[i].nr_pages << PAGE_SHIFT);
+            free(hcall_buf->slot[i].buf);
         }
 
         free(hcall_buf);
@@ -190,6 +216,13 @@ static void _xc_init_hcall_buf(void)
 int hcall_buf_prep(void **addr, size_t len)
 {
     struct hcall_buf *hcall_buf;
+    unsigned int nr_pages = (len + PAGE_SIZE - 1) >> PAGE_SHIFT;
+    int i, best = -1, spare = -1;
+
+    if ( nr_pages > HCALL_BUF_MAX_PAGES )
+        goto out;
+    if ( nr_pages == 0 )
+        nr_pages = 1;
 
     pthread_once(&hcall_buf_pkey_once, _xc_init_hcall_buf);
 
@@ -202,43 +235,88 @@ int hcall_buf_prep(void **addr, size_t len)
         pthread_setspecific(hcall_buf_pkey, hcall_buf);
     }
 
-    if ( !hcall_buf->buf )
+    /* Smallest free slot that fits, else a free slot we can (re)size. */
+    for ( i = 0; i < HCALL_BUF_SLOTS; i++ )
     {
-        hcall_buf->buf = xc_memalign(PAGE_SIZE, PAGE_SIZE);
-        if ( !hcall_buf->buf || lock_pages(hcall_buf->buf, PAGE_SIZE) )
+        if ( hcall_buf->slot[i].in_use )
+            continue;
+        if ( hcall_buf->slot[i].nr_pages >= nr_pages )
         {
-            free(hcall_buf->buf);
-            hcall_buf->buf = NULL;
-            goto out;
+            if ( (best < 0) ||
+                 (hcall_buf->slot[i].nr_pages < hcall_buf->slot[best].nr_pages) )
+                best = i;
         }
+        else if ( (spare < 0) ||
+                  (hcall_buf->slot[i].nr_pages < hcall_buf->slot[spare].nr_pages) )
+            spare = i;
     }
 
-    if ( (len < PAGE_SIZE) && !hcall_buf->oldbuf )
+    if ( best < 0 )
     {
-        memcpy(hcall_buf->buf, *addr, len);
-        hcall_buf->oldbuf = *addr;
-        *addr = hcall_buf->buf;
-        return 0;
+        unsigned int size = 1;
+
+        if ( spare < 0 )
+            goto out;
+
+        while ( size < nr_pages )
+            size <<= 1;
+
+        if ( hcall_buf->slot[spare].buf )
+        {
+            unlock_pages(hcall_buf->slot[spare].buf,
+                         hcall_buf->slot[spare].nr_pages << PAGE_SHIFT);
+            free(hcall_buf->slot[spare].buf);
+            hcall_buf->slot[spare].nr_pages = 0;
+        }
+
+        hcall_buf->slot[spare].buf = xc_memalign(PAGE_SIZE, size << PAGE_SHIFT);
+        if ( !hcall_buf->slot[spare].buf ||
+             lock_pages(hcall_buf->slot[spare].buf, size << PAGE_SHIFT) )
+        {
+            free(hcall_buf->slot[spare].buf);
+            hcall_buf->slot[spare].buf = NULL;
+            goto out;
+        }
+        hcall_buf->slot[spare].nr_pages = size;
+        best = spare;
     }
 
+    memcpy(hcall_buf->slot[best].buf, *addr, len);
+    hcall_buf->slot[best].oldbuf = *addr;
+    hcall_buf->slot[best].in_use = 1;
+    *addr = hcall_buf->slot[best].buf;
+    __sync_fetch_and_add(&hcall_buf_hits, 1);
+    return 0;
+
  out:
+    __sync_fetch_and_add(&hcall_buf_misses, 1);
     return lock_pages(*addr, len);
 }
 
 void hcall_buf_release(void **addr, size_t len)
 {
     struct hcall_buf *hcall_buf = pthread_getspecific(hcall_buf_pkey);
+    int i;
 
-    if ( hcall_buf && (hcall_buf->buf == *addr) )
+    for ( i = 0; hcall_buf && (i < HCALL_BUF_SLOTS); i++ )
     {
-        memcpy(hcall_buf->oldbuf, *addr, len);
-        *addr = hcall_buf->oldbuf;
-        hcall_buf->oldbuf = NULL;
-    }
-    else
-    {
-        unlock_pages(*addr, len);
+        if ( !hcall_buf->slot[i].in_use || (hcall_buf->slot[i].buf != *addr) )
+            continue;
+
+        memcpy(hcall_buf->slot[i].oldbuf, *addr, len);
+        *addr = hcall_buf->slot[i].oldbuf;
+        hcall_buf->slot[i].oldbuf = NULL;
+        hcall_buf->slot[i].in_use = 0;
+        return;
     }
+
+    unlock_pages(*addr, len);
+}
+
+void xc_hcall_buf_stats(uint64_t *hits, uint64_t *misses)
+{
+    *hits = hcall_buf_hits;
+    *misses = hcall_buf_misses;
 }
 
 #endif
@@ -287,24 +365,26 @@ int xc_mmuext_op(
 static int flush_mmu_updates(int xc_handle, struct xc_mmu *mmu)
 {
     int err = 0;
+    void *updates = mmu->updates;
+    size_t len = mmu->idx * sizeof(mmu->updates[0]);
     DECLARE_HYPERCALL;
 
     if ( mmu->idx == 0 )
         return 0;
 
-    hypercall.op     = __HYPERVISOR_mmu_update;
-    hypercall.arg[0] = (unsigned long)mmu->updates;
-    hypercall.arg[1] = (unsigned long)mmu->idx;
-    hypercall.arg[2] = 0;
-    hypercall.arg[3] = mmu->subject;
-
-    if ( lock_pages(mmu->updates, sizeof(mmu->updates)) != 0 )
+    if ( hcall_buf_prep(&updates, len) != 0 )
     {
         PERROR("flush_mmu_updates: mmu updates lock_pages failed");
         err = 1;
         goto out;
     }
 
+    hypercall.op     = __HYPERVISOR_mmu_update;
+    hypercall.arg[0] = (unsigned long)updates;
+    hypercall.arg[1] = (unsigned long)mmu->idx;
+    hypercall.arg[2] = 0;
+    hypercall.arg[3] = mmu->subject;
+
     if ( do_xen_hypercall(xc_handle, &hypercall) < 0 )
     {
         ERROR("Failure when submitting mmu updates");
@@ -313,7 +393,7 @@ static int flush_mmu_updates(int xc_handle, struct xc_mmu *mmu)
 
     mmu->idx = 0;
 
-    unlock_pages(mmu->updates, sizeof(mmu->updates));
+    hcall_buf_release(&updates, len);
 
  out:
     return err;
@@ -353,105 +433,80 @@ int xc_memory_op(int xc_handle,
     DECLARE_HYPERCALL;
     struct xen_memory_reservation *reservation = arg;
     struct xen_machphys_mfn_list *xmml = arg;
-    xen_pfn_t *extent_start;
+    xen_pfn_t *extent_start = NULL, *extent_buf = NULL;
+    size_t len = 0, extent_len = 0;
     long ret = -EINVAL;
 
-    hypercall.op     = __HYPERVISOR_memory_op;
-    hypercall.arg[0] = (unsigned long)cmd;
-    hypercall.arg[1] = (unsigned long)arg;
-
     switch ( cmd )
     {
     case XENMEM_increase_reservation:
     case XENMEM_decrease_reservation:
     case XENMEM_populate_physmap:
-        if ( lock_pages(reservation, sizeof(*reservation)) != 0 )
-        {
-            PERROR("Could not lock");
-            goto out1;
-        }
+        len = sizeof(*reservation);
         get_xen_guest_handle(extent_start, reservation->extent_start);
-        if ( (extent_start != NULL) &&
-             (lock_pages(extent_start,
-                    reservation->nr_extents * sizeof(xen_pfn_t)) != 0) )
-        {
-            PERROR("Could not lock");
-            unlock_pages(reservation, sizeof(*reservation));
-            goto out1;
-        }
+        extent_len = reservation->nr_extents * sizeof(xen_pfn_t);
         break;
     case XENMEM_machphys_mfn_list:
-        if ( lock_pages(xmml, sizeof(*xmml)) != 0 )
-        {
-            PERROR("Could not lock");
-            goto out1;
-        }
+        len = sizeof(*xmml);
         get_xen_guest_handle(extent_start, xmml->extent_start);
-        if ( lock_pages(extent_start,
-                   xmml->max_extents * sizeof(xen_pfn_t)) != 0 )
-        {
-            PERROR("Could not lock");
-            unlock_pages(xmml, sizeof(*xmml));
-            goto out1;
-        }
+        extent_len = xmml->max_extents * sizeof(xen_pfn_t);
         break;
     case XENMEM_add_to_physmap:
-        if ( lock_pages(arg, sizeof(struct xen_add_to_physmap)) )
-        {
-            PERROR("Could not lock");
-            goto out1;
-        }
+        len = sizeof(struct xen_add_to_physmap);
         break;
     case XENMEM_current_reservation:
     case XENMEM_maximum_reservation:
     case XENMEM_maximum_gpfn:
-        if ( lock_pages(arg, sizeof(domid_t)) )
-        {
-            PERROR("Could not lock");
-            goto out1;
-        }
+        len = sizeof(domid_t);
         break;
     case XENMEM_set_pod_target:
     case XENMEM_get_pod_target:
-        if ( lock_pages(arg, sizeof(struct xen_pod_target)) )
+        len = sizeof(struct xen_pod_target);
+        break;
+    }
+
+    /*
+     * The extent array is bounced first, so that the argument structure
+     * is bounced with its handle already pointing at the bounce buffer.
+     * The caller's handle is put back once both have been copied back.
+     */
+    if ( extent_start != NULL )
+    {
+        extent_buf = extent_start;
+        if ( hcall_buf_prep((void **)&extent_buf, extent_len) != 0 )
         {
             PERROR("Could not lock");
             goto out1;
         }
-        break;
+        if ( cmd == XENMEM_machphys_mfn_list )
+            set_xen_guest_handle(xmml->extent_start, extent_buf);
+        else
+            set_xen_guest_handle(reservation->extent_start, extent_buf);
+    }
+
+    if ( (len != 0) && (hcall_buf_prep(&arg, len) != 0) )
+    {
+        PERROR("Could not lock");
+        goto out2;
     }
 
+    hypercall.op     = __HYPERVISOR_memory_op;
+    hypercall.arg[0] = (unsigned long)cmd;
+    hypercall.arg[1] = (unsigned long)arg;
+
     ret = do_xen_hypercall(xc_handle, &hypercall);
 
-    switch ( cmd )
+    if ( len != 0 )
+        hcall_buf_release(&arg, len);
+
+ out2:
+    if ( extent_start != NULL )
     {
-    case XENMEM_increase_reservation:
-    case XENMEM_decrease_reservation:
-    case XENMEM_populate_physmap:
-        unlock_pages(reservation, sizeof(*reservation));
-        get_xen_guest_handle(extent_start, reservation->extent_start);
-        if ( extent_start != NULL )
-            unlock_pages(extent_start,
-                         reservation->nr_extents * sizeof(xen_pfn_t));
-        break;
-    case XENMEM_machphys_mfn_list:
-        unlock_pages(xmml, sizeof(*xmml));
-        get_xen_guest_handle(extent_start, xmml->extent_start);
-        unlock_pages(extent_start,
-                     xmml->max_extents * sizeof(xen_pfn_t));
-        break;
-    case XENMEM_add_to_physmap:
-        unlock_pages(arg, sizeof(struct xen_add_to_physmap));
-        break;
-    case XENMEM_current_reservation:
-    case XENMEM_maximum_reservation:
-    case XENMEM_maximum_gpfn:
-        unlock_pages(arg, sizeof(domid_t));
-        break;
-    case XENMEM_set_pod_target:
-    case XENMEM_get_pod_target:
-        unlock_pages(arg, sizeof(struct xen_pod_target));
-        break;
+        hcall_buf_release((void **)&extent_buf, extent_len);
+        if ( cmd == XENMEM_machphys_mfn_list )
+            set_xen_guest_handle(xmml->extent_start, extent_start);
+        else
+            set_xen_guest_handle(reservation->extent_start, extent_start);
     }
 
  out1:
@@ -486,21 +541,23 @@ int xc_get_pfn_list(int xc_handle,
     domctl.cmd = XEN_DOMCTL_getmemlist;
     domctl.domain   = (domid_t)domid;
     domctl.u.getmemlist.max_pfns = max_pfns;
-    set_xen_guest_handle(domctl.u.getmemlist.buffer, pfn_buf);
 
 #ifdef VALGRIND
     memset(pfn_buf, 0, max_pfns * sizeof(*pfn_buf));
 #endif
 
-    if ( lock_pages(pfn_buf, max_pfns * sizeof(*pfn_buf)) != 0 )
+    if ( hcall_buf_prep((void **)&pfn_buf,
+                        max_pfns * sizeof(*pfn_buf)) != 0 )
     {
         PERROR("xc_get_pfn_list: pfn_buf lock failed");
         return -1;
     }
 
+    set_xen_guest_handle(domctl.u.getmemlist.buffer, pfn_buf);
+
     ret = do_domctl(xc_handle, &domctl);
 
-    unlock_pages(pfn_buf, max_pfns * sizeof(*pfn_buf));
+    hcall_buf_release((void **)&pfn_buf, max_pfns * sizeof(*pfn_buf));
 
     return (ret < 0) ? -1 : domctl.u.getmemlist.num_pfns;
 }
@@ -575,21 +632,21 @@ int xc_version(int xc_handle, int cmd, void *arg)
         break;
     }
 
-    if ( (argsize != 0) && (lock_pages(arg, argsize) != 0) )
-    {
-        PERROR("Could not lock memory for version hypercall");
-        return -ENOMEM;
-    }
-
 #ifdef VALGRIND
     if (argsize != 0)
         memset(arg, 0, argsize);
 #endif
 
+    if ( (argsize != 0) && (hcall_buf_prep(&arg, argsize) != 0) )
+    {
+        PERROR("Could not lock memory for version hypercall");
+        return -ENOMEM;
+    }
+
     rc = do_xen_version(xc_handle, cmd, arg);
 
     if ( argsize != 0 )
-        unlock_pages(arg, argsize);
+        hcall_buf_release(&arg, argsize);
 
     return rc;
 }
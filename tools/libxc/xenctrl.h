@@ -100,6 +100,16 @@ int xc_interface_open(void);
  */
 int xc_interface_close(int xc_handle);
 
+/**
+ * Reports how many hypercall buffers were bounced through libxc's
+ * pre-locked per-thread buffers (each saving an mlock/munlock pair) and
+ * how many were too large, or too many at once, and were locked in place.
+ *
+ * @parm hits set to the number of buffers served from locked memory
+ * @parm misses set to the number of buffers locked with mlock()
+ */
+void xc_hcall_buf_stats(uint64_t *hits, uint64_t *misses);
+
 /*
  * DOMAIN DEBUGGING FUNCTIONS
  */
@@ -428,6 +438,27 @@ int xc_vcpu_getinfo(int xc_handle,
                     uint32_t vcpu,
                     xc_vcpuinfo_t *info);
 
+/**
+ * This function returns runtime information about the vcpus of all
+ * domains, starting at first_domain, using a single hypercall. Only whole
+ * domains are returned; callers wanting every domain should repeat the
+ * call from *next_domain until it is DOMID_INVALID.
+ *
+ * @parm xc_handle a handle to an open hypervisor interface
+ * @parm first_domain the first domain to report on
+ * @parm max_vcpus the number of entries in info
+ * @parm info an array of at least max_vcpus entries
+ * @parm next_domain set to the first domain not returned
+ * @return the number of entries filled in, -1 on failure (errno ENOBUFS if
+ *         the vcpus of the first domain do not fit)
+ */
+typedef xen_sysctl_vcpuinfo_t xc_vcpuinfolist_t;
+int xc_vcpu_getinfolist(int xc_handle,
+                        uint32_t first_domain,
+                        unsigned int max_vcpus,
+                        xc_vcpuinfolist_t *info,
+                        uint32_t *next_domain);
+
 long long xc_domain_get_cpu_usage(int xc_handle,
                                   domid_t domid,
                                   int vcpu);
@@ -1343,6 +1374,17 @@ int xc_mem_paging_evict(int xc_handle, domid_t domain_id, unsigned long gfn);
 int xc_mem_paging_prep(int xc_handle, domid_t domain_id, unsigned long gfn);
 int xc_mem_paging_resume(int xc_handle, domid_t domain_id,
                          unsigned long gfn);
+int xc_mem_paging_restore(int xc_handle, domid_t domain_id,
+                          unsigned long gfn);
+
+/*
+ * Nominate or evict nr gfns at once.  Per-gfn results (0 or -errno) are
+ * returned in errs[]; the return value only reports hypercall failure.
+ */
+int xc_mem_paging_nominate_batch(int xc_handle, domid_t domain_id,
+                                 uint64_t *gfns, int *errs, unsigned int nr);
+int xc_mem_paging_evict_batch(int xc_handle, domid_t domain_id,
+                              uint64_t *gfns, int *errs, unsigned int nr);
 
 /**
  * memshr operations
@@ -1361,6 +1403,16 @@ int xc_memshr_nominate_gref(int xc_handle,
 int xc_memshr_share(int xc_handle,
                     uint64_t source_handle,
                     uint64_t client_handle);
+/*
+ * Nominate or share nr pages at once.  Per-entry results are returned in
+ * each entry's rc field; the return value only reports hypercall failure.
+ */
+int xc_memshr_nominate_gfn_batch(int xc_handle,
+                                 xen_mem_sharing_batch_entry_t *entries,
+                                 unsigned int nr);
+int xc_memshr_share_batch(int xc_handle,
+                          xen_mem_sharing_batch_entry_t *entries,
+                          unsigned int nr);
 int xc_memshr_domain_resume(int xc_handle,
                             uint32_t domid);
 int xc_memshr_debug_gfn(int xc_handle,
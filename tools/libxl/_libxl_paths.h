@@ -0,0 +1,9 @@
+#define SBINDIR "/usr/sbin"
+#define BINDIR "/usr/bin"
+#define LIBEXEC "/usr/lib/xen/bin"
+#define LIBDIR "/usr/lib64"
+#define SHAREDIR "/usr/share"
+#define PRIVATE_BINDIR "/usr/lib64/xen/bin"
+#define XENFIRMWAREDIR "/usr/lib/xen/boot"
+#define XEN_CONFIG_DIR "/etc/xen"
+#define XEN_SCRIPT_DIR "/etc/xen/scripts"
@@ -2731,6 +2731,7 @@ int libxl_sched_credit_domain_get(struct libxl_ctx *ctx, uint32_t domid, struct
 
     scinfo->weight = sdom.weight;
     scinfo->cap = sdom.cap;
+    scinfo->latency = sdom.latency;
 
     return 0;
 }
@@ -2759,8 +2760,15 @@ int libxl_sched_credit_domain_set(struct libxl_ctx *ctx, uint32_t domid, struct
         return -1;
     }
 
+    if (scinfo->latency < 0 || scinfo->latency > 1) {
+        XL_LOG_ERRNOVAL(ctx, XL_LOG_ERROR, rc,
+            "Cpu latency class out of range, valid values are 0 and 1");
+        return -1;
+    }
+
     sdom.weight = scinfo->weight;
     sdom.cap = scinfo->cap;
+    sdom.latency = scinfo->latency;
 
     rc = xc_sched_credit_domain_set(ctx->xch, domid, &sdom);
     if (rc != 0)
@@ -497,6 +497,7 @@ int libxl_get_sched_id(struct libxl_ctx *ctx);
 struct libxl_sched_credit {
     int weight;
     int cap;
+    int latency;
 };
 
 int libxl_sched_credit_domain_get(struct libxl_ctx *ctx, uint32_t domid,
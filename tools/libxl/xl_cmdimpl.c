@@ -3109,11 +3109,12 @@ static int sched_credit_domain_set(
 static void sched_credit_domain_output(
     int domid, struct libxl_sched_credit *scinfo)
 {
-    printf("%-33s %4d %6d %4d\n",
+    printf("%-33s %4d %6d %4d %3d\n",
         libxl_domid_to_name(&ctx, domid),
         domid,
         scinfo->weight,
-        scinfo->cap);
+        scinfo->cap,
+        scinfo->latency);
 }
 
 int main_sched_credit(int argc, char **argv)
@@ -3122,10 +3123,10 @@ int main_sched_credit(int argc, char **argv)
     struct libxl_sched_credit scinfo;
     int nb_domain, i;
     char *dom = NULL;
-    int weight = 256, cap = 0, opt_w = 0, opt_c = 0;
+    int weight = 256, cap = 0, latency = 0, opt_w = 0, opt_c = 0, opt_l = 0;
     int opt, rc;
 
-    while ((opt = getopt(argc, argv, "hd:w:c:")) != -1) {
+    while ((opt = getopt(argc, argv, "hd:w:c:l:")) != -1) {
         switch (opt) {
         case 'd':
             dom = optarg;
@@ -3138,6 +3139,10 @@ int main_sched_credit(int argc, char **argv)
             cap = strtol(optarg, NULL, 10);
             opt_c = 1;
             break;
+        case 'l':
+            latency = strtol(optarg, NULL, 10);
+            opt_l = 1;
+            break;
         case 'h':
             help("sched-credit");
             exit(0);
@@ -3147,7 +3152,7 @@ int main_sched_credit(int argc, char **argv)
         }
     }
 
-    if (!dom && (opt_w || opt_c)) {
+    if (!dom && (opt_w || opt_c || opt_l)) {
         fprintf(stderr, "Must specify a domain.\n");
         exit(1);
     }
@@ -3159,7 +3164,7 @@ int main_sched_credit(int argc, char **argv)
             exit(1);
         }
 
-        printf("%-33s %4s %6s %4s\n", "Name", "ID", "Weight", "Cap");
+        printf("%-33s %4s %6s %4s %3s\n", "Name", "ID", "Weight", "Cap", "Lat");
         for (i = 0; i < nb_domain; i++) {
             rc = sched_credit_domain_get(info[i].domid, &scinfo);
             if (rc)
@@ -3173,14 +3178,16 @@ int main_sched_credit(int argc, char **argv)
         if (rc)
             exit(-rc);
 
-        if (!opt_w && !opt_c) { /* output credit scheduler info */
-            printf("%-33s %4s %6s %4s\n", "Name", "ID", "Weight", "Cap");
+        if (!opt_w && !opt_c && !opt_l) { /* output credit scheduler info */
+            printf("%-33s %4s %6s %4s %3s\n", "Name", "ID", "Weight", "Cap", "Lat");
             sched_credit_domain_output(domid, &scinfo);
         } else { /* set credit scheduler paramaters */
             if (opt_w)
                 scinfo.weight = weight;
             if (opt_c)
                 scinfo.cap = cap;
+            if (opt_l)
+                scinfo.latency = latency;
             rc = sched_credit_domain_set(domid, &scinfo);
             if (rc)
                 exit(-rc);
@@ -170,10 +170,11 @@ struct cmd_spec cmd_table[] = {
     { "sched-credit",
       &main_sched_credit,
       "Get/set credit scheduler parameters",
-      "[-d <Domain> [-w[=WEIGHT]|-c[=CAP]]]",
+      "[-d <Domain> [-w[=WEIGHT]|-c[=CAP]|-l[=LATENCY]]]",
       "-d DOMAIN, --domain=DOMAIN     Domain to modify\n"
       "-w WEIGHT, --weight=WEIGHT     Weight (int)\n"
-      "-c CAP, --cap=CAP              Cap (int)"
+      "-c CAP, --cap=CAP              Cap (int)\n"
+      "-l LATENCY, --latency=LATENCY  Latency class (0 or 1)"
     },
     { "domid",
       &main_domid,
@@ -20,6 +20,7 @@
 #include <errno.h>
 #include <math.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -66,6 +67,7 @@ struct bucket
 struct bucket_lock
 {
     BUCKET_LOCK;
+    uint32_t seq;                         /* odd while buckets are updated */
 };
 
 struct __hash
@@ -84,6 +86,17 @@ struct __hash
     uint16_t size_idx;                    /* table size index             */
     uint32_t max_load;                    /* # entries before rehash      */
     uint32_t min_load;                    /* # entries before rehash      */
+    /* Lookups don't take any locks, see seq_read_begin() below */
+    uint32_t tab_seq;                     /* odd while the above change   */
+    uint32_t tab_gen;                     /* # completed resizes          */
+    /* While resizing, tables being migrated to *_tab, bucket by bucket */
+    struct bucket *old_key_tab;
+    struct bucket *old_value_tab;
+    struct bucket_lock *old_key_lock_tab;
+    struct bucket_lock *old_value_lock_tab;
+    uint32_t old_tab_size;
+    uint32_t key_moved;                   /* # old key buckets migrated   */
+    uint32_t value_moved;                 /* # old value buckets migrated */
 };
 
 struct __hash *__hash_init   (struct __hash *h, uint32_t min_size);
@@ -126,6 +139,52 @@ static inline void atomic_dec(uint32_t *v)
 }
 #endif
 
+/*
+ * Lookups don't take any locks.  Each bucket lock also carries a sequence
+ * count, which writers make odd while they update any of the buckets it
+ * covers, and the table layout is covered by tab_seq in the same way.
+ * Readers retry if a count they depend on was odd, or has changed by the
+ * time they are done.  Entries and bucket tables stay in the shared memory
+ * area once allocated, so a reader racing with a writer may follow stale
+ * links, but never into unmapped memory.
+ */
+#define smp_mb()        __sync_synchronize()
+
+static inline uint32_t seq_read_begin(volatile uint32_t *seq)
+{
+    uint32_t s;
+
+    while((s = *seq) & 1)
+        sched_yield();
+    smp_mb();
+
+    return s;
+}
+
+static inline int seq_read_retry(volatile uint32_t *seq, uint32_t s)
+{
+    smp_mb();
+    return (*seq != s);
+}
+
+static inline void seq_write_begin(volatile uint32_t *seq)
+{
+    (*seq)++;
+    smp_mb();
+}
+
+static inline void seq_write_end(volatile uint32_t *seq)
+{
+    smp_mb();
+    (*seq)++;
+}
+
+static inline volatile uint32_t *bucket_seq(struct bucket_lock *lock_tab,
+                                            uint32_t idx)
+{
+    return &lock_tab[idx / BUCKETS_PER_LOCK].seq;
+}
+
 #ifdef BIDIR_USE_STDMALLOC
 
 static void* alloc_entry(struct __hash *h, int size)
@@ -265,28 +324,27 @@ static int shm_mutex_unlock(struct shm_hdr *h)
 }
 
 
-/* Shared memory allocator freelist */
-static void shm_add_to_freelist(struct shm_hdr *hdr, uint32_t sl)
+/* Shared memory allocator freelist, the callers hold the mutex */
+static void shm_freelist_push(uint32_t *freelist, uint32_t sl)
 {
-    uint32_t *freelist = get_shm_freelist(hdr);
-
-    shm_mutex_lock(hdr);
     freelist[sl+1] = freelist[0];
     freelist[0] = sl;
-    shm_mutex_unlock(hdr);
 }
 
-static uint32_t shm_get_from_freelist(struct shm_hdr *hdr)
+static uint32_t shm_freelist_pop(uint32_t *freelist)
 {
-    uint32_t *freelist = get_shm_freelist(hdr);
-    uint32_t slot;
+    uint32_t slot = freelist[0];
 
-    shm_mutex_lock(hdr);
-    slot = freelist[0];
     freelist[0] = freelist[slot+1];
-    shm_mutex_unlock(hdr);
 
-    return (slot == 0 ? -1 : slot);
+    return slot;
+}
+
+static void shm_add_to_freelist(struct shm_hdr *hdr, uint32_t sl)
+{
+    shm_mutex_lock(hdr);
+    shm_freelist_push(get_shm_freelist(hdr), sl);
+    shm_mutex_unlock(hdr);
 }
 
 
@@ -351,14 +409,90 @@ struct __hash* __shm_hash_get(unsigned long shm_baddr)
     return (hdr->hash_allocated ? &hdr->hash : NULL);
 }
 
+/*
+ * Entries are handed to each process in batches, so that the shared
+ * allocator mutex isn't taken on every insert and remove.  At most
+ * 2 * ENTRY_CACHE_SIZE entries are held back by any one process; they are
+ * returned when it exits.  A process killed by a signal never returns
+ * them, and they stay lost until the shared area is recreated, so the
+ * batches are kept small: a few dead tapdisks cost a negligible share of
+ * the table.
+ */
+#define ENTRY_CACHE_SIZE 16
+
+static struct {
+    pthread_mutex_t lock;
+    struct shm_hdr *hdr;
+    int             nr;
+    uint32_t        slots[2 * ENTRY_CACHE_SIZE];
+} entry_cache = { PTHREAD_MUTEX_INITIALIZER };
+
+static pthread_once_t entry_cache_once = PTHREAD_ONCE_INIT;
+
+static void entry_cache_flush(void)
+{
+    uint32_t *freelist;
+
+    pthread_mutex_lock(&entry_cache.lock);
+    if(entry_cache.nr > 0)
+    {
+        freelist = get_shm_freelist(entry_cache.hdr);
+        shm_mutex_lock(entry_cache.hdr);
+        while(entry_cache.nr > 0)
+            shm_freelist_push(freelist,
+                              entry_cache.slots[--entry_cache.nr]);
+        shm_mutex_unlock(entry_cache.hdr);
+    }
+    pthread_mutex_unlock(&entry_cache.lock);
+}
+
+static void entry_cache_atfork_child(void)
+{
+    /* The entries belong to the parent, forget about them */
+    pthread_mutex_init(&entry_cache.lock, NULL);
+    entry_cache.nr = 0;
+}
+
+static void entry_cache_setup(void)
+{
+    atexit(entry_cache_flush);
+    pthread_atfork(NULL, NULL, entry_cache_atfork_child);
+}
+
 static void* alloc_entry(struct __hash *h, int size)
 {
     struct shm_hdr *hdr = get_shm_hdr(h);
-    uint32_t slot = shm_get_from_freelist(hdr);
+    uint32_t *freelist;
+    uint32_t slot;
 
     assert(size == sizeof(struct hash_entry));
-    if(slot == -1)
+
+    pthread_once(&entry_cache_once, entry_cache_setup);
+    pthread_mutex_lock(&entry_cache.lock);
+    if(entry_cache.hdr != hdr)
+    {
+        pthread_mutex_unlock(&entry_cache.lock);
+        entry_cache_flush();
+        pthread_mutex_lock(&entry_cache.lock);
+        entry_cache.hdr = hdr;
+    }
+    if(entry_cache.nr == 0)
+    {
+        /* Refill with a batch from the shared freelist */
+        freelist = get_shm_freelist(hdr);
+        shm_mutex_lock(hdr);
+        /* Slot 0 is never allocated, it marks the end of the freelist */
+        while((entry_cache.nr < ENTRY_CACHE_SIZE) && (freelist[0] != 0))
+            entry_cache.slots[entry_cache.nr++] = shm_freelist_pop(freelist);
+        shm_mutex_unlock(hdr);
+    }
+    if(entry_cache.nr == 0)
+    {
+        pthread_mutex_unlock(&entry_cache.lock);
         return NULL;
+    }
+    slot = entry_cache.slots[--entry_cache.nr];
+    pthread_mutex_unlock(&entry_cache.lock);
 
     return (get_shm_entries(hdr) + slot);
 }
@@ -397,11 +531,31 @@ static void alloc_buckets(struct __hash *h,
 static void free_entry(struct __hash *h, void *p)
 {
     struct shm_hdr *hdr = get_shm_hdr(h);
+    uint32_t *freelist;
     uint32_t slot;
 
     slot = ((uint32_t)((struct hash_entry *)p -
                 get_shm_entries(hdr)));
-    shm_add_to_freelist(hdr, slot);
+
+    pthread_mutex_lock(&entry_cache.lock);
+    if(entry_cache.hdr != hdr)
+    {
+        pthread_mutex_unlock(&entry_cache.lock);
+        shm_add_to_freelist(hdr, slot);
+        return;
+    }
+    entry_cache.slots[entry_cache.nr++] = slot;
+    if(entry_cache.nr == 2 * ENTRY_CACHE_SIZE)
+    {
+        /* Give half of the cache back */
+        freelist = get_shm_freelist(hdr);
+        shm_mutex_lock(hdr);
+        while(entry_cache.nr > ENTRY_CACHE_SIZE)
+            shm_freelist_push(freelist,
+                              entry_cache.slots[--entry_cache.nr]);
+        shm_mutex_unlock(hdr);
+    }
+    pthread_mutex_unlock(&entry_cache.lock);
 }
 
 static void free_buckets(struct __hash *h,
@@ -561,6 +715,26 @@ static int max_entries(struct __hash *h)
     pthread_rwlock_unlock(&(_lock)->bucket_lock);                              \
 })
 
+/*
+ * Lookups normally walk the chains without locks, relying on entries and
+ * tables never leaving the shared area.  With malloc() they are freed for
+ * real, so lookups take the same read locks as other operations instead;
+ * writers are then excluded and the sequence counts never force a retry.
+ */
+#ifdef BIDIR_USE_STDMALLOC
+#define LOOKUP_RDLOCK(_h)           HASH_LOCK_RDLOCK(_h)
+#define LOOKUP_RDUNLOCK(_h)         HASH_LOCK_RDUNLOCK(_h)
+#define LOOKUP_BUCKET_RDLOCK(_h, _lock_tab, _idx)                              \
+    BUCKET_LOCK_RDLOCK(_h, _lock_tab, _idx)
+#define LOOKUP_BUCKET_RDUNLOCK(_h, _lock_tab, _idx)                            \
+    BUCKET_LOCK_RDUNLOCK(_h, _lock_tab, _idx)
+#else
+#define LOOKUP_RDLOCK(_h)           0
+#define LOOKUP_RDUNLOCK(_h)         do { } while(0)
+#define LOOKUP_BUCKET_RDLOCK(_h, _lock_tab, _idx)       0
+#define LOOKUP_BUCKET_RDUNLOCK(_h, _lock_tab, _idx)     do { } while(0)
+#endif
+
 #define TWO_BUCKETS_LOCK_WRLOCK(_h, _blt1, _idx1, _blt2, _idx2)  ({            \
     int _ret;                                                                  \
     pthread_rwlock_t *_l1, *_l2;                                               \
@@ -667,6 +841,12 @@ struct __hash *__hash_init(struct __hash *h, uint32_t min_size)
     h->size_idx = size_idx;
     h->max_load = (uint32_t)ceilf(hash_max_load_fact * size);
     h->min_load = (uint32_t)ceilf(hash_min_load_fact * size);
+    h->tab_seq = 0;
+    h->tab_gen = 0;
+    h->old_key_tab = h->old_value_tab = NULL;
+    h->old_key_lock_tab = h->old_value_lock_tab = NULL;
+    h->old_tab_size = 0;
+    h->key_moved = h->value_moved = 0;
 
     return h;
 
@@ -693,37 +873,82 @@ alloc_fail:
 #define __prim_hash      __key_hash
 #define __prim_cmp       __key_cmp
 #define __prim_next        key_next
+#define __prim_old_tab     old_key_tab
+#define __prim_old_lock_tab old_key_lock_tab
+#define __prim_moved       key_moved
 #define __sec              value
 #define __sec_t          __v_t
 int __key_lookup(struct __hash *h, __prim_t k, __sec_t *vp)
 {
     struct hash_entry *entry;
-    struct bucket *b;
-    struct bucket_lock *blt;
-    uint32_t idx;
+    struct bucket *tab;
+    struct bucket_lock *lock_tab;
+    volatile uint32_t *seq;
+    uint32_t hash, idx, tseq, bseq, gen, n;
+    int old, found;
+    __sec_t v;
 
-    if(HASH_LOCK_RDLOCK(h) != 0) return -ENOLCK;
-    idx = hash_to_idx(h, __prim_hash(k));
-    b = C2L(h, &h->__prim_tab[idx]);
-    blt = C2L(h, h->__prim_lock_tab);
-    if(BUCKET_LOCK_RDLOCK(h, blt, idx) != 0) return -ENOLCK;
-    entry = b->hash_entry;
-    while(entry != NULL)
+    if(!h->lock_alive) return -ENOLCK;
+    hash = __prim_hash(k);
+    if(LOOKUP_RDLOCK(h) != 0) return -ENOLCK;
+
+again:
+    /* Find the bucket, in the old table if it hasn't been migrated yet */
+    tseq = seq_read_begin(&h->tab_seq);
+    gen = h->tab_gen;
+    old = 0;
+    if(h->old_tab_size != 0 &&
+       (hash % h->old_tab_size) >= h->__prim_moved)
+    {
+        old = 1;
+        idx = hash % h->old_tab_size;
+        tab = C2L(h, h->__prim_old_tab);
+        lock_tab = C2L(h, h->__prim_old_lock_tab);
+    }
+    else
+    {
+        idx = hash_to_idx(h, hash);
+        tab = C2L(h, h->__prim_tab);
+        lock_tab = C2L(h, h->__prim_lock_tab);
+    }
+    if(seq_read_retry(&h->tab_seq, tseq)) goto again;
+
+    if(LOOKUP_BUCKET_RDLOCK(h, lock_tab, idx) != 0)
     {
+        LOOKUP_RDUNLOCK(h);
+        return -ENOLCK;
+    }
+    seq = bucket_seq(lock_tab, idx);
+    bseq = seq_read_begin(seq);
+    /* The bucket may have been migrated before we got here */
+    if(old && (idx < h->__prim_moved))
+    {
+        LOOKUP_BUCKET_RDUNLOCK(h, lock_tab, idx);
+        goto again;
+    }
+
+    found = 0;
+    entry = tab[idx].hash_entry;
+    for(n = 0; entry != NULL; n++)
+    {
+        /* Chains only get this long when racing with a writer */
+        if(n > (uint32_t)max_entries(h)) break;
         entry = C2L(h, entry);
         if(__prim_cmp(k, entry->__prim))
         {
-            /* Unlock here */
-            *vp = entry->__sec;
-            BUCKET_LOCK_RDUNLOCK(h, blt, idx);
-            HASH_LOCK_RDUNLOCK(h);
-            return 1;
+            v = entry->__sec;
+            found = 1;
+            break;
         }
         entry = entry->__prim_next;
     }
-    BUCKET_LOCK_RDUNLOCK(h, blt, idx);
-    HASH_LOCK_RDUNLOCK(h);
-    return 0;
+    LOOKUP_BUCKET_RDUNLOCK(h, lock_tab, idx);
+    if((!found && (entry != NULL)) ||
+       seq_read_retry(seq, bseq) || (h->tab_gen != gen)) goto again;
+    LOOKUP_RDUNLOCK(h);
+
+    if(found) *vp = v;
+    return found;
 }
 
 /* value lookup is an almost exact copy of key lookup */
@@ -734,6 +959,9 @@ int __key_lookup(struct __hash *h, __prim_t k, __sec_t *vp)
 #undef __prim_hash
 #undef __prim_cmp
 #undef __prim_next
+#undef __prim_old_tab
+#undef __prim_old_lock_tab
+#undef __prim_moved
 #undef __sec
 #undef __sec_t
 
@@ -744,37 +972,82 @@ int __key_lookup(struct __hash *h, __prim_t k, __sec_t *vp)
 #define __prim_hash      __value_hash
 #define __prim_cmp       __value_cmp
 #define __prim_next        value_next
+#define __prim_old_tab     old_value_tab
+#define __prim_old_lock_tab old_value_lock_tab
+#define __prim_moved       value_moved
 #define __sec              key
 #define __sec_t          __k_t
 int __value_lookup(struct __hash *h, __prim_t k, __sec_t *vp)
 {
     struct hash_entry *entry;
-    struct bucket *b;
-    struct bucket_lock *blt;
-    uint32_t idx;
+    struct bucket *tab;
+    struct bucket_lock *lock_tab;
+    volatile uint32_t *seq;
+    uint32_t hash, idx, tseq, bseq, gen, n;
+    int old, found;
+    __sec_t v;
 
-    if(HASH_LOCK_RDLOCK(h) != 0) return -ENOLCK;
-    idx = hash_to_idx(h, __prim_hash(k));
-    b = C2L(h, &h->__prim_tab[idx]);
-    blt = C2L(h, h->__prim_lock_tab);
-    if(BUCKET_LOCK_RDLOCK(h, blt, idx) != 0) return -ENOLCK;
-    entry = b->hash_entry;
-    while(entry != NULL)
+    if(!h->lock_alive) return -ENOLCK;
+    hash = __prim_hash(k);
+    if(LOOKUP_RDLOCK(h) != 0) return -ENOLCK;
+
+again:
+    /* Find the bucket, in the old table if it hasn't been migrated yet */
+    tseq = seq_read_begin(&h->tab_seq);
+    gen = h->tab_gen;
+    old = 0;
+    if(h->old_tab_size != 0 &&
+       (hash % h->old_tab_size) >= h->__prim_moved)
+    {
+        old = 1;
+        idx = hash % h->old_tab_size;
+        tab = C2L(h, h->__prim_old_tab);
+        lock_tab = C2L(h, h->__prim_old_lock_tab);
+    }
+    else
+    {
+        idx = hash_to_idx(h, hash);
+        tab = C2L(h, h->__prim_tab);
+        lock_tab = C2L(h, h->__prim_lock_tab);
+    }
+    if(seq_read_retry(&h->tab_seq, tseq)) goto again;
+
+    if(LOOKUP_BUCKET_RDLOCK(h, lock_tab, idx) != 0)
+    {
+        LOOKUP_RDUNLOCK(h);
+        return -ENOLCK;
+    }
+    seq = bucket_seq(lock_tab, idx);
+    bseq = seq_read_begin(seq);
+    /* The bucket may have been migrated before we got here */
+    if(old && (idx < h->__prim_moved))
     {
+        LOOKUP_BUCKET_RDUNLOCK(h, lock_tab, idx);
+        goto again;
+    }
+
+    found = 0;
+    entry = tab[idx].hash_entry;
+    for(n = 0; entry != NULL; n++)
+    {
+        /* Chains only get this long when racing with a writer */
+        if(n > (uint32_t)max_entries(h)) break;
         entry = C2L(h, entry);
         if(__prim_cmp(k, entry->__prim))
         {
-            /* Unlock here */
-            *vp = entry->__sec;
-            BUCKET_LOCK_RDUNLOCK(h, blt, idx);
-            HASH_LOCK_RDUNLOCK(h);
-            return 1;
+            v = entry->__sec;
+            found = 1;
+            break;
         }
         entry = entry->__prim_next;
     }
-    BUCKET_LOCK_RDUNLOCK(h, blt, idx);
-    HASH_LOCK_RDUNLOCK(h);
-    return 0;
+    LOOKUP_BUCKET_RDUNLOCK(h, lock_tab, idx);
+    if((!found && (entry != NULL)) ||
+       seq_read_retry(seq, bseq) || (h->tab_gen != gen)) goto again;
+    LOOKUP_RDUNLOCK(h);
+
+    if(found) *vp = v;
+    return found;
 }
 
 int __insert(struct __hash *h, __k_t k, __v_t v)
@@ -814,10 +1087,14 @@ int __insert(struct __hash *h, __k_t k, __v_t v)
     bltv = C2L(h, h->value_lock_tab);
     if(TWO_BUCKETS_LOCK_WRLOCK(h, bltk, k_idx, bltv, v_idx) != 0)
         return -ENOLCK;
+    seq_write_begin(bucket_seq(bltk, k_idx));
+    seq_write_begin(bucket_seq(bltv, v_idx));
     entry->key_next = bk->hash_entry;
     bk->hash_entry = L2C(h, entry);
     entry->value_next = bv->hash_entry;
     bv->hash_entry = L2C(h, entry);
+    seq_write_end(bucket_seq(bltv, v_idx));
+    seq_write_end(bucket_seq(bltk, k_idx));
     TWO_BUCKETS_LOCK_WRUNLOCK(h, bltk, k_idx, bltv, v_idx);
 
     /* Book keeping */
@@ -836,6 +1113,9 @@ int __insert(struct __hash *h, __k_t k, __v_t v)
 #undef __prim_hash
 #undef __prim_cmp
 #undef __prim_next
+#undef __prim_old_tab
+#undef __prim_old_lock_tab
+#undef __prim_moved
 #undef __sec
 #undef __sec_t
 #undef __sec_tab
@@ -952,8 +1232,12 @@ found_again:
         if(e == es)
         {
             /* Both pek and pev are pointing to the right place, remove */
+            seq_write_begin(bucket_seq(bltk, kidx));
+            seq_write_begin(bucket_seq(bltv, vidx));
             *pek = e->__prim_next;
             *pev = e->__sec_next;
+            seq_write_end(bucket_seq(bltv, vidx));
+            seq_write_end(bucket_seq(bltk, kidx));
 
             atomic_dec(&h->nr_ent);
             nr_ent = h->nr_ent;
@@ -1101,8 +1385,12 @@ found_again:
         if(e == es)
         {
             /* Both pek and pev are pointing to the right place, remove */
+            seq_write_begin(bucket_seq(bltk, kidx));
+            seq_write_begin(bucket_seq(bltv, vidx));
             *pek = e->__prim_next;
             *pev = e->__sec_next;
+            seq_write_end(bucket_seq(bltv, vidx));
+            seq_write_end(bucket_seq(bltk, kidx));
 
             atomic_dec(&h->nr_ent);
             nr_ent = h->nr_ent;
@@ -1162,13 +1450,55 @@ int __hash_destroy(struct __hash *h,
     return 0;
 }
 
+/*
+ * Moves the entries of one bucket of the old key (or value) table to the new
+ * one.  Called with the hash write lock held, so only lookups can race.
+ */
+static void migrate_bucket(struct __hash *h, int key, uint32_t i)
+{
+    struct bucket *old_tab, *tab;
+    struct bucket_lock *old_lock_tab, *lock_tab;
+    struct hash_entry *e, *n, **pnext;
+    volatile uint32_t *old_seq, *seq;
+    uint32_t idx;
+
+    old_tab      = C2L(h, key ? h->old_key_tab : h->old_value_tab);
+    old_lock_tab = C2L(h, key ? h->old_key_lock_tab : h->old_value_lock_tab);
+    tab          = C2L(h, key ? h->key_tab : h->value_tab);
+    lock_tab     = C2L(h, key ? h->key_lock_tab : h->value_lock_tab);
+
+    old_seq = bucket_seq(old_lock_tab, i);
+    seq_write_begin(old_seq);
+    e = old_tab[i].hash_entry;
+    old_tab[i].hash_entry = NULL;
+    while(e != NULL)
+    {
+        e = C2L(h, e);
+        pnext = key ? &e->key_next : &e->value_next;
+        n = *pnext;
+        idx = hash_to_idx(h, key ? __key_hash(e->key) :
+                                   __value_hash(e->value));
+        seq = bucket_seq(lock_tab, idx);
+        seq_write_begin(seq);
+        *pnext = tab[idx].hash_entry;
+        tab[idx].hash_entry = L2C(h, e);
+        seq_write_end(seq);
+        e = n;
+    }
+    /* Lookups for this bucket go to the new table from now on */
+    if(key)
+        h->key_moved = i + 1;
+    else
+        h->value_moved = i + 1;
+    seq_write_end(old_seq);
+}
+
 static void hash_resize(struct __hash *h)
 {
-    int new_size_idx, i, lock_ret;
-    uint32_t size, old_size, kidx, vidx;
-    struct bucket *t1, *t2, *b;
+    int new_size_idx, lock_ret;
+    uint32_t i, size;
+    struct bucket *t1, *t2;
     struct bucket_lock *l1, *l2;
-    struct hash_entry *e, *n;
 
     /* We may fail to allocate the lock, if the resize is triggered while
        we are iterating (under read lock) */
@@ -1199,37 +1529,48 @@ static void hash_resize(struct __hash *h)
     alloc_tab(h, size, &t2, &l2);
     if(!t2 || !l2) goto alloc_fail;
 
-    old_size = h->tab_size;
+    /*
+     * Install the new tables next to the old ones.  Writers are kept out by
+     * the hash lock, but lookups carry on throughout: they use the old
+     * tables for buckets that haven't been migrated yet.
+     */
+    seq_write_begin(&h->tab_seq);
+    h->old_key_tab        = h->key_tab;
+    h->old_key_lock_tab   = h->key_lock_tab;
+    h->old_value_tab      = h->value_tab;
+    h->old_value_lock_tab = h->value_lock_tab;
+    h->old_tab_size       = h->tab_size;
+    h->key_moved          = 0;
+    h->value_moved        = 0;
+    h->key_tab            = L2C(h, t1);
+    h->key_lock_tab       = L2C(h, l1);
+    h->value_tab          = L2C(h, t2);
+    h->value_lock_tab     = L2C(h, l2);
     h->tab_size = size;
     h->size_idx = new_size_idx;
     h->max_load = (uint32_t)ceilf(hash_max_load_fact * size);
     h->min_load = (uint32_t)ceilf(hash_min_load_fact * size);
+    seq_write_end(&h->tab_seq);
 
     /* Move the entries */
-    for(i=0; i < old_size; i++)
-    {
-        b = C2L(h, &h->key_tab[i]);
-        e = b->hash_entry;
-        while(e != NULL)
-        {
-            e = C2L(h, e);
-            n = e->key_next;
-            kidx =hash_to_idx(h, __key_hash(e->key));
-            vidx =hash_to_idx(h, __value_hash(e->value));
-            /* Move to the correct bucket */
-            e->key_next = t1[kidx].hash_entry;
-            t1[kidx].hash_entry = L2C(h, e);
-            e->value_next = t2[vidx].hash_entry;
-            t2[vidx].hash_entry = L2C(h, e);
-            e = n;
-        }
-    }
-    free_buckets(h, C2L(h, h->key_tab), C2L(h, h->key_lock_tab));
-    free_buckets(h, C2L(h, h->value_tab), C2L(h, h->value_lock_tab));
-    h->key_tab         = L2C(h, t1);
-    h->key_lock_tab    = L2C(h, l1);
-    h->value_tab       = L2C(h, t2);
-    h->value_lock_tab  = L2C(h, l2);
+    for(i=0; i < h->old_tab_size; i++)
+        migrate_bucket(h, 1, i);
+    for(i=0; i < h->old_tab_size; i++)
+        migrate_bucket(h, 0, i);
+
+    /* Lookups still in the old tables will notice tab_gen change */
+    t1 = C2L(h, h->old_key_tab);
+    l1 = C2L(h, h->old_key_lock_tab);
+    t2 = C2L(h, h->old_value_tab);
+    l2 = C2L(h, h->old_value_lock_tab);
+    seq_write_begin(&h->tab_seq);
+    h->old_key_tab = h->old_value_tab = NULL;
+    h->old_key_lock_tab = h->old_value_lock_tab = NULL;
+    h->old_tab_size = 0;
+    h->tab_gen++;
+    seq_write_end(&h->tab_seq);
+    free_buckets(h, t1, l1);
+    free_buckets(h, t2, l2);
 
     HASH_LOCK_WRUNLOCK(h);
 
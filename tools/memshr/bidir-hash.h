@@ -57,7 +57,7 @@ static int fgprtshr_fgprt_cmp(uint32_t h1, uint32_t h2)
     return (h1 == h2);
 }
 
-static int fgprtshr_mfn_cmp(uint32_t m1, uint32_t m2)
+static int fgprtshr_mfn_cmp(uint64_t m1, uint64_t m2)
 {
     return (m1 == m2);
 }
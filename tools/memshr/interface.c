@@ -24,6 +24,7 @@
 #include "bidir-hash.h"
 #include "shm.h"
 #include "bidir-daemon.h"
+#include "scanner.h"
 
 typedef struct {
     int     enabled;
@@ -33,6 +34,9 @@ typedef struct {
 
 memshr_vbd_info_t vbd_info = {0, DOMID_INVALID};
 
+/* Percentage of CPU time the content scanner may use, 0 disables it */
+static int scan_budget = MEMSHR_SCAN_BUDGET_DEFAULT;
+
 
 typedef struct {
     struct shared_memshr_info *shared_info;
@@ -49,6 +53,11 @@ void memshr_set_domid(int domid)
     vbd_info.domid = domid;
 }
 
+void memshr_set_scan_budget(int percent)
+{
+    scan_budget = percent;
+}
+
 void memshr_daemon_initialize(void)
 {
     void *shm_base_addr;
@@ -77,6 +86,7 @@ void memshr_daemon_initialize(void)
     memshr.shared_info->blockshr_hash_inited = 1;
     
     bidir_daemon_initialize(memshr.blks);
+    scanner_daemon_initialize(memshr.fgprts, scan_budget);
 }
 
 
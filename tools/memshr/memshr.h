@@ -25,7 +25,11 @@
 
 typedef uint64_t xen_mfn_t;
 
+/* Content scanner CPU budget, in percent; the scanner is off by default */
+#define MEMSHR_SCAN_BUDGET_DEFAULT  0
+
 extern void memshr_set_domid(int domid);
+extern void memshr_set_scan_budget(int percent);
 extern void memshr_daemon_initialize(void);
 extern void memshr_vbd_initialize(void);
 extern uint16_t memshr_vbd_image_get(char* file);
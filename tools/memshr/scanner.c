@@ -0,0 +1,419 @@
+/******************************************************************************
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * Content based page sharing.
+ *
+ * The scanner walks the memory of HVM guests in batches, hashes every page
+ * and records the fingerprints in the fgprtshr hash.  The first page seen
+ * with a given fingerprint is only remembered by its location (a page id).
+ * When another page with the same fingerprint turns up, both are nominated
+ * for sharing, compared in full and, if identical, shared.  From then on the
+ * fingerprint maps to the sharing handle of the source page.
+ *
+ * Pages are compared only after they have been nominated: a nominated page
+ * is write protected, and any guest write to it invalidates its handle, so
+ * the subsequent share fails rather than merging pages that differ.
+ *
+ * The scanner runs for at most budget percent of the wall clock time.
+ * It is off unless blktapctrl is given a non-zero budget in the
+ * MEMSHR_SCAN_BUDGET environment variable.
+ */
+#include <pthread.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#include "bidir-hash.h"
+#include "memshr-priv.h"
+#include "scanner.h"
+
+/* Number of pages mapped and hashed at once */
+#define SCAN_BATCH          256
+
+/* Fingerprints of pages which haven't been nominated yet */
+#define PAGE_ID_TAG         (1ULL << 63)
+#define PAGE_ID(_d, _g)     (PAGE_ID_TAG | ((uint64_t)(_d) << 40) | (_g))
+#define PAGE_ID_DOMID(_v)   ((domid_t)((_v) >> 40))
+#define PAGE_ID_GFN(_v)     ((unsigned long)((_v) & ((1ULL << 40) - 1)))
+
+/* Locations of the source pages of sharing handles, direct mapped */
+#define SOURCES_SIZE        (1 << 16)
+
+typedef struct {
+    uint64_t      hnd;
+    uint64_t      hash;
+    domid_t       domid;
+    unsigned long gfn;
+} source_t;
+
+typedef struct {
+    uint64_t pages;
+    uint64_t shared;
+    uint64_t collisions;
+    uint64_t stale;
+} scan_stats_t;
+
+static struct fgprtshr_hash *fgprts;
+static int scan_budget;
+static int xc_handle;
+
+static source_t sources[SOURCES_SIZE];
+static scan_stats_t stats;
+
+
+static uint64_t page_hash(const void *page)
+{
+    const uint64_t *p = page;
+    uint64_t h1 = 0x9e3779b97f4a7c15ULL, h2 = 0xc2b2ae3d27d4eb4fULL;
+    int i;
+
+    /* Two independent lanes, so that the multiplies can overlap */
+    for(i = 0; i < XC_PAGE_SIZE / sizeof(*p); i += 2)
+    {
+        h1 ^= p[i] * 0x87c37b91114253d5ULL;
+        h1 = ((h1 << 31) | (h1 >> 33)) * 0x4cf5ad432745937fULL;
+        h2 ^= p[i + 1] * 0x4cf5ad432745937fULL;
+        h2 = ((h2 << 33) | (h2 >> 31)) * 0x87c37b91114253d5ULL;
+    }
+
+    h1 ^= h2;
+    h1 ^= h1 >> 33;
+    h1 *= 0xff51afd7ed558ccdULL;
+    h1 ^= h1 >> 33;
+
+    return h1;
+}
+
+static inline uint32_t hash_to_fgprt(uint64_t hash)
+{
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static source_t* source_get(uint64_t hnd)
+{
+    source_t *s = &sources[hnd & (SOURCES_SIZE - 1)];
+
+    return (s->hnd == hnd) ? s : NULL;
+}
+
+static void source_set(uint64_t hnd, uint64_t hash,
+                       domid_t domid, unsigned long gfn)
+{
+    source_t *s = &sources[hnd & (SOURCES_SIZE - 1)];
+
+    s->hnd   = hnd;
+    s->hash  = hash;
+    s->domid = domid;
+    s->gfn   = gfn;
+}
+
+/* Points the fingerprint at a new page id or sharing handle */
+static void fgprt_replace(uint32_t fgprt, uint64_t old, uint64_t new)
+{
+    if(old != 0)
+        fgprtshr_mfn_remove(fgprts, old, NULL);
+    if(fgprtshr_insert(fgprts, fgprt, new) <= 0)
+        DPRINTF("Could not insert fingerprint %x into hash.\n", fgprt);
+}
+
+/*
+ * Returns 1 if the page at (domid, gfn) has the expected contents.
+ * Otherwise returns 0 and the hash of what is there instead.
+ */
+static int page_compare(domid_t domid, unsigned long gfn, const void *expect,
+                        uint64_t *hash)
+{
+    void *page;
+    int same;
+
+    *hash = 0;
+    page = xc_map_foreign_range(xc_handle, domid, XC_PAGE_SIZE,
+                                PROT_READ, gfn);
+    if(page == NULL)
+        return 0;
+    same = (memcmp(page, expect, XC_PAGE_SIZE) == 0);
+    if(!same)
+        *hash = page_hash(page);
+    munmap(page, XC_PAGE_SIZE);
+
+    return same;
+}
+
+/* Reads the page at (domid, gfn) into buf */
+static int page_copy(domid_t domid, unsigned long gfn, void *buf)
+{
+    void *page;
+
+    page = xc_map_foreign_range(xc_handle, domid, XC_PAGE_SIZE,
+                                PROT_READ, gfn);
+    if(page == NULL)
+        return -1;
+    memcpy(buf, page, XC_PAGE_SIZE);
+    munmap(page, XC_PAGE_SIZE);
+
+    return 0;
+}
+
+/*
+ * Tries to share the page at (domid, gfn), which hashed to hash, with the
+ * page the fingerprint currently maps to (v).
+ */
+static void scan_match(domid_t domid, unsigned long gfn, uint64_t hash,
+                       uint64_t v, void *buf)
+{
+    uint32_t fgprt = hash_to_fgprt(hash);
+    uint64_t s_hnd, c_hnd, s_hash;
+    source_t *s;
+    int ret;
+
+    /* Nominate the source first, if this is the first match */
+    if(v & PAGE_ID_TAG)
+    {
+        if(xc_memshr_nominate_gfn(xc_handle, PAGE_ID_DOMID(v),
+                                  PAGE_ID_GFN(v), &s_hnd) != 0)
+        {
+            /* Gone, in use or already shared: let this page replace it */
+            stats.stale++;
+            fgprt_replace(fgprt, v, PAGE_ID(domid, gfn));
+            return;
+        }
+        source_set(s_hnd, hash, PAGE_ID_DOMID(v), PAGE_ID_GFN(v));
+        fgprt_replace(fgprt, v, s_hnd);
+        v = s_hnd;
+    }
+
+    s_hnd = v;
+    s = source_get(s_hnd);
+
+    if(xc_memshr_nominate_gfn(xc_handle, domid, gfn, &c_hnd) != 0)
+        return;
+
+    /* Both pages are write protected now, compare them */
+    if(page_copy(domid, gfn, buf) != 0)
+        return;
+    if(page_hash(buf) != hash)
+    {
+        /* The client has changed since it was hashed */
+        stats.stale++;
+        return;
+    }
+    if((s == NULL) || !page_compare(s->domid, s->gfn, buf, &s_hash))
+    {
+        if((s != NULL) && (s_hash == hash))
+        {
+            /* Same hash, different content */
+            stats.collisions++;
+            return;
+        }
+        /* The source is unknown or has changed, replace it by the client */
+        stats.stale++;
+        source_set(c_hnd, hash, domid, gfn);
+        fgprt_replace(fgprt, s_hnd, c_hnd);
+        return;
+    }
+
+    ret = xc_memshr_share(xc_handle, s_hnd, c_hnd);
+    if(!ret)
+    {
+        stats.shared++;
+        return;
+    }
+
+    switch(ret)
+    {
+        case XEN_DOMCTL_MEM_SHARING_S_HANDLE_INVALID:
+            stats.stale++;
+            source_set(c_hnd, hash, domid, gfn);
+            fgprt_replace(fgprt, s_hnd, c_hnd);
+            break;
+        case XEN_DOMCTL_MEM_SHARING_C_HANDLE_INVALID:
+        default:
+            break;
+    }
+}
+
+static void scan_batch(domid_t domid, xen_pfn_t *gfns, int nr)
+{
+    static uint64_t hashes[SCAN_BATCH];
+    static int errs[SCAN_BATCH];
+    static char buf[XC_PAGE_SIZE];
+    uint64_t v;
+    char *pages;
+    int i;
+
+    pages = xc_map_foreign_bulk(xc_handle, domid, PROT_READ, gfns, errs, nr);
+    if(pages == NULL)
+        return;
+
+    for(i = 0; i < nr; i++)
+        if(!errs[i])
+            hashes[i] = page_hash(pages + i * XC_PAGE_SIZE);
+
+    /* Nomination requires the pages not to be mapped */
+    munmap(pages, nr * XC_PAGE_SIZE);
+
+    for(i = 0; i < nr; i++)
+    {
+        if(errs[i])
+            continue;
+        stats.pages++;
+
+        if(fgprtshr_fgprt_lookup(fgprts, hash_to_fgprt(hashes[i]), &v) <= 0)
+            fgprt_replace(hash_to_fgprt(hashes[i]), 0, PAGE_ID(domid, gfns[i]));
+        else if(v != PAGE_ID(domid, gfns[i]))
+            scan_match(domid, gfns[i], hashes[i], v, buf);
+    }
+}
+
+struct prune_list {
+    uint64_t *ids;
+    int nr, max;
+};
+
+static int collect_page_id(uint32_t fgprt, xen_mfn_t v, void *p)
+{
+    struct prune_list *l = p;
+
+    if(v & PAGE_ID_TAG)
+        l->ids[l->nr++] = v;
+
+    return (l->nr == l->max);
+}
+
+/* Drops some not yet shared fingerprints, once the hash is 90% full */
+static void scan_prune(void)
+{
+    uint32_t nr_ent, max_nr_ent;
+    struct prune_list l;
+
+    fgprtshr_hash_sizes(fgprts, &nr_ent, &max_nr_ent, NULL, NULL, NULL);
+    if(10 * nr_ent <= 9 * max_nr_ent)
+        return;
+
+    l.nr  = 0;
+    l.max = max_nr_ent / 10 + 1;
+    l.ids = calloc(l.max, sizeof(*l.ids));
+    if(l.ids == NULL)
+        return;
+
+    /* Entries can't be removed while the iterator holds the bucket locks */
+    fgprtshr_hash_iterator(fgprts, collect_page_id, &l);
+    while(l.nr > 0)
+        fgprtshr_mfn_remove(fgprts, l.ids[--l.nr], NULL);
+
+    free(l.ids);
+}
+
+/* Sleeps long enough to keep within the CPU budget */
+static void scan_throttle(struct timeval *start)
+{
+    struct timeval now;
+    uint64_t busy;
+
+    gettimeofday(&now, NULL);
+    busy = (now.tv_sec - start->tv_sec) * (uint64_t)1000000 +
+           now.tv_usec - start->tv_usec;
+    usleep(busy * (100 - scan_budget) / scan_budget);
+    gettimeofday(start, NULL);
+}
+
+static void scan_domain(domid_t domid)
+{
+    static xen_pfn_t gfns[SCAN_BATCH];
+    struct timeval start;
+    unsigned long gfn, max_gfn;
+    int nr;
+
+    max_gfn = xc_memory_op(xc_handle, XENMEM_maximum_gpfn, &domid);
+    if((long)max_gfn < 0)
+        return;
+    gettimeofday(&start, NULL);
+
+    for(gfn = 0; gfn <= max_gfn; )
+    {
+        for(nr = 0; (nr < SCAN_BATCH) && (gfn <= max_gfn); nr++)
+            gfns[nr] = gfn++;
+        scan_batch(domid, gfns, nr);
+        scan_prune();
+        scan_throttle(&start);
+    }
+}
+
+void* scanner_daemon(void *unused)
+{
+    xc_dominfo_t info;
+    struct timeval start, end;
+    scan_stats_t last;
+    uint64_t usecs;
+    domid_t domid;
+
+    while(1)
+    {
+        last = stats;
+        gettimeofday(&start, NULL);
+
+        for(domid = 1;
+            xc_domain_getinfo(xc_handle, domid, 1, &info) == 1;
+            domid = info.domid + 1)
+        {
+            /* Only HVM guests support sharing */
+            if(info.hvm && !info.dying && !info.shutdown)
+                scan_domain(info.domid);
+        }
+
+        gettimeofday(&end, NULL);
+        usecs = (end.tv_sec - start.tv_sec) * (uint64_t)1000000 +
+                end.tv_usec - start.tv_usec + 1;
+        DPRINTF("Scanned %"PRIu64" pages in %"PRIu64" ms (%"PRIu64" pages/s),"
+                " shared %"PRIu64", %"PRIu64" collisions, %"PRIu64" stale;"
+                " %"PRIu64" pages shared in total\n",
+                stats.pages - last.pages, usecs / 1000,
+                (stats.pages - last.pages) * (uint64_t)1000000 / usecs,
+                stats.shared - last.shared,
+                stats.collisions - last.collisions,
+                stats.stale - last.stale, stats.shared);
+
+        sleep(1);
+    }
+}
+
+void scanner_daemon_launch(void)
+{
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, scanner_daemon, NULL);
+}
+
+void scanner_daemon_initialize(struct fgprtshr_hash *h, int budget)
+{
+    if(budget <= 0)
+        return;
+
+    if((xc_handle = xc_interface_open()) < 0)
+    {
+        DPRINTF("Failed to open XC interface.\n");
+        return;
+    }
+
+    fgprts = h;
+    scan_budget = (budget > 100) ? 100 : budget;
+    scanner_daemon_launch();
+}
@@ -118,6 +118,7 @@ void parse_global(char *s)
     unsigned long long pcd_tot_csize = parse(s,"Gz");
     unsigned long long deduped_puts = parse(s,"Gd");
     unsigned long long tot_good_eph_puts = parse(s,"Ep");
+    unsigned long long samefill_puts = parse(s,"Sf");
 
     printf("total tmem ops=%llu (errors=%llu) -- tmem pages avail=%llu\n",
            total_ops, errored_ops, avail_pages);
@@ -142,6 +143,8 @@ void parse_global(char *s)
                printf("compression savings=%4.2f%% ",
                    (1.0-(pcd_tot_csize*1.0)/(pcd_count*PAGE_SIZE))*100);
     }
+    if (samefill_puts)
+           printf("samefilled puts=%llu ", samefill_puts);
     printf("\n");
     printf("misc: failed_copies=%llu alloc_failed=%llu alloc_page_failed=%llu "
            "low_mem=%llu evicted=%llu/%llu relinq=%llu/%llu, "
@@ -175,6 +178,10 @@ void parse_time_stats(char *s)
     PARSE_CYC_COUNTER(s,pg_copy,"C");
     PARSE_CYC_COUNTER(s,compress,"c");
     PARSE_CYC_COUNTER(s,decompress,"d");
+    PARSE_CYC_COUNTER(s,evict,"E");
+    PARSE_CYC_COUNTER(s,core_put,"u");
+    PARSE_CYC_COUNTER(s,core_get,"r");
+    PARSE_CYC_COUNTER(s,core_flush,"f");
 
     PRINTF_CYC_COUNTER(succ_get,"succ get cycles:");
     PRINTF_CYC_COUNTER(succ_put,"succ put cycles:");
@@ -185,6 +192,10 @@ void parse_time_stats(char *s)
     PRINTF_CYC_COUNTER(pg_copy,"page copy cycles:");
     PRINTF_CYC_COUNTER(compress,"compression cycles:");
     PRINTF_CYC_COUNTER(decompress,"decompression cycles:");
+    PRINTF_CYC_COUNTER(evict,"eviction cycles:");
+    PRINTF_CYC_COUNTER(core_put,"put (core) cycles:");
+    PRINTF_CYC_COUNTER(core_get,"get (core) cycles:");
+    PRINTF_CYC_COUNTER(core_flush,"flush (core) cycles:");
 }
 
 void parse_client(char *s)
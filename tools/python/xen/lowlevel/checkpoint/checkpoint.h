@@ -6,6 +6,7 @@
 #include <pthread.h>
 #include <semaphore.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include <xenguest.h>
 #include <xs.h>
@@ -38,6 +39,10 @@ typedef struct {
     sem_t suspended_sem;
     sem_t resumed_sem;
     timer_t timer;
+
+    /* per-epoch suspend window accounting */
+    unsigned int epoch;
+    struct timeval suspended_at;
 } checkpoint_state;
 
 char* checkpoint_error(checkpoint_state* s);
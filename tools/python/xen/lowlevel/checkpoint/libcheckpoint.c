@@ -64,6 +64,9 @@ void checkpoint_init(checkpoint_state* s)
     s->done = 0;
     s->suspend_thr = 0;
     s->timer = 0;
+
+    s->epoch = 0;
+    timerclear(&s->suspended_at);
 }
 
 /* open a checkpoint session to guest domid */
@@ -207,6 +210,7 @@ int checkpoint_suspend(checkpoint_state* s)
   gettimeofday(&tv, NULL);
   fprintf(stderr, "PROF: suspending at %lu.%06lu\n", (unsigned long)tv.tv_sec,
          (unsigned long)tv.tv_usec);
+  s->suspended_at = tv;
 
   if (s->suspend_evtchn >= 0)
       rc = evtchn_suspend(s);
@@ -263,6 +267,12 @@ int checkpoint_resume(checkpoint_state* s)
   gettimeofday(&tv, NULL);
   fprintf(stderr, "PROF: resumed at %lu.%06lu\n", (unsigned long)tv.tv_sec,
          (unsigned long)tv.tv_usec);
+  if (timerisset(&s->suspended_at)) {
+    timersub(&tv, &s->suspended_at, &tv);
+    fprintf(stderr, "PROF: epoch %u suspended for %lu.%06lu\n", s->epoch++,
+            (unsigned long)tv.tv_sec, (unsigned long)tv.tv_usec);
+    timerclear(&s->suspended_at);
+  }
 
   if (s->domtype > dt_pv && resume_qemu(s) < 0)
       return -1;
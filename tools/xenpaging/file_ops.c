@@ -28,20 +28,21 @@
 #define page_offset(_pfn)     (((off_t)(_pfn)) << PAGE_SHIFT)
 
 
-static int file_op(int fd, void *page, int i,
+static int file_op(int fd, void *page, int i, int nr,
                    ssize_t (*fn)(int, const void *, size_t))
 {
     off_t seek_ret;
-    int total;
-    int bytes;
+    size_t len = (size_t)nr << PAGE_SHIFT;
+    size_t total;
+    ssize_t bytes;
     int ret;
 
-    seek_ret = lseek(fd, i << PAGE_SHIFT, SEEK_SET);
+    seek_ret = lseek(fd, page_offset(i), SEEK_SET);
 
     total = 0;
-    while ( total < PAGE_SIZE )
+    while ( total < len )
     {
-        bytes = fn(fd, page + total, PAGE_SIZE - total);
+        bytes = fn(fd, page + total, len - total);
         if ( bytes <= 0 )
         {
             ret = -errno;
@@ -64,12 +65,17 @@ static ssize_t my_read(int fd, const void *buf, size_t count)
 
 int read_page(int fd, void *page, int i)
 {
-    return file_op(fd, page, i, &my_read);
+    return file_op(fd, page, i, 1, &my_read);
 }
 
 int write_page(int fd, void *page, int i)
 {
-    return file_op(fd, page, i, &write);
+    return file_op(fd, page, i, 1, &write);
+}
+
+int write_pages(int fd, void *pages, int i, int nr)
+{
+    return file_op(fd, pages, i, nr, &write);
 }
 
 
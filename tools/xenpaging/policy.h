@@ -28,11 +28,22 @@
 #include "xenpaging.h"
 
 
-int policy_init(xenpaging_t *paging);
-int policy_choose_victim(xenpaging_t *paging, domid_t domain_id,
+struct xenpaging_policy {
+    const char *name;
+    int (*init)(xenpaging_t *paging);
+    void (*teardown)(xenpaging_t *paging);
+    int (*choose_victim)(xenpaging_t *paging, domid_t domain_id,
                          xenpaging_victim_t *victim);
-void policy_notify_paged_out(domid_t domain_id, unsigned long gfn);
-void policy_notify_paged_in(domid_t domain_id, unsigned long gfn);
+    void (*notify_paged_out)(domid_t domain_id, unsigned long gfn);
+    void (*notify_paged_in)(domid_t domain_id, unsigned long gfn);
+};
+
+/* Random eviction, protecting a ring of recently paged in pages */
+extern struct xenpaging_policy policy_default;
+/* Second-chance clock fed by page-ins and refault distance */
+extern struct xenpaging_policy policy_clock;
+/* Let the clock policy also sample guest writes through log-dirty mode */
+extern int policy_clock_sample_writes;
 
 #endif // __XEN_PAGING_POLICY_H__
 
@@ -0,0 +1,284 @@
+/******************************************************************************
+ * tools/xenpaging/policy_clock.c
+ *
+ * Xen domain paging second-chance (clock) policy.
+ *
+ * Pages are swept in gfn order by a clock hand.  A page that has been
+ * referenced since the hand last passed it gets a second chance; pages
+ * that refault shortly after being evicted are part of the guest's working
+ * set and get an additional one.  References are learnt from page-ins and,
+ * if policy_clock_sample_writes is set, by periodically sampling (and
+ * clearing) the domain's log-dirty bitmap.
+ *
+ * Write sampling keeps the domain in log-dirty mode while the pager runs,
+ * which costs a fault on the first write to every page after each sample.
+ * It also owns the domain's log-dirty bitmap: a save or migration started
+ * meanwhile takes log-dirty mode over, and from then on both sides clear
+ * each other's dirty bits.  Only use it on domains that are not going to
+ * be saved or migrated while being paged.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <inttypes.h>
+#include <sys/time.h>
+
+#include "bitops.h"
+#include "xc.h"
+#include "policy.h"
+
+
+/* Resample the log-dirty bitmap at least this often during a sweep */
+#define SAMPLE_INTERVAL_MS   1000
+
+/* Report statistics every this many evictions */
+#define STATS_INTERVAL       4096
+
+
+int policy_clock_sample_writes;
+
+static int xch;
+static domid_t domid;
+static unsigned long max_pages;
+
+/* Pages not to page out: page 0 and everything already paged out */
+static unsigned long *bitmap;
+/* Pages seen in use since the hand last passed them */
+static unsigned long *referenced;
+/* Refaulted working set pages, granted one extra revolution */
+static unsigned long *active;
+/* Scratch bitmap for log-dirty sampling */
+static unsigned long *dirty;
+
+static unsigned long hand;
+static int log_dirty;
+static struct timeval last_sample;
+
+/* Eviction clock value at which each gfn was last paged out */
+static uint32_t *evicted_at;
+static uint32_t evict_clock;
+static unsigned long nr_paged_out;
+
+static unsigned long nr_refaults;
+static unsigned long nr_wss_refaults;
+static unsigned long nr_samples;
+
+
+static void clock_sample(void)
+{
+    unsigned long i;
+    int rc;
+
+    gettimeofday(&last_sample, NULL);
+
+    if ( !log_dirty )
+        return;
+
+    rc = xc_shadow_control(xch, domid, XEN_DOMCTL_SHADOW_OP_CLEAN,
+                           dirty, max_pages, NULL, 0, NULL);
+    if ( rc < 0 )
+    {
+        ERROR("Error sampling dirty bitmap, disabling sampling");
+        log_dirty = 0;
+        return;
+    }
+
+    for ( i = 0; i < max_pages / BITS_PER_LONG + 1; i++ )
+        referenced[i] |= dirty[i];
+
+    nr_samples++;
+}
+
+static int sample_due(void)
+{
+    struct timeval now;
+    long ms;
+
+    gettimeofday(&now, NULL);
+    ms = (now.tv_sec - last_sample.tv_sec) * 1000 +
+         (now.tv_usec - last_sample.tv_usec) / 1000;
+
+    return ms >= SAMPLE_INTERVAL_MS;
+}
+
+static void clock_stats(void)
+{
+    DPRINTF("clock policy: %lu paged out, %lu refaults (%lu in working set),"
+            " %lu dirty samples\n", nr_paged_out, nr_refaults,
+            nr_wss_refaults, nr_samples);
+}
+
+static int clock_init(xenpaging_t *paging)
+{
+    int rc;
+
+    xch = paging->xc_handle;
+    domid = paging->mem_event.domain_id;
+    max_pages = paging->domain_info->max_pages;
+
+    rc = alloc_bitmap(&bitmap, paging->bitmap_size);
+    if ( rc == 0 )
+        rc = alloc_bitmap(&referenced, paging->bitmap_size);
+    if ( rc == 0 )
+        rc = alloc_bitmap(&active, paging->bitmap_size);
+    if ( rc == 0 )
+        rc = alloc_bitmap(&dirty, paging->bitmap_size);
+    if ( rc != 0 )
+        goto out;
+
+    evicted_at = calloc(max_pages, sizeof(*evicted_at));
+    if ( evicted_at == NULL )
+    {
+        rc = -ENOMEM;
+        goto out;
+    }
+
+    /* Don't page out page 0 */
+    set_bit(0, bitmap);
+
+    /*
+     * Track guest writes through log-dirty mode if asked to.  If the domain
+     * already is in log-dirty mode, someone else (e.g. a migration) owns
+     * the bitmap: leave it alone and only count page-ins as references.
+     */
+    if ( policy_clock_sample_writes )
+    {
+        if ( xc_shadow_control(xch, domid,
+                               XEN_DOMCTL_SHADOW_OP_ENABLE_LOGDIRTY,
+                               NULL, 0, NULL, 0, NULL) == 0 )
+            log_dirty = 1;
+        else
+            ERROR("clock policy: log-dirty unavailable (in use by a save "
+                  "or migration?), not sampling writes");
+    }
+
+    clock_sample();
+
+    rc = 0;
+
+ out:
+    return rc;
+}
+
+static void clock_teardown(xenpaging_t *paging)
+{
+    clock_stats();
+
+    /* Only turn off log-dirty mode if this policy turned it on */
+    if ( log_dirty )
+        xc_shadow_control(xch, domid, XEN_DOMCTL_SHADOW_OP_OFF,
+                          NULL, 0, NULL, 0, NULL);
+    log_dirty = 0;
+}
+
+static int clock_choose_victim(xenpaging_t *paging, domid_t domain_id,
+                               xenpaging_victim_t *victim)
+{
+    unsigned long scanned;
+    unsigned long gfn;
+
+    ASSERT(victim != NULL);
+
+    /* Domain to pick on */
+    victim->domain_id = domain_id;
+
+    if ( sample_due() )
+        clock_sample();
+
+    /*
+     * Each pass of the hand strips one chance from every page, so three
+     * revolutions are enough to find a victim if there is one.
+     */
+    for ( scanned = 0; scanned < 3 * max_pages; scanned++ )
+    {
+        gfn = hand;
+        if ( ++hand >= max_pages )
+        {
+            hand = 0;
+            clock_sample();
+        }
+
+        if ( test_bit(gfn, bitmap) )
+            continue;
+        if ( test_and_clear_bit(gfn, referenced) )
+            continue;
+        if ( test_and_clear_bit(gfn, active) )
+            continue;
+
+        victim->gfn = gfn;
+        return 0;
+    }
+
+    return -ENOSPC;
+}
+
+static void clock_notify_paged_out(domid_t domain_id, unsigned long gfn)
+{
+    set_bit(gfn, bitmap);
+    clear_bit(gfn, referenced);
+    clear_bit(gfn, active);
+
+    evicted_at[gfn] = evict_clock++;
+    nr_paged_out++;
+
+    if ( evict_clock % STATS_INTERVAL == 0 )
+        clock_stats();
+}
+
+static void clock_notify_paged_in(domid_t domain_id, unsigned long gfn)
+{
+    uint32_t distance;
+
+    if ( !test_and_clear_bit(gfn, bitmap) )
+        return;
+
+    nr_paged_out--;
+    nr_refaults++;
+
+    set_bit(gfn, referenced);
+
+    /*
+     * A page that refaults before the paged out pool has turned over once
+     * is in active use: evicting it again soon would only cost another
+     * fault, so protect it for an extra revolution.
+     */
+    distance = evict_clock - evicted_at[gfn];
+    if ( distance <= nr_paged_out )
+    {
+        set_bit(gfn, active);
+        nr_wss_refaults++;
+    }
+}
+
+struct xenpaging_policy policy_clock = {
+    .name             = "clock",
+    .init             = clock_init,
+    .teardown         = clock_teardown,
+    .choose_victim    = clock_choose_victim,
+    .notify_paged_out = clock_notify_paged_out,
+    .notify_paged_in  = clock_notify_paged_in,
+};
+
+
+/*
+ * Local variables:
+ * mode: C
+ * c-set-style: "BSD"
+ * c-basic-offset: 4
+ * tab-width: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -34,7 +34,7 @@ static unsigned int i_mru = 0;
 static unsigned long *bitmap;
 
 
-int policy_init(xenpaging_t *paging)
+static int default_init(xenpaging_t *paging)
 {
     int i;
     int rc;
@@ -57,8 +57,8 @@ int policy_init(xenpaging_t *paging)
     return rc;
 }
 
-int policy_choose_victim(xenpaging_t *paging, domid_t domain_id,
-                         xenpaging_victim_t *victim)
+static int default_choose_victim(xenpaging_t *paging, domid_t domain_id,
+                                 xenpaging_victim_t *victim)
 {
     ASSERT(victim != NULL);
 
@@ -75,12 +75,12 @@ int policy_choose_victim(xenpaging_t *paging, domid_t domain_id,
     return 0;
 }
 
-void policy_notify_paged_out(domid_t domain_id, unsigned long gfn)
+static void default_notify_paged_out(domid_t domain_id, unsigned long gfn)
 {
     set_bit(gfn, bitmap);
 }
 
-void policy_notify_paged_in(domid_t domain_id, unsigned long gfn)
+static void default_notify_paged_in(domid_t domain_id, unsigned long gfn)
 {
     unsigned long old_gfn = mru[i_mru & (MRU_SIZE - 1)];
 
@@ -91,6 +91,14 @@ void policy_notify_paged_in(domid_t domain_id, unsigned long gfn)
     i_mru++;
 }
 
+struct xenpaging_policy policy_default = {
+    .name             = "default",
+    .init             = default_init,
+    .choose_victim    = default_choose_victim,
+    .notify_paged_out = default_notify_paged_out,
+    .notify_paged_in  = default_notify_paged_in,
+};
+
 
 /*
  * Local variables:
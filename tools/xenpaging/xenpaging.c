@@ -31,11 +31,23 @@
 #include "spinlock.h"
 #include "file_ops.h"
 #include "xc.h"
+#include "zcache.h"
 
 #include "policy.h"
 #include "xenpaging.h"
 
 
+/* Victims nominated and evicted per hypercall */
+#define EVICT_BATCH          64
+
+/* Give up refilling after this many batches in a row evict nothing */
+#define EVICT_MAX_STALLS     64
+
+/* Pages read ahead along a detected fault stride */
+#define PREFETCH_WINDOW      4
+#define PREFETCH_STRIDE_MAX  16
+
+
 #if 0
 #undef DPRINTF
 #define DPRINTF(...) ((void)0)
@@ -67,7 +79,8 @@ static void *init_page(void)
     return NULL;
 }
 
-xenpaging_t *xenpaging_init(domid_t domain_id)
+xenpaging_t *xenpaging_init(domid_t domain_id,
+                           struct xenpaging_policy *policy)
 {
     xenpaging_t *paging;
     int rc;
@@ -89,6 +102,8 @@ xenpaging_t *xenpaging_init(domid_t domain_id)
     /* Set domain id */
     paging->mem_event.domain_id = domain_id;
 
+    paging->policy = policy;
+
     /* Initialise shared page */
     paging->mem_event.shared_page = init_page();
     if ( paging->mem_event.shared_page == NULL )
@@ -189,7 +204,7 @@ xenpaging_t *xenpaging_init(domid_t domain_id)
     DPRINTF("max_pages = %"PRIx64"\n", paging->domain_info->max_pages);
 
     /* Initialise policy */
-    rc = policy_init(paging);
+    rc = paging->policy->init(paging);
     if ( rc != 0 )
     {
         ERROR("Error initialising policy");
@@ -216,6 +231,9 @@ int xenpaging_teardown(xenpaging_t *paging)
     if ( paging == NULL )
         return 0;
 
+    if ( paging->policy->teardown )
+        paging->policy->teardown(paging);
+
     /* Tear down domain paging in Xen */
     rc = xc_mem_event_disable(paging->xc_handle, paging->mem_event.domain_id);
     if ( rc != 0 )
@@ -303,74 +321,32 @@ static int put_response(mem_event_t *mem_event, mem_event_response_t *rsp)
     return 0;
 }
 
-int xenpaging_evict_page(xenpaging_t *paging, xenpaging_victim_t *victim, int fd, int i)
+int xenpaging_resume_page(xenpaging_t *paging, mem_event_response_t *rsp)
 {
-    void *page;
-    unsigned long gfn;
     int ret;
 
-    DECLARE_DOMCTL;
-
-    /* Map page */
-    gfn = victim->gfn;
-    ret = -EFAULT;
-    page = xc_map_foreign_pages(paging->xc_handle, victim->domain_id,
-                                PROT_READ | PROT_WRITE, &gfn, 1);
-    if ( page == NULL )
-    {
-        ERROR("Error mapping page");
-        goto out;
-    }
-
-    /* Copy page */
-    ret = write_page(fd, page, i);
-    if ( ret != 0 )
-    {
-        munmap(page, PAGE_SIZE);
-        ERROR("Error copying page");
-        goto out;
-    }
-
-    /* Clear page */
-    memset(page, 0, PAGE_SIZE);
-
-    munmap(page, PAGE_SIZE);
-
-    /* Tell Xen to evict page */
-    ret = xc_mem_paging_evict(paging->xc_handle, paging->mem_event.domain_id,
-                              victim->gfn);
+    /* Put the page info on the ring */
+    ret = put_response(&paging->mem_event, rsp);
     if ( ret != 0 )
-    {
-        ERROR("Error evicting page");
         goto out;
-    }
 
     /* Notify policy of page being paged in */
-    policy_notify_paged_in(paging->mem_event.domain_id, victim->gfn);
+    paging->policy->notify_paged_in(paging->mem_event.domain_id, rsp->gfn);
 
  out:
     return ret;
 }
 
-int xenpaging_resume_page(xenpaging_t *paging, mem_event_response_t *rsp)
+static int xenpaging_resume(xenpaging_t *paging)
 {
     int ret;
 
-    /* Put the page info on the ring */
-    ret = put_response(&paging->mem_event, rsp);
-    if ( ret != 0 )
-        goto out;
-
-    /* Notify policy of page being paged in */
-    policy_notify_paged_in(paging->mem_event.domain_id, rsp->gfn);
-
-    /* Tell Xen page is ready */
+    /* Tell Xen the pages are ready; it consumes all queued responses */
     ret = xc_mem_paging_resume(paging->xc_handle, paging->mem_event.domain_id,
-                               rsp->gfn);
+                               0);
     ret = xc_evtchn_notify(paging->mem_event.xce_handle,
                            paging->mem_event.port);
 
- out:
     return ret;
 }
 
@@ -402,8 +378,8 @@ static int xenpaging_populate_page(
         goto out_map;
     }
 
-    /* Read page */
-    ret = read_page(fd, page, i);
+    /* Read page, from the compressed cache if it is still there */
+    ret = zcache_get(i, page) ? read_page(fd, page, i) : 0;
     if ( ret != 0 )
     {
         ERROR("Error reading page");
@@ -416,70 +392,332 @@ static int xenpaging_populate_page(
     return ret;
 }
 
-static int evict_victim(xenpaging_t *paging, domid_t domain_id,
-                        xenpaging_victim_t *victim, int fd, int i)
+/*
+ * Fill the paging file slots listed in slots[] with newly evicted pages.
+ * Victims are nominated, written out and evicted EVICT_BATCH at a time;
+ * pages that fail any step are skipped and their slots used for others.
+ * slots[] is reordered.  If no victim can be evicted for EVICT_MAX_STALLS
+ * batches running, the remaining slots are left empty and -ENOSPC returned.
+ */
+static int evict_victims(xenpaging_t *paging, domid_t domain_id,
+                         xenpaging_victim_t *victims, int *slots, int nr,
+                         int fd)
 {
-    int j = 0;
+    xenpaging_victim_t victim;
+    uint64_t gfns[EVICT_BATCH];
+    xen_pfn_t pfns[EVICT_BATCH];
+    int errs[EVICT_BATCH];
+    int pos[EVICT_BATCH];
+    int filled[EVICT_BATCH];
+    void *pages;
+    int done = 0;
+    int tries = 0;
+    int stalled = 0;
+    int n, m, v, w, f;
+    int j, k, e;
     int ret;
 
-    do
+    while ( done < nr )
     {
-        ret = policy_choose_victim(paging, domain_id, victim);
+        n = nr - done;
+        if ( n > EVICT_BATCH )
+            n = EVICT_BATCH;
+
+        for ( k = 0; k < n; k++ )
+        {
+            ret = paging->policy->choose_victim(paging, domain_id, &victim);
+            if ( ret != 0 )
+            {
+                ERROR("Error choosing victim");
+                goto out;
+            }
+            gfns[k] = victim.gfn;
+        }
+
+        ret = xc_mem_paging_nominate_batch(paging->xc_handle,
+                                           paging->mem_event.domain_id,
+                                           gfns, errs, n);
         if ( ret != 0 )
         {
-            ERROR("Error choosing victim");
+            ERROR("Error nominating pages");
             goto out;
         }
 
-        ret = xc_mem_paging_nominate(paging->xc_handle,
-                                     paging->mem_event.domain_id, victim->gfn);
-        if ( ret == 0 )
-            ret = xenpaging_evict_page(paging, victim, fd, i);
-        else
+        for ( k = m = 0; k < n; k++ )
         {
-            if ( j++ % 1000 == 0 )
+            if ( errs[k] == 0 )
+                pfns[m++] = gfns[k];
+            else if ( tries++ % 1000 == 0 )
                 if ( xc_mem_paging_flush_ioemu_cache(domain_id) )
                     ERROR("Error flushing ioemu cache");
         }
-    }
-    while ( ret );
+        if ( m == 0 )
+        {
+            f = 0;
+            goto next;
+        }
+
+        /* Map all nominated pages at once */
+        pages = xc_map_foreign_bulk(paging->xc_handle, domain_id,
+                                    PROT_READ | PROT_WRITE, pfns, errs, m);
+        if ( pages == NULL )
+        {
+            ERROR("Error mapping pages");
+            ret = -EFAULT;
+            goto out;
+        }
+
+        /*
+         * Write out runs of pages which are adjacent in the mapping and go
+         * to consecutive slots with a single write each.
+         */
+        for ( k = v = w = 0; k < m; k = e )
+        {
+            if ( errs[k] != 0 )
+            {
+                e = k + 1;
+                continue;
+            }
+
+            for ( e = k + 1; e < m && errs[e] == 0; e++ )
+                if ( slots[done + w + (e - k)] != slots[done + w] + (e - k) )
+                    break;
+
+            ret = write_pages(fd, pages + k * PAGE_SIZE, slots[done + w],
+                              e - k);
+            if ( ret != 0 )
+            {
+                ERROR("Error copying pages");
+                continue;
+            }
+
+            /* Keep compressed copies to serve refaults from */
+            for ( j = k; j < e; j++ )
+                zcache_put(slots[done + w + (j - k)], pages + j * PAGE_SIZE);
+
+            /* Clear pages */
+            memset(pages + k * PAGE_SIZE, 0, (e - k) * PAGE_SIZE);
+
+            for ( j = k; j < e; j++ )
+            {
+                gfns[v] = pfns[j];
+                pos[v++] = w++;
+            }
+        }
 
-    if ( test_and_set_bit(victim->gfn, paging->bitmap) )
-        ERROR("Page has been evicted before");
+        munmap(pages, m * PAGE_SIZE);
+
+        /* Tell Xen to evict the pages */
+        ret = v ? xc_mem_paging_evict_batch(paging->xc_handle,
+                                            paging->mem_event.domain_id,
+                                            gfns, errs, v) : 0;
+        if ( ret != 0 )
+        {
+            ERROR("Error evicting pages");
+            goto out;
+        }
+
+        memset(filled, 0, sizeof(filled));
+        for ( k = 0; k < v; k++ )
+        {
+            if ( errs[k] != 0 )
+                continue;
+
+            victims[slots[done + pos[k]]].domain_id = domain_id;
+            victims[slots[done + pos[k]]].gfn = gfns[k];
+            filled[pos[k]] = 1;
+
+            /* Notify policy of page being paged out */
+            paging->policy->notify_paged_out(paging->mem_event.domain_id,
+                                             gfns[k]);
+
+            if ( test_and_set_bit(gfns[k], paging->bitmap) )
+                ERROR("Page has been evicted before");
+        }
+
+        /* Move the filled slots to the front, retry the rest */
+        for ( k = f = 0; k < n; k++ )
+        {
+            if ( !filled[k] )
+                continue;
+            e = slots[done + f];
+            slots[done + f] = slots[done + k];
+            slots[done + k] = e;
+            f++;
+        }
+        done += f;
+
+ next:
+        if ( f != 0 )
+            stalled = 0;
+        else if ( ++stalled >= EVICT_MAX_STALLS )
+        {
+            ERROR("No pageable victims found, leaving %d slots empty",
+                  nr - done);
+            ret = -ENOSPC;
+            goto out;
+        }
+    }
 
     ret = 0;
 
  out:
+    /* Forget the old occupants of slots left empty */
+    for ( k = done; k < nr; k++ )
+        memset(&victims[slots[k]], 0, sizeof(victims[slots[k]]));
+
     return ret;
 }
 
+static int find_victim(xenpaging_victim_t *victims, int num_pages,
+                       domid_t domain_id, unsigned long gfn)
+{
+    int i;
+
+    /* Find where in the paging file the page lives */
+    for ( i = 0; i < num_pages; i++ )
+        if ( (victims[i].domain_id == domain_id) && (victims[i].gfn == gfn) )
+            return i;
+
+    return -1;
+}
+
+/*
+ * When faults follow a fixed stride, page in the next few pages along it
+ * before the guest gets to them.  Their slots are added to refill[].
+ */
+static void prefetch_pages(xenpaging_t *paging, xenpaging_victim_t *victims,
+                           int num_pages, unsigned long gfn, int fd,
+                           int *refill, int *nr_refill)
+{
+    static unsigned long last_gfn;
+    static long last_stride;
+    uint64_t next;
+    long stride;
+    int i, j;
+
+    stride = gfn - last_gfn;
+    last_gfn = gfn;
+    if ( stride != last_stride )
+    {
+        last_stride = stride;
+        return;
+    }
+    if ( (stride == 0) || (labs(stride) > PREFETCH_STRIDE_MAX) )
+        return;
+
+    for ( j = 1; j <= PREFETCH_WINDOW; j++ )
+    {
+        next = gfn + j * stride;
+        if ( (next >= paging->domain_info->max_pages) ||
+             !test_bit(next, paging->bitmap) )
+            break;
+
+        i = find_victim(victims, num_pages, paging->mem_event.domain_id,
+                        next);
+        if ( i < 0 )
+            break;
+
+        if ( xenpaging_populate_page(paging, &next, fd, i) != 0 )
+            break;
+
+        /* If the guest faulted on it meanwhile, its request completes it */
+        if ( xc_mem_paging_restore(paging->xc_handle,
+                                   paging->mem_event.domain_id, next) != 0 )
+            break;
+
+        clear_bit(next, paging->bitmap);
+        paging->policy->notify_paged_in(paging->mem_event.domain_id, next);
+        refill[(*nr_refill)++] = i;
+
+        /* The guest won't fault on this one, carry on from here */
+        last_gfn = next;
+    }
+}
+
+static struct xenpaging_policy *policies[] = {
+    &policy_default,
+    &policy_clock,
+};
+
+static struct xenpaging_policy *policy_lookup(const char *name)
+{
+    int i;
+
+    if ( name == NULL )
+        return &policy_default;
+
+    for ( i = 0; i < sizeof(policies) / sizeof(policies[0]); i++ )
+        if ( !strcmp(policies[i]->name, name) )
+            return policies[i];
+
+    return NULL;
+}
+
 int main(int argc, char *argv[])
 {
     domid_t domain_id;
     int num_pages;
     xenpaging_t *paging;
+    struct xenpaging_policy *policy;
     xenpaging_victim_t *victims;
+    int *refill;
+    int nr_refill;
+    int nr_resume;
     mem_event_request_t req;
     mem_event_response_t rsp;
     int i;
     int rc = -1;
     int rc1;
 
+    char *policy_name = NULL;
+    unsigned long cache_mb = 0;
+    int opt;
+
     int open_flags = O_CREAT | O_TRUNC | O_RDWR;
     mode_t open_mode = S_IRUSR | S_IRGRP | S_IROTH | S_IWUSR | S_IWGRP | S_IWOTH;
     char filename[80];
     int fd;
 
-    if ( argc != 3 )
+    while ( (opt = getopt(argc, argv, "p:c:w")) != -1 )
+    {
+        switch ( opt )
+        {
+        case 'p':
+            policy_name = optarg;
+            break;
+        case 'c':
+            cache_mb = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            policy_clock_sample_writes = 1;
+            break;
+        default:
+            goto usage;
+        }
+    }
+
+    if ( argc - optind != 2 )
+        goto usage;
+
+    domain_id = atoi(argv[optind]);
+    num_pages = atoi(argv[optind + 1]);
+
+    policy = policy_lookup(policy_name);
+    if ( policy == NULL )
     {
-        fprintf(stderr, "Usage: %s <domain_id> <num_pages>\n", argv[0]);
+        fprintf(stderr, "Unknown paging policy '%s'\n", policy_name);
         return -1;
     }
 
-    domain_id = atoi(argv[1]);
-    num_pages = atoi(argv[2]);
+    if ( cache_mb && (zcache_init(num_pages, cache_mb << 20) != 0) )
+    {
+        fprintf(stderr, "Failed to set up page cache\n");
+        return -1;
+    }
 
     victims = calloc(num_pages, sizeof(xenpaging_victim_t));
+    refill = calloc(num_pages, sizeof(int));
 
     /* Open file */
     sprintf(filename, "page_cache_%d", domain_id);
@@ -494,7 +732,7 @@ int main(int argc, char *argv[])
     srand(time(NULL));
 
     /* Initialise domain paging */
-    paging = xenpaging_init(domain_id);
+    paging = xenpaging_init(domain_id, policy);
     if ( paging == NULL )
     {
         ERROR("Error initialising paging");
@@ -504,10 +742,15 @@ int main(int argc, char *argv[])
     /* Evict pages */
     memset(victims, 0, sizeof(xenpaging_victim_t) * num_pages);
     for ( i = 0; i < num_pages; i++ )
+        refill[i] = i;
+    for ( i = 0; i < num_pages; i += EVICT_BATCH * 16 )
     {
-        evict_victim(paging, domain_id, &victims[i], fd, i);
-        if ( i % 100 == 0 )
-            DPRINTF("%d pages evicted\n", i);
+        rc = evict_victims(paging, domain_id, victims, refill + i,
+                           (num_pages - i < EVICT_BATCH * 16) ?
+                           num_pages - i : EVICT_BATCH * 16, fd);
+        if ( rc != 0 )
+            goto out;
+        DPRINTF("%d pages evicted\n", i);
     }
 
     DPRINTF("pages evicted\n");
@@ -527,6 +770,9 @@ int main(int argc, char *argv[])
             DPRINTF("Got event from Xen\n");
         }
 
+        nr_refill = 0;
+        nr_resume = 0;
+
         while ( RING_HAS_UNCONSUMED_REQUESTS(&paging->mem_event.back_ring) )
         {
             rc = get_request(&paging->mem_event, &req);
@@ -540,14 +786,9 @@ int main(int argc, char *argv[])
             if ( test_and_clear_bit(req.gfn, paging->bitmap) )
             {
                 /* Find where in the paging file to read from */
-                for ( i = 0; i < num_pages; i++ )
-                {
-                    if ( (victims[i].domain_id == paging->mem_event.domain_id) &&
-                         (victims[i].gfn == req.gfn) )
-                        break;
-                }
-    
-                if ( i >= num_pages )
+                i = find_victim(victims, num_pages,
+                                paging->mem_event.domain_id, req.gfn);
+                if ( i < 0 )
                 {
                     DPRINTF("Couldn't find page %"PRIx64"\n", req.gfn);
                     goto out;
@@ -573,9 +814,13 @@ int main(int argc, char *argv[])
                     ERROR("Error resuming page");
                     goto out;
                 }
+                nr_resume++;
 
                 /* Evict a new page to replace the one we just paged in */
-                evict_victim(paging, domain_id, &victims[i], fd, i);
+                refill[nr_refill++] = i;
+
+                prefetch_pages(paging, victims, num_pages, req.gfn, fd,
+                               refill, &nr_refill);
             }
             else
             {
@@ -600,13 +845,37 @@ int main(int argc, char *argv[])
                         ERROR("Error resuming");
                         goto out;
                     }
+                    nr_resume++;
                 }
             }
         }
+
+        /* Let the guest run before replacing the paged in pages */
+        if ( nr_resume )
+        {
+            rc = xenpaging_resume(paging);
+            if ( rc != 0 )
+            {
+                ERROR("Error resuming");
+                goto out;
+            }
+        }
+
+        if ( nr_refill )
+        {
+            /* Running short of victims is not fatal here */
+            rc = evict_victims(paging, domain_id, victims, refill, nr_refill,
+                               fd);
+            if ( (rc != 0) && (rc != -ENOSPC) )
+                goto out;
+        }
     }
 
  out:
     free(victims);
+    free(refill);
+
+    zcache_stats();
 
     /* Tear down domain paging */
     rc1 = xenpaging_teardown(paging);
@@ -617,6 +886,18 @@ int main(int argc, char *argv[])
         rc = rc1;
 
     return rc;
+
+ usage:
+    fprintf(stderr, "Usage: %s [-p policy] [-c cache_mb] [-w] <domain_id> "
+            "<num_pages>\n"
+            "  -p policy    victim selection: default (random) or clock\n"
+            "  -c cache_mb  keep evicted pages compressed in this much "
+            "memory\n"
+            "  -w           clock policy: also sample guest writes through "
+            "log-dirty\n"
+            "               mode; the domain must not be saved or migrated "
+            "meanwhile\n", argv[0]);
+    return -1;
 }
 
 
@@ -35,9 +35,13 @@
 #include "mem_event.h"
 
 
+struct xenpaging_policy;
+
 typedef struct xenpaging {
     int xc_handle;
 
+    struct xenpaging_policy *policy;
+
     xc_platform_info_t *platform_info;
     xc_domaininfo_t    *domain_info;
 
@@ -0,0 +1,243 @@
+/******************************************************************************
+ * tools/xenpaging/zcache.c
+ *
+ * Compressed in-memory cache of paged out pages.
+ *
+ * Recently evicted pages are kept deflated in dom0 memory so that a
+ * refault can be served without reading the paging file.  Pages filled
+ * with zeroes take no space.  Once the memory budget is used up the least
+ * recently stored entries are dropped.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include <zlib.h>
+#include <xc_private.h>
+
+#include "zcache.h"
+
+
+/* Pages which don't shrink below this are not worth caching */
+#define ZCACHE_MAX_LEN       (PAGE_SIZE * 3 / 4)
+
+/* Report statistics every this many lookups */
+#define STATS_INTERVAL       4096
+
+
+struct zentry {
+    void *data;
+    uint32_t len;
+    int cached;
+    int prev, next;          /* LRU list, by slot */
+};
+
+static struct zentry *entries;
+static int nr_entries;
+static int lru_head = -1;    /* most recently stored */
+static int lru_tail = -1;    /* least recently stored */
+
+static unsigned long budget;
+static unsigned long used;
+
+static unsigned long nr_hits;
+static unsigned long nr_misses;
+static unsigned long nr_stored;
+static unsigned long nr_zero;
+static unsigned long nr_rejected;
+static unsigned long nr_dropped;
+
+
+static void lru_unlink(int i)
+{
+    struct zentry *e = &entries[i];
+
+    if ( e->prev >= 0 )
+        entries[e->prev].next = e->next;
+    else
+        lru_head = e->next;
+
+    if ( e->next >= 0 )
+        entries[e->next].prev = e->prev;
+    else
+        lru_tail = e->prev;
+
+    e->prev = e->next = -1;
+}
+
+static void lru_push(int i)
+{
+    struct zentry *e = &entries[i];
+
+    e->prev = -1;
+    e->next = lru_head;
+    if ( lru_head >= 0 )
+        entries[lru_head].prev = i;
+    lru_head = i;
+    if ( lru_tail < 0 )
+        lru_tail = i;
+}
+
+static void zcache_drop(int i)
+{
+    struct zentry *e = &entries[i];
+
+    if ( !e->cached )
+        return;
+
+    lru_unlink(i);
+    used -= e->len;
+    free(e->data);
+    e->data = NULL;
+    e->len = 0;
+    e->cached = 0;
+}
+
+static int page_is_zero(const void *page)
+{
+    const unsigned long *p = page;
+    int i;
+
+    for ( i = 0; i < PAGE_SIZE / sizeof(*p); i++ )
+        if ( p[i] )
+            return 0;
+
+    return 1;
+}
+
+int zcache_init(int nr_slots, unsigned long _budget)
+{
+    int i;
+
+    entries = calloc(nr_slots, sizeof(*entries));
+    if ( entries == NULL )
+        return -ENOMEM;
+
+    for ( i = 0; i < nr_slots; i++ )
+        entries[i].prev = entries[i].next = -1;
+
+    nr_entries = nr_slots;
+    budget = _budget;
+
+    return 0;
+}
+
+void zcache_put(int i, void *page)
+{
+    unsigned char buf[ZCACHE_MAX_LEN];
+    uLongf len = sizeof(buf);
+    struct zentry *e;
+
+    if ( entries == NULL )
+        return;
+
+    e = &entries[i];
+    zcache_drop(i);
+
+    if ( page_is_zero(page) )
+    {
+        len = 0;
+        nr_zero++;
+    }
+    else if ( compress2(buf, &len, page, PAGE_SIZE, Z_BEST_SPEED) != Z_OK )
+    {
+        /* Doesn't fit in buf: not compressible enough */
+        nr_rejected++;
+        return;
+    }
+
+    /* Make room, oldest entries first */
+    while ( (used + len > budget) && (lru_tail >= 0) )
+    {
+        zcache_drop(lru_tail);
+        nr_dropped++;
+    }
+    if ( used + len > budget )
+        return;
+
+    if ( len )
+    {
+        e->data = malloc(len);
+        if ( e->data == NULL )
+            return;
+        memcpy(e->data, buf, len);
+    }
+
+    e->len = len;
+    e->cached = 1;
+    used += len;
+    lru_push(i);
+    nr_stored++;
+}
+
+int zcache_get(int i, void *page)
+{
+    struct zentry *e;
+    uLongf len = PAGE_SIZE;
+    int rc = -1;
+
+    if ( entries == NULL )
+        return -1;
+
+    e = &entries[i];
+    if ( !e->cached )
+    {
+        nr_misses++;
+        goto out;
+    }
+
+    if ( e->len == 0 )
+        memset(page, 0, PAGE_SIZE);
+    else if ( (uncompress(page, &len, e->data, e->len) != Z_OK) ||
+              (len != PAGE_SIZE) )
+    {
+        ERROR("Error decompressing cached page");
+        zcache_drop(i);
+        nr_misses++;
+        goto out;
+    }
+
+    zcache_drop(i);
+    nr_hits++;
+    rc = 0;
+
+ out:
+    if ( (nr_hits + nr_misses) % STATS_INTERVAL == 0 )
+        zcache_stats();
+
+    return rc;
+}
+
+void zcache_stats(void)
+{
+    if ( entries == NULL )
+        return;
+
+    DPRINTF("zcache: %lu hits, %lu misses; %lu stored (%lu zero),"
+            " %lu incompressible, %lu dropped; %lu/%lu bytes used\n",
+            nr_hits, nr_misses, nr_stored, nr_zero, nr_rejected,
+            nr_dropped, used, budget);
+}
+
+
+/*
+ * Local variables:
+ * mode: C
+ * c-set-style: "BSD"
+ * c-basic-offset: 4
+ * tab-width: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,50 @@
+/******************************************************************************
+ * tools/xenpaging/zcache.h
+ *
+ * Compressed in-memory cache of paged out pages.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef __ZCACHE_H__
+#define __ZCACHE_H__
+
+
+/*
+ * The cache is indexed by paging file slot and sits in front of the file:
+ * pages are still written out on eviction, so entries can be dropped at
+ * any time without writeback.
+ */
+int zcache_init(int nr_slots, unsigned long budget);
+/* Store a copy of the page in slot i, replacing any previous entry */
+void zcache_put(int i, void *page);
+/* Fill page from the entry for slot i and drop it; -1 if not cached */
+int zcache_get(int i, void *page);
+void zcache_stats(void);
+
+
+#endif
+
+
+/*
+ * Local variables:
+ * mode: C
+ * c-set-style: "BSD"
+ * c-basic-offset: 4
+ * tab-width: 4
+ * indent-tabs-mode: nil
+ * End:
+ */
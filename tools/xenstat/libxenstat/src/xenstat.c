@@ -24,6 +24,7 @@
 #include <string.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <poll.h>
 
 #include "xenstat_priv.h"
 
@@ -61,6 +62,9 @@ static void xenstat_free_vbds(xenstat_node * node);
 static void xenstat_uninit_vcpus(xenstat_handle * handle);
 static void xenstat_uninit_xen_version(xenstat_handle * handle);
 static char *xenstat_get_domain_name(xenstat_handle * handle, unsigned int domain_id);
+static void xenstat_watch_names(xenstat_handle * handle);
+static void xenstat_sync_names(xenstat_handle * handle);
+static void xenstat_flush_names(xenstat_handle * handle);
 static void xenstat_prune_domain(xenstat_node *node, unsigned int entry);
 
 static xenstat_collector collectors[] = {
@@ -115,6 +119,8 @@ xenstat_handle *xenstat_init(void)
 		return NULL;
 	}
 
+	xenstat_watch_names(handle);
+
 	return handle;
 }
 
@@ -124,6 +130,7 @@ void xenstat_uninit(xenstat_handle * handle)
 	if (handle) {
 		for (i = 0; i < NUM_COLLECTORS; i++)
 			collectors[i].uninit(handle);
+		xenstat_flush_names(handle);
 		xc_interface_close(handle->xc_handle);
 		xs_daemon_close(handle->xshandle);
 		free(handle->priv);
@@ -175,6 +182,9 @@ xenstat_node *xenstat_get_node(xenstat_handle * handle, unsigned int flags)
 	/* Store the handle in the node for later access */
 	node->handle = handle;
 
+	/* Drop cached domain names if domains went away or were renamed */
+	xenstat_sync_names(handle);
+
 	/* Get information about the physical system */
 	if (xc_physinfo(handle->xc_handle, &physinfo) < 0) {
 		free(node);
@@ -475,8 +485,9 @@ xenstat_vbd *xenstat_domain_vbd(xenstat_domain * domain,
 /*
  * VCPU functions
  */
-/* Collect information about VCPUs */
-static int xenstat_collect_vcpus(xenstat_node * node)
+/* Collect information about VCPUs one hypercall at a time.  Used when the
+ * hypervisor does not support XEN_SYSCTL_getvcpuinfolist. */
+static int xenstat_collect_vcpus_each(xenstat_node * node)
 {
 	unsigned int i, vcpu, inc_index;
 
@@ -484,13 +495,7 @@ static int xenstat_collect_vcpus(xenstat_node * node)
 	for (i = 0; i < node->num_domains; i+=inc_index) {
 		inc_index = 1; /* default is to increment to next domain */
 
-		node->domains[i].vcpus = malloc(node->domains[i].num_vcpus
-						* sizeof(xenstat_vcpu));
-		if (node->domains[i].vcpus == NULL)
-			return 0;
-	
 		for (vcpu = 0; vcpu < node->domains[i].num_vcpus; vcpu++) {
-			/* FIXME: need to be using a more efficient mechanism*/
 			xc_vcpuinfo_t info;
 
 			if (xc_vcpu_getinfo(node->handle->xc_handle,
@@ -502,6 +507,8 @@ static int xenstat_collect_vcpus(xenstat_node * node)
 				else {
 					/* domain is in transition - remove
 					   from list */
+					free(node->domains[i].name);
+					free(node->domains[i].vcpus);
 					xenstat_prune_domain(node, i);
 
 					/* remember not to increment index! */
@@ -518,6 +525,80 @@ static int xenstat_collect_vcpus(xenstat_node * node)
 	return 1;
 }
 
+/* Collect information about VCPUs */
+static int xenstat_collect_vcpus(xenstat_node * node)
+{
+	xc_vcpuinfolist_t *info;
+	unsigned int i, j, total = 0;
+	uint32_t next = 0;
+	char *seen;
+	int n;
+
+	for (i = 0; i < node->num_domains; i++) {
+		node->domains[i].vcpus = calloc(node->domains[i].num_vcpus,
+						sizeof(xenstat_vcpu));
+		if (node->domains[i].vcpus == NULL)
+			return 0;
+		total += node->domains[i].num_vcpus;
+	}
+
+	if (total == 0)
+		return 1;
+
+	info = malloc(total * sizeof(*info));
+	seen = calloc(node->num_domains, 1);
+	if (info == NULL || seen == NULL) {
+		free(info);
+		free(seen);
+		return 0;
+	}
+
+	/* Both lists are sorted by domain id, so walk them together */
+	i = 0;
+	do {
+		n = xc_vcpu_getinfolist(node->handle->xc_handle, next,
+					total, info, &next);
+		if (n < 0) {
+			free(info);
+			free(seen);
+			if (errno == ENOMEM)
+				return 0;
+			return xenstat_collect_vcpus_each(node);
+		}
+
+		for (j = 0; j < n; j++) {
+			xenstat_domain *domain;
+
+			while (i < node->num_domains &&
+			       node->domains[i].id < info[j].domain)
+				i++;
+			if (i == node->num_domains)
+				break;
+			domain = &node->domains[i];
+			if (domain->id != info[j].domain ||
+			    info[j].vcpu >= domain->num_vcpus)
+				continue;
+
+			seen[i] = 1;
+			domain->vcpus[info[j].vcpu].online = info[j].online;
+			domain->vcpus[info[j].vcpu].ns = info[j].cpu_time;
+		}
+	} while (next != DOMID_INVALID && i < node->num_domains);
+
+	/* Domains that went away since the domain list was read */
+	for (i = node->num_domains; i-- > 0; ) {
+		if (seen[i])
+			continue;
+		free(node->domains[i].name);
+		free(node->domains[i].vcpus);
+		xenstat_prune_domain(node, i);
+	}
+
+	free(info);
+	free(seen);
+	return 1;
+}
+
 /* Free VCPU information */
 static void xenstat_free_vcpus(xenstat_node * node)
 {
@@ -737,7 +818,72 @@ unsigned long long xenstat_tmem_succ_pers_gets(xenstat_tmem *tmem)
 }
 
 
-static char *xenstat_get_domain_name(xenstat_handle *handle, unsigned int domain_id)
+/*
+ * Domain names are cached in the handle. Watching @releaseDomain and /vm
+ * tells us when a domain id may have been reused or a domain renamed, in
+ * which case the whole cache is dropped. Without the watches nothing is
+ * cached and names are read from xenstore every time.
+ */
+struct xenstat_name {
+	unsigned int domid;
+	char *name;
+	struct xenstat_name *next;
+};
+
+static void xenstat_watch_names(xenstat_handle *handle)
+{
+	if (xs_fileno(handle->xshandle) < 0)
+		return;
+
+	handle->names_watched =
+		xs_watch(handle->xshandle, "@releaseDomain", "xenstat") &&
+		xs_watch(handle->xshandle, "/vm", "xenstat");
+}
+
+static void xenstat_flush_names(xenstat_handle *handle)
+{
+	struct xenstat_name *entry, *next;
+	unsigned int i;
+
+	for (i = 0; i < NAME_CACHE_BUCKETS; i++) {
+		for (entry = handle->names[i]; entry != NULL; entry = next) {
+			next = entry->next;
+			free(entry->name);
+			free(entry);
+		}
+		handle->names[i] = NULL;
+	}
+}
+
+static void xenstat_sync_names(xenstat_handle *handle)
+{
+	struct pollfd pfd;
+	unsigned int num;
+	char **vec;
+	int fired = 0;
+
+	if (!handle->names_watched)
+		return;
+
+	pfd.fd = xs_fileno(handle->xshandle);
+	pfd.events = POLLIN;
+	while (poll(&pfd, 1, 0) > 0) {
+		vec = xs_read_watch(handle->xshandle, &num);
+		if (vec == NULL) {
+			/* can no longer trust the cache */
+			handle->names_watched = 0;
+			fired = 1;
+			break;
+		}
+		free(vec);
+		fired = 1;
+	}
+
+	if (fired)
+		xenstat_flush_names(handle);
+}
+
+static char *xenstat_read_domain_name(xenstat_handle *handle, unsigned int domain_id)
 {
 	char path[80], *vmpath;
 
@@ -754,6 +900,35 @@ static char *xenstat_get_domain_name(xenstat_handle *handle, unsigned int domain
 	return xs_read(handle->xshandle, XBT_NULL, path, NULL);
 }
 
+static char *xenstat_get_domain_name(xenstat_handle *handle, unsigned int domain_id)
+{
+	struct xenstat_name **bucket, *entry;
+	char *name;
+
+	if (!handle->names_watched)
+		return xenstat_read_domain_name(handle, domain_id);
+
+	bucket = &handle->names[domain_id % NAME_CACHE_BUCKETS];
+	for (entry = *bucket; entry != NULL; entry = entry->next)
+		if (entry->domid == domain_id)
+			return strdup(entry->name);
+
+	name = xenstat_read_domain_name(handle, domain_id);
+	if (name == NULL)
+		return NULL;
+
+	/* failing to cache is not an error */
+	entry = malloc(sizeof(*entry));
+	if (entry != NULL && (entry->name = strdup(name)) != NULL) {
+		entry->domid = domain_id;
+		entry->next = *bucket;
+		*bucket = entry;
+	} else
+		free(entry);
+
+	return name;
+}
+
 /* Remove specified entry from list of domains */
 static void xenstat_prune_domain(xenstat_node *node, unsigned int entry)
 {
@@ -32,12 +32,19 @@
 #define SHORT_ASC_LEN 5                 /* length of 65535 */
 #define VERSION_SIZE (2 * SHORT_ASC_LEN + 1 + sizeof(xen_extraversion_t) + 1)
 
+#define NAME_CACHE_BUCKETS 64
+
+struct xenstat_name;
+
 struct xenstat_handle {
 	int xc_handle;
 	struct xs_handle *xshandle; /* xenstore handle */
 	int page_size;
 	void *priv;
 	char xen_version[VERSION_SIZE]; /* xen version running on this node */
+	/* Domain names, valid while the xenstore watches are registered */
+	int names_watched;
+	struct xenstat_name *names[NAME_CACHE_BUCKETS];
 };
 
 struct xenstat_node {
@@ -8,6 +8,7 @@ perfc         ?= n
 perfc_arrays  ?= n
 lock_profile  ?= n
 crash_debug   ?= n
+flask_hook_profile ?= n
 frame_pointer ?= n
 
 XEN_ROOT=$(BASEDIR)/..
@@ -45,6 +46,7 @@ CFLAGS-y                += -g -D__XEN__
 CFLAGS-$(XSM_ENABLE)    += -DXSM_ENABLE
 CFLAGS-$(FLASK_ENABLE)  += -DFLASK_ENABLE -DXSM_MAGIC=0xf97cff8c
 CFLAGS-$(FLASK_ENABLE)  += -DFLASK_DEVELOP -DFLASK_BOOTPARAM -DFLASK_AVC_STATS
+CFLAGS-$(flask_hook_profile) += -DFLASK_HOOK_PROFILE
 CFLAGS-$(ACM_SECURITY)  += -DACM_SECURITY -DXSM_MAGIC=0xbcde0100
 CFLAGS-$(verbose)       += -DVERBOSE
 CFLAGS-$(crash_debug)   += -DCRASH_DEBUG
@@ -0,0 +1,1729 @@
+	.file	"asm-offsets.c"
+	.text
+.Ltext0:
+	.cfi_sections	.debug_frame
+	.file 0 "/root/repo/xen/arch/x86" "x86_64/asm-offsets.c"
+	.p2align 4
+	.globl	__dummy__
+	.hidden	__dummy__
+	.type	__dummy__, @function
+__dummy__:
+.LFB301:
+	.file 1 "x86_64/asm-offsets.c"
+	.loc 1 30 1 view -0
+	.cfi_startproc
+	.loc 1 31 5 view .LVU1
+#APP
+# 31 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r15 $0 offsetof(struct cpu_user_regs, r15)
+# 0 "" 2
+	.loc 1 31 49 view .LVU2
+	.loc 1 32 5 view .LVU3
+# 32 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r14 $8 offsetof(struct cpu_user_regs, r14)
+# 0 "" 2
+	.loc 1 32 49 view .LVU4
+	.loc 1 33 5 view .LVU5
+# 33 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r13 $16 offsetof(struct cpu_user_regs, r13)
+# 0 "" 2
+	.loc 1 33 49 view .LVU6
+	.loc 1 34 5 view .LVU7
+# 34 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r12 $24 offsetof(struct cpu_user_regs, r12)
+# 0 "" 2
+	.loc 1 34 49 view .LVU8
+	.loc 1 35 5 view .LVU9
+# 35 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rbp $32 offsetof(struct cpu_user_regs, rbp)
+# 0 "" 2
+	.loc 1 35 49 view .LVU10
+	.loc 1 36 5 view .LVU11
+# 36 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rbx $40 offsetof(struct cpu_user_regs, rbx)
+# 0 "" 2
+	.loc 1 36 49 view .LVU12
+	.loc 1 37 5 view .LVU13
+# 37 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r11 $48 offsetof(struct cpu_user_regs, r11)
+# 0 "" 2
+	.loc 1 37 49 view .LVU14
+	.loc 1 38 5 view .LVU15
+# 38 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r10 $56 offsetof(struct cpu_user_regs, r10)
+# 0 "" 2
+	.loc 1 38 49 view .LVU16
+	.loc 1 39 5 view .LVU17
+# 39 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r9 $64 offsetof(struct cpu_user_regs, r9)
+# 0 "" 2
+	.loc 1 39 47 view .LVU18
+	.loc 1 40 5 view .LVU19
+# 40 "x86_64/asm-offsets.c" 1
+	
+->UREGS_r8 $72 offsetof(struct cpu_user_regs, r8)
+# 0 "" 2
+	.loc 1 40 47 view .LVU20
+	.loc 1 41 5 view .LVU21
+# 41 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rax $80 offsetof(struct cpu_user_regs, rax)
+# 0 "" 2
+	.loc 1 41 49 view .LVU22
+	.loc 1 42 5 view .LVU23
+# 42 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rcx $88 offsetof(struct cpu_user_regs, rcx)
+# 0 "" 2
+	.loc 1 42 49 view .LVU24
+	.loc 1 43 5 view .LVU25
+# 43 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rdx $96 offsetof(struct cpu_user_regs, rdx)
+# 0 "" 2
+	.loc 1 43 49 view .LVU26
+	.loc 1 44 5 view .LVU27
+# 44 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rsi $104 offsetof(struct cpu_user_regs, rsi)
+# 0 "" 2
+	.loc 1 44 49 view .LVU28
+	.loc 1 45 5 view .LVU29
+# 45 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rdi $112 offsetof(struct cpu_user_regs, rdi)
+# 0 "" 2
+	.loc 1 45 49 view .LVU30
+	.loc 1 46 5 view .LVU31
+# 46 "x86_64/asm-offsets.c" 1
+	
+->UREGS_error_code $120 offsetof(struct cpu_user_regs, error_code)
+# 0 "" 2
+	.loc 1 46 63 view .LVU32
+	.loc 1 47 5 view .LVU33
+# 47 "x86_64/asm-offsets.c" 1
+	
+->UREGS_entry_vector $124 offsetof(struct cpu_user_regs, entry_vector)
+# 0 "" 2
+	.loc 1 47 67 view .LVU34
+	.loc 1 48 5 view .LVU35
+# 48 "x86_64/asm-offsets.c" 1
+	
+->UREGS_saved_upcall_mask $140 offsetof(struct cpu_user_regs, saved_upcall_mask)
+# 0 "" 2
+	.loc 1 48 77 view .LVU36
+	.loc 1 49 5 view .LVU37
+# 49 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rip $128 offsetof(struct cpu_user_regs, rip)
+# 0 "" 2
+	.loc 1 49 49 view .LVU38
+	.loc 1 50 5 view .LVU39
+# 50 "x86_64/asm-offsets.c" 1
+	
+->UREGS_cs $136 offsetof(struct cpu_user_regs, cs)
+# 0 "" 2
+	.loc 1 50 47 view .LVU40
+	.loc 1 51 5 view .LVU41
+# 51 "x86_64/asm-offsets.c" 1
+	
+->UREGS_eflags $144 offsetof(struct cpu_user_regs, eflags)
+# 0 "" 2
+	.loc 1 51 55 view .LVU42
+	.loc 1 52 5 view .LVU43
+# 52 "x86_64/asm-offsets.c" 1
+	
+->UREGS_rsp $152 offsetof(struct cpu_user_regs, rsp)
+# 0 "" 2
+	.loc 1 52 49 view .LVU44
+	.loc 1 53 5 view .LVU45
+# 53 "x86_64/asm-offsets.c" 1
+	
+->UREGS_ss $160 offsetof(struct cpu_user_regs, ss)
+# 0 "" 2
+	.loc 1 53 47 view .LVU46
+	.loc 1 54 5 view .LVU47
+# 54 "x86_64/asm-offsets.c" 1
+	
+->UREGS_ds $176 offsetof(struct cpu_user_regs, ds)
+# 0 "" 2
+	.loc 1 54 47 view .LVU48
+	.loc 1 55 5 view .LVU49
+# 55 "x86_64/asm-offsets.c" 1
+	
+->UREGS_es $168 offsetof(struct cpu_user_regs, es)
+# 0 "" 2
+	.loc 1 55 47 view .LVU50
+	.loc 1 56 5 view .LVU51
+# 56 "x86_64/asm-offsets.c" 1
+	
+->UREGS_fs $184 offsetof(struct cpu_user_regs, fs)
+# 0 "" 2
+	.loc 1 56 47 view .LVU52
+	.loc 1 57 5 view .LVU53
+# 57 "x86_64/asm-offsets.c" 1
+	
+->UREGS_gs $192 offsetof(struct cpu_user_regs, gs)
+# 0 "" 2
+	.loc 1 57 47 view .LVU54
+	.loc 1 58 5 view .LVU55
+# 58 "x86_64/asm-offsets.c" 1
+	
+->UREGS_kernel_sizeof $168 offsetof(struct cpu_user_regs, es)
+# 0 "" 2
+	.loc 1 58 58 view .LVU56
+	.loc 1 59 5 view .LVU57
+# 59 "x86_64/asm-offsets.c" 1
+	
+->UREGS_user_sizeof $200 sizeof(struct cpu_user_regs)
+# 0 "" 2
+	.loc 1 60 5 view .LVU58
+# 60 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 62 5 view .LVU59
+# 62 "x86_64/asm-offsets.c" 1
+	
+->irq_caps_offset $432 offsetof(struct domain, irq_caps)
+# 0 "" 2
+	.loc 1 62 53 view .LVU60
+	.loc 1 63 5 view .LVU61
+# 63 "x86_64/asm-offsets.c" 1
+	
+->next_in_list_offset $88 offsetof(struct domain, next_in_list)
+# 0 "" 2
+	.loc 1 63 61 view .LVU62
+	.loc 1 64 5 view .LVU63
+# 64 "x86_64/asm-offsets.c" 1
+	
+->VCPU_processor $4 offsetof(struct vcpu, processor)
+# 0 "" 2
+	.loc 1 64 51 view .LVU64
+	.loc 1 65 5 view .LVU65
+# 65 "x86_64/asm-offsets.c" 1
+	
+->VCPU_domain $16 offsetof(struct vcpu, domain)
+# 0 "" 2
+	.loc 1 65 45 view .LVU66
+	.loc 1 66 5 view .LVU67
+# 66 "x86_64/asm-offsets.c" 1
+	
+->VCPU_vcpu_info $8 offsetof(struct vcpu, vcpu_info)
+# 0 "" 2
+	.loc 1 66 51 view .LVU68
+	.loc 1 67 5 view .LVU69
+# 67 "x86_64/asm-offsets.c" 1
+	
+->VCPU_trap_bounce $5720 offsetof(struct vcpu, arch.trap_bounce)
+# 0 "" 2
+	.loc 1 67 60 view .LVU70
+	.loc 1 68 5 view .LVU71
+# 68 "x86_64/asm-offsets.c" 1
+	
+->VCPU_int80_bounce $5752 offsetof(struct vcpu, arch.int80_bounce)
+# 0 "" 2
+	.loc 1 68 62 view .LVU72
+	.loc 1 69 5 view .LVU73
+# 69 "x86_64/asm-offsets.c" 1
+	
+->VCPU_thread_flags $5680 offsetof(struct vcpu, arch.flags)
+# 0 "" 2
+	.loc 1 69 55 view .LVU74
+	.loc 1 70 5 view .LVU75
+# 70 "x86_64/asm-offsets.c" 1
+	
+->VCPU_event_addr $5624 offsetof(struct vcpu, arch.guest_context.event_callback_eip)
+# 0 "" 2
+	.loc 1 71 50 view .LVU76
+	.loc 1 72 5 view .LVU77
+# 72 "x86_64/asm-offsets.c" 1
+	
+->VCPU_event_sel $5640 offsetof(struct vcpu, arch.guest_context.event_callback_cs)
+# 0 "" 2
+	.loc 1 73 49 view .LVU78
+	.loc 1 74 5 view .LVU79
+# 74 "x86_64/asm-offsets.c" 1
+	
+->VCPU_failsafe_addr $5632 offsetof(struct vcpu, arch.guest_context.failsafe_callback_eip)
+# 0 "" 2
+	.loc 1 75 53 view .LVU80
+	.loc 1 76 5 view .LVU81
+# 76 "x86_64/asm-offsets.c" 1
+	
+->VCPU_failsafe_sel $5644 offsetof(struct vcpu, arch.guest_context.failsafe_callback_cs)
+# 0 "" 2
+	.loc 1 77 52 view .LVU82
+	.loc 1 78 5 view .LVU83
+# 78 "x86_64/asm-offsets.c" 1
+	
+->VCPU_syscall_addr $5640 offsetof(struct vcpu, arch.guest_context.syscall_callback_eip)
+# 0 "" 2
+	.loc 1 79 52 view .LVU84
+	.loc 1 80 5 view .LVU85
+# 80 "x86_64/asm-offsets.c" 1
+	
+->VCPU_syscall32_addr $5768 offsetof(struct vcpu, arch.syscall32_callback_eip)
+# 0 "" 2
+	.loc 1 80 74 view .LVU86
+	.loc 1 81 5 view .LVU87
+# 81 "x86_64/asm-offsets.c" 1
+	
+->VCPU_syscall32_sel $5784 offsetof(struct vcpu, arch.syscall32_callback_cs)
+# 0 "" 2
+	.loc 1 81 72 view .LVU88
+	.loc 1 82 5 view .LVU89
+# 82 "x86_64/asm-offsets.c" 1
+	
+->VCPU_syscall32_disables_events $5788 offsetof(struct vcpu, arch.syscall32_disables_events)
+# 0 "" 2
+	.loc 1 83 43 view .LVU90
+	.loc 1 84 5 view .LVU91
+# 84 "x86_64/asm-offsets.c" 1
+	
+->VCPU_sysenter_addr $5776 offsetof(struct vcpu, arch.sysenter_callback_eip)
+# 0 "" 2
+	.loc 1 84 72 view .LVU92
+	.loc 1 85 5 view .LVU93
+# 85 "x86_64/asm-offsets.c" 1
+	
+->VCPU_sysenter_sel $5786 offsetof(struct vcpu, arch.sysenter_callback_cs)
+# 0 "" 2
+	.loc 1 85 70 view .LVU94
+	.loc 1 86 5 view .LVU95
+# 86 "x86_64/asm-offsets.c" 1
+	
+->VCPU_sysenter_disables_events $5789 offsetof(struct vcpu, arch.sysenter_disables_events)
+# 0 "" 2
+	.loc 1 87 42 view .LVU96
+	.loc 1 88 5 view .LVU97
+# 88 "x86_64/asm-offsets.c" 1
+	
+->VCPU_gp_fault_addr $1448 offsetof(struct vcpu, arch.guest_context.trap_ctxt[13].address)
+# 0 "" 2
+	.loc 1 89 64 view .LVU98
+	.loc 1 90 5 view .LVU99
+# 90 "x86_64/asm-offsets.c" 1
+	
+->VCPU_gp_fault_sel $1442 offsetof(struct vcpu, arch.guest_context.trap_ctxt[13].cs)
+# 0 "" 2
+	.loc 1 91 59 view .LVU100
+	.loc 1 92 5 view .LVU101
+# 92 "x86_64/asm-offsets.c" 1
+	
+->VCPU_gp_fault_flags $1441 offsetof(struct vcpu, arch.guest_context.trap_ctxt[13].flags)
+# 0 "" 2
+	.loc 1 93 62 view .LVU102
+	.loc 1 94 5 view .LVU103
+# 94 "x86_64/asm-offsets.c" 1
+	
+->VCPU_kernel_sp $5488 offsetof(struct vcpu, arch.guest_context.kernel_sp)
+# 0 "" 2
+	.loc 1 94 70 view .LVU104
+	.loc 1 95 5 view .LVU105
+# 95 "x86_64/asm-offsets.c" 1
+	
+->VCPU_kernel_ss $5480 offsetof(struct vcpu, arch.guest_context.kernel_ss)
+# 0 "" 2
+	.loc 1 95 70 view .LVU106
+	.loc 1 96 5 view .LVU107
+# 96 "x86_64/asm-offsets.c" 1
+	
+->VCPU_guest_context_flags $1024 offsetof(struct vcpu, arch.guest_context.flags)
+# 0 "" 2
+	.loc 1 96 76 view .LVU108
+	.loc 1 97 5 view .LVU109
+# 97 "x86_64/asm-offsets.c" 1
+	
+->VCPU_nmi_pending $269 offsetof(struct vcpu, async_exception_state[(1)-1].pending)
+# 0 "" 2
+	.loc 1 97 55 view .LVU110
+	.loc 1 98 5 view .LVU111
+# 98 "x86_64/asm-offsets.c" 1
+	
+->VCPU_mce_pending $271 offsetof(struct vcpu, async_exception_state[(2)-1].pending)
+# 0 "" 2
+	.loc 1 98 55 view .LVU112
+	.loc 1 99 5 view .LVU113
+# 99 "x86_64/asm-offsets.c" 1
+	
+->VCPU_nmi_old_mask $270 offsetof(struct vcpu, async_exception_state[(1)-1].old_mask)
+# 0 "" 2
+	.loc 1 99 63 view .LVU114
+	.loc 1 100 5 view .LVU115
+# 100 "x86_64/asm-offsets.c" 1
+	
+->VCPU_mce_old_mask $272 offsetof(struct vcpu, async_exception_state[(2)-1].old_mask)
+# 0 "" 2
+	.loc 1 100 63 view .LVU116
+	.loc 1 101 5 view .LVU117
+# 101 "x86_64/asm-offsets.c" 1
+	
+->VCPU_async_exception_mask $273 offsetof(struct vcpu, async_exception_mask)
+# 0 "" 2
+	.loc 1 101 73 view .LVU118
+	.loc 1 102 5 view .LVU119
+# 102 "x86_64/asm-offsets.c" 1
+	
+->VCPU_TRAP_NMI $1 VCPU_TRAP_NMI
+# 0 "" 2
+	.loc 1 103 5 view .LVU120
+# 103 "x86_64/asm-offsets.c" 1
+	
+->VCPU_TRAP_MCE $2 VCPU_TRAP_MCE
+# 0 "" 2
+	.loc 1 104 5 view .LVU121
+# 104 "x86_64/asm-offsets.c" 1
+	
+->_VGCF_failsafe_disables_events $3 _VGCF_failsafe_disables_events
+# 0 "" 2
+	.loc 1 105 5 view .LVU122
+# 105 "x86_64/asm-offsets.c" 1
+	
+->_VGCF_syscall_disables_events $4 _VGCF_syscall_disables_events
+# 0 "" 2
+	.loc 1 106 5 view .LVU123
+# 106 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 108 5 view .LVU124
+# 108 "x86_64/asm-offsets.c" 1
+	
+->VCPU_svm_vmcb_pa $6176 offsetof(struct vcpu, arch.hvm_vcpu.u.svm.vmcb_pa)
+# 0 "" 2
+	.loc 1 108 64 view .LVU125
+	.loc 1 109 5 view .LVU126
+# 109 "x86_64/asm-offsets.c" 1
+	
+->VCPU_svm_vmcb $6168 offsetof(struct vcpu, arch.hvm_vcpu.u.svm.vmcb)
+# 0 "" 2
+	.loc 1 109 58 view .LVU127
+	.loc 1 110 5 view .LVU128
+# 110 "x86_64/asm-offsets.c" 1
+	
+->VCPU_svm_vmcb_in_sync $6196 offsetof(struct vcpu, arch.hvm_vcpu.u.svm.vmcb_in_sync)
+# 0 "" 2
+	.loc 1 110 74 view .LVU129
+	.loc 1 111 5 view .LVU130
+# 111 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 113 5 view .LVU131
+# 113 "x86_64/asm-offsets.c" 1
+	
+->VCPU_vmx_launched $6204 offsetof(struct vcpu, arch.hvm_vcpu.u.vmx.launched)
+# 0 "" 2
+	.loc 1 113 66 view .LVU132
+	.loc 1 114 5 view .LVU133
+# 114 "x86_64/asm-offsets.c" 1
+	
+->VCPU_vmx_realmode $6336 offsetof(struct vcpu, arch.hvm_vcpu.u.vmx.vmx_realmode)
+# 0 "" 2
+	.loc 1 114 70 view .LVU134
+	.loc 1 115 5 view .LVU135
+# 115 "x86_64/asm-offsets.c" 1
+	
+->VCPU_vmx_emulate $6337 offsetof(struct vcpu, arch.hvm_vcpu.u.vmx.vmx_emulate)
+# 0 "" 2
+	.loc 1 115 68 view .LVU136
+	.loc 1 116 5 view .LVU137
+# 116 "x86_64/asm-offsets.c" 1
+	
+->VCPU_vm86_seg_mask $6338 offsetof(struct vcpu, arch.hvm_vcpu.u.vmx.vm86_segment_mask)
+# 0 "" 2
+	.loc 1 116 76 view .LVU138
+	.loc 1 117 5 view .LVU139
+# 117 "x86_64/asm-offsets.c" 1
+	
+->VCPU_hvm_guest_cr2 $5808 offsetof(struct vcpu, arch.hvm_vcpu.guest_cr[2])
+# 0 "" 2
+	.loc 1 117 71 view .LVU140
+	.loc 1 118 5 view .LVU141
+# 118 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 120 5 view .LVU142
+# 120 "x86_64/asm-offsets.c" 1
+	
+->DOMAIN_is_32bit_pv $3996 offsetof(struct domain, arch.is_32bit_pv)
+# 0 "" 2
+	.loc 1 120 64 view .LVU143
+	.loc 1 121 5 view .LVU144
+# 121 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 123 5 view .LVU145
+# 123 "x86_64/asm-offsets.c" 1
+	
+->VMCB_rax $1528 offsetof(struct vmcb_struct, rax)
+# 0 "" 2
+	.loc 1 123 46 view .LVU146
+	.loc 1 124 5 view .LVU147
+# 124 "x86_64/asm-offsets.c" 1
+	
+->VMCB_rip $1400 offsetof(struct vmcb_struct, rip)
+# 0 "" 2
+	.loc 1 124 46 view .LVU148
+	.loc 1 125 5 view .LVU149
+# 125 "x86_64/asm-offsets.c" 1
+	
+->VMCB_rsp $1496 offsetof(struct vmcb_struct, rsp)
+# 0 "" 2
+	.loc 1 125 46 view .LVU150
+	.loc 1 126 5 view .LVU151
+# 126 "x86_64/asm-offsets.c" 1
+	
+->VMCB_rflags $1392 offsetof(struct vmcb_struct, rflags)
+# 0 "" 2
+	.loc 1 126 52 view .LVU152
+	.loc 1 127 5 view .LVU153
+# 127 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 129 5 view .LVU154
+# 129 "x86_64/asm-offsets.c" 1
+	
+->VCPUINFO_upcall_pending $0 offsetof(struct vcpu_info, evtchn_upcall_pending)
+# 0 "" 2
+	.loc 1 129 77 view .LVU155
+	.loc 1 130 5 view .LVU156
+# 130 "x86_64/asm-offsets.c" 1
+	
+->VCPUINFO_upcall_mask $1 offsetof(struct vcpu_info, evtchn_upcall_mask)
+# 0 "" 2
+	.loc 1 130 71 view .LVU157
+	.loc 1 131 5 view .LVU158
+# 131 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 133 5 view .LVU159
+# 133 "x86_64/asm-offsets.c" 1
+	
+->COMPAT_VCPUINFO_upcall_pending $0 offsetof(struct compat_vcpu_info, evtchn_upcall_pending)
+# 0 "" 2
+	.loc 1 133 91 view .LVU160
+	.loc 1 134 5 view .LVU161
+# 134 "x86_64/asm-offsets.c" 1
+	
+->COMPAT_VCPUINFO_upcall_mask $1 offsetof(struct compat_vcpu_info, evtchn_upcall_mask)
+# 0 "" 2
+	.loc 1 134 85 view .LVU162
+	.loc 1 135 5 view .LVU163
+# 135 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 137 5 view .LVU164
+# 137 "x86_64/asm-offsets.c" 1
+	
+->CPUINFO_current_vcpu $208 offsetof(struct cpu_info, current_vcpu)
+# 0 "" 2
+	.loc 1 137 64 view .LVU165
+	.loc 1 138 5 view .LVU166
+# 138 "x86_64/asm-offsets.c" 1
+	
+->CPUINFO_sizeof $216 sizeof(struct cpu_info)
+# 0 "" 2
+	.loc 1 139 5 view .LVU167
+# 139 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 141 5 view .LVU168
+# 141 "x86_64/asm-offsets.c" 1
+	
+->TRAPBOUNCE_error_code $0 offsetof(struct trap_bounce, error_code)
+# 0 "" 2
+	.loc 1 141 66 view .LVU169
+	.loc 1 142 5 view .LVU170
+# 142 "x86_64/asm-offsets.c" 1
+	
+->TRAPBOUNCE_flags $4 offsetof(struct trap_bounce, flags)
+# 0 "" 2
+	.loc 1 142 56 view .LVU171
+	.loc 1 143 5 view .LVU172
+# 143 "x86_64/asm-offsets.c" 1
+	
+->TRAPBOUNCE_cs $6 offsetof(struct trap_bounce, cs)
+# 0 "" 2
+	.loc 1 143 50 view .LVU173
+	.loc 1 144 5 view .LVU174
+# 144 "x86_64/asm-offsets.c" 1
+	
+->TRAPBOUNCE_eip $8 offsetof(struct trap_bounce, eip)
+# 0 "" 2
+	.loc 1 144 52 view .LVU175
+	.loc 1 145 5 view .LVU176
+# 145 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 148 5 view .LVU177
+# 148 "x86_64/asm-offsets.c" 1
+	
+->ASM_PERFC_hypercalls $367 PERFC_hypercalls
+# 0 "" 2
+	.loc 1 149 5 view .LVU178
+# 149 "x86_64/asm-offsets.c" 1
+	
+->ASM_PERFC_exceptions $0 PERFC_exceptions
+# 0 "" 2
+	.loc 1 150 5 view .LVU179
+# 150 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 153 5 view .LVU180
+# 153 "x86_64/asm-offsets.c" 1
+	
+->IRQSTAT_shift $7 LOG_2(sizeof(irq_cpustat_t))
+# 0 "" 2
+	.loc 1 154 5 view .LVU181
+# 154 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 156 5 view .LVU182
+# 156 "x86_64/asm-offsets.c" 1
+	
+->CPUINFO_ext_features $12 offsetof(struct cpuinfo_x86, x86_capability[1])
+# 0 "" 2
+	.loc 1 156 72 view .LVU183
+	.loc 1 157 5 view .LVU184
+# 157 "x86_64/asm-offsets.c" 1
+	
+->
+# 0 "" 2
+	.loc 1 159 5 view .LVU185
+# 159 "x86_64/asm-offsets.c" 1
+	
+->MB_flags $0 offsetof(multiboot_info_t, flags)
+# 0 "" 2
+	.loc 1 159 46 view .LVU186
+	.loc 1 160 5 view .LVU187
+# 160 "x86_64/asm-offsets.c" 1
+	
+->MB_cmdline $16 offsetof(multiboot_info_t, cmdline)
+# 0 "" 2
+	.loc 1 160 50 view .LVU188
+	.loc 1 161 1 is_stmt 0 view .LVU189
+#NO_APP
+	ret
+	.cfi_endproc
+.LFE301:
+	.size	__dummy__, .-__dummy__
+.Letext0:
+	.file 2 "/root/repo/xen/include/xen/perfc.h"
+	.section	.debug_info,"",@progbits
+.Ldebug_info0:
+	.long	0x559
+	.value	0x5
+	.byte	0x1
+	.byte	0x8
+	.long	.Ldebug_abbrev0
+	.uleb128 0x4
+	.long	.LASF185
+	.byte	0xc
+	.long	.LASF0
+	.long	.LASF1
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.long	.Ldebug_line0
+	.uleb128 0x2
+	.byte	0x1
+	.byte	0x6
+	.long	.LASF2
+	.uleb128 0x2
+	.byte	0x4
+	.byte	0x7
+	.long	.LASF3
+	.uleb128 0x2
+	.byte	0x1
+	.byte	0x8
+	.long	.LASF4
+	.uleb128 0x2
+	.byte	0x8
+	.byte	0x7
+	.long	.LASF5
+	.uleb128 0x2
+	.byte	0x1
+	.byte	0x6
+	.long	.LASF6
+	.uleb128 0x2
+	.byte	0x2
+	.byte	0x5
+	.long	.LASF7
+	.uleb128 0x2
+	.byte	0x2
+	.byte	0x7
+	.long	.LASF8
+	.uleb128 0x5
+	.byte	0x4
+	.byte	0x5
+	.string	"int"
+	.uleb128 0x2
+	.byte	0x8
+	.byte	0x5
+	.long	.LASF9
+	.uleb128 0x6
+	.long	.LASF186
+	.byte	0x7
+	.byte	0x4
+	.long	0x35
+	.byte	0x2
+	.byte	0x2a
+	.byte	0x6
+	.long	0x542
+	.uleb128 0x3
+	.long	.LASF10
+	.byte	0
+	.uleb128 0x3
+	.long	.LASF11
+	.byte	0x1f
+	.uleb128 0x3
+	.long	.LASF12
+	.byte	0x20
+	.uleb128 0x3
+	.long	.LASF13
+	.byte	0x57
+	.uleb128 0x3
+	.long	.LASF14
+	.byte	0x58
+	.uleb128 0x3
+	.long	.LASF15
+	.byte	0x77
+	.uleb128 0x3
+	.long	.LASF16
+	.byte	0x78
+	.uleb128 0x1
+	.long	.LASF17
+	.value	0x105
+	.uleb128 0x1
+	.long	.LASF18
+	.value	0x106
+	.uleb128 0x1
+	.long	.LASF19
+	.value	0x107
+	.uleb128 0x1
+	.long	.LASF20
+	.value	0x108
+	.uleb128 0x1
+	.long	.LASF21
+	.value	0x109
+	.uleb128 0x1
+	.long	.LASF22
+	.value	0x10a
+	.uleb128 0x1
+	.long	.LASF23
+	.value	0x10b
+	.uleb128 0x1
+	.long	.LASF24
+	.value	0x10c
+	.uleb128 0x1
+	.long	.LASF25
+	.value	0x10d
+	.uleb128 0x1
+	.long	.LASF26
+	.value	0x10e
+	.uleb128 0x1
+	.long	.LASF27
+	.value	0x10f
+	.uleb128 0x1
+	.long	.LASF28
+	.value	0x110
+	.uleb128 0x1
+	.long	.LASF29
+	.value	0x111
+	.uleb128 0x1
+	.long	.LASF30
+	.value	0x112
+	.uleb128 0x1
+	.long	.LASF31
+	.value	0x113
+	.uleb128 0x1
+	.long	.LASF32
+	.value	0x114
+	.uleb128 0x1
+	.long	.LASF33
+	.value	0x115
+	.uleb128 0x1
+	.long	.LASF34
+	.value	0x116
+	.uleb128 0x1
+	.long	.LASF35
+	.value	0x117
+	.uleb128 0x1
+	.long	.LASF36
+	.value	0x118
+	.uleb128 0x1
+	.long	.LASF37
+	.value	0x119
+	.uleb128 0x1
+	.long	.LASF38
+	.value	0x11a
+	.uleb128 0x1
+	.long	.LASF39
+	.value	0x11b
+	.uleb128 0x1
+	.long	.LASF40
+	.value	0x11c
+	.uleb128 0x1
+	.long	.LASF41
+	.value	0x11d
+	.uleb128 0x1
+	.long	.LASF42
+	.value	0x11e
+	.uleb128 0x1
+	.long	.LASF43
+	.value	0x11f
+	.uleb128 0x1
+	.long	.LASF44
+	.value	0x120
+	.uleb128 0x1
+	.long	.LASF45
+	.value	0x121
+	.uleb128 0x1
+	.long	.LASF46
+	.value	0x122
+	.uleb128 0x1
+	.long	.LASF47
+	.value	0x123
+	.uleb128 0x1
+	.long	.LASF48
+	.value	0x124
+	.uleb128 0x1
+	.long	.LASF49
+	.value	0x125
+	.uleb128 0x1
+	.long	.LASF50
+	.value	0x126
+	.uleb128 0x1
+	.long	.LASF51
+	.value	0x127
+	.uleb128 0x1
+	.long	.LASF52
+	.value	0x128
+	.uleb128 0x1
+	.long	.LASF53
+	.value	0x129
+	.uleb128 0x1
+	.long	.LASF54
+	.value	0x12a
+	.uleb128 0x1
+	.long	.LASF55
+	.value	0x12b
+	.uleb128 0x1
+	.long	.LASF56
+	.value	0x12c
+	.uleb128 0x1
+	.long	.LASF57
+	.value	0x12d
+	.uleb128 0x1
+	.long	.LASF58
+	.value	0x12e
+	.uleb128 0x1
+	.long	.LASF59
+	.value	0x12f
+	.uleb128 0x1
+	.long	.LASF60
+	.value	0x130
+	.uleb128 0x1
+	.long	.LASF61
+	.value	0x131
+	.uleb128 0x1
+	.long	.LASF62
+	.value	0x132
+	.uleb128 0x1
+	.long	.LASF63
+	.value	0x133
+	.uleb128 0x1
+	.long	.LASF64
+	.value	0x134
+	.uleb128 0x1
+	.long	.LASF65
+	.value	0x135
+	.uleb128 0x1
+	.long	.LASF66
+	.value	0x136
+	.uleb128 0x1
+	.long	.LASF67
+	.value	0x137
+	.uleb128 0x1
+	.long	.LASF68
+	.value	0x138
+	.uleb128 0x1
+	.long	.LASF69
+	.value	0x139
+	.uleb128 0x1
+	.long	.LASF70
+	.value	0x13a
+	.uleb128 0x1
+	.long	.LASF71
+	.value	0x13b
+	.uleb128 0x1
+	.long	.LASF72
+	.value	0x13c
+	.uleb128 0x1
+	.long	.LASF73
+	.value	0x13d
+	.uleb128 0x1
+	.long	.LASF74
+	.value	0x13e
+	.uleb128 0x1
+	.long	.LASF75
+	.value	0x13f
+	.uleb128 0x1
+	.long	.LASF76
+	.value	0x140
+	.uleb128 0x1
+	.long	.LASF77
+	.value	0x141
+	.uleb128 0x1
+	.long	.LASF78
+	.value	0x142
+	.uleb128 0x1
+	.long	.LASF79
+	.value	0x143
+	.uleb128 0x1
+	.long	.LASF80
+	.value	0x144
+	.uleb128 0x1
+	.long	.LASF81
+	.value	0x145
+	.uleb128 0x1
+	.long	.LASF82
+	.value	0x146
+	.uleb128 0x1
+	.long	.LASF83
+	.value	0x147
+	.uleb128 0x1
+	.long	.LASF84
+	.value	0x148
+	.uleb128 0x1
+	.long	.LASF85
+	.value	0x149
+	.uleb128 0x1
+	.long	.LASF86
+	.value	0x14a
+	.uleb128 0x1
+	.long	.LASF87
+	.value	0x14b
+	.uleb128 0x1
+	.long	.LASF88
+	.value	0x14c
+	.uleb128 0x1
+	.long	.LASF89
+	.value	0x14d
+	.uleb128 0x1
+	.long	.LASF90
+	.value	0x14e
+	.uleb128 0x1
+	.long	.LASF91
+	.value	0x14f
+	.uleb128 0x1
+	.long	.LASF92
+	.value	0x150
+	.uleb128 0x1
+	.long	.LASF93
+	.value	0x151
+	.uleb128 0x1
+	.long	.LASF94
+	.value	0x152
+	.uleb128 0x1
+	.long	.LASF95
+	.value	0x153
+	.uleb128 0x1
+	.long	.LASF96
+	.value	0x154
+	.uleb128 0x1
+	.long	.LASF97
+	.value	0x155
+	.uleb128 0x1
+	.long	.LASF98
+	.value	0x156
+	.uleb128 0x1
+	.long	.LASF99
+	.value	0x157
+	.uleb128 0x1
+	.long	.LASF100
+	.value	0x158
+	.uleb128 0x1
+	.long	.LASF101
+	.value	0x159
+	.uleb128 0x1
+	.long	.LASF102
+	.value	0x15a
+	.uleb128 0x1
+	.long	.LASF103
+	.value	0x15b
+	.uleb128 0x1
+	.long	.LASF104
+	.value	0x15c
+	.uleb128 0x1
+	.long	.LASF105
+	.value	0x15d
+	.uleb128 0x1
+	.long	.LASF106
+	.value	0x15e
+	.uleb128 0x1
+	.long	.LASF107
+	.value	0x15f
+	.uleb128 0x1
+	.long	.LASF108
+	.value	0x160
+	.uleb128 0x1
+	.long	.LASF109
+	.value	0x161
+	.uleb128 0x1
+	.long	.LASF110
+	.value	0x162
+	.uleb128 0x1
+	.long	.LASF111
+	.value	0x163
+	.uleb128 0x1
+	.long	.LASF112
+	.value	0x164
+	.uleb128 0x1
+	.long	.LASF113
+	.value	0x165
+	.uleb128 0x1
+	.long	.LASF114
+	.value	0x166
+	.uleb128 0x1
+	.long	.LASF115
+	.value	0x167
+	.uleb128 0x1
+	.long	.LASF116
+	.value	0x168
+	.uleb128 0x1
+	.long	.LASF117
+	.value	0x169
+	.uleb128 0x1
+	.long	.LASF118
+	.value	0x16a
+	.uleb128 0x1
+	.long	.LASF119
+	.value	0x16b
+	.uleb128 0x1
+	.long	.LASF120
+	.value	0x16c
+	.uleb128 0x1
+	.long	.LASF121
+	.value	0x16d
+	.uleb128 0x1
+	.long	.LASF122
+	.value	0x16e
+	.uleb128 0x1
+	.long	.LASF123
+	.value	0x16f
+	.uleb128 0x1
+	.long	.LASF124
+	.value	0x1ae
+	.uleb128 0x1
+	.long	.LASF125
+	.value	0x1af
+	.uleb128 0x1
+	.long	.LASF126
+	.value	0x1b0
+	.uleb128 0x1
+	.long	.LASF127
+	.value	0x1b1
+	.uleb128 0x1
+	.long	.LASF128
+	.value	0x1b2
+	.uleb128 0x1
+	.long	.LASF129
+	.value	0x1b3
+	.uleb128 0x1
+	.long	.LASF130
+	.value	0x1b4
+	.uleb128 0x1
+	.long	.LASF131
+	.value	0x1b5
+	.uleb128 0x1
+	.long	.LASF132
+	.value	0x1b6
+	.uleb128 0x1
+	.long	.LASF133
+	.value	0x1b7
+	.uleb128 0x1
+	.long	.LASF134
+	.value	0x1b8
+	.uleb128 0x1
+	.long	.LASF135
+	.value	0x1b9
+	.uleb128 0x1
+	.long	.LASF136
+	.value	0x1ba
+	.uleb128 0x1
+	.long	.LASF137
+	.value	0x1bb
+	.uleb128 0x1
+	.long	.LASF138
+	.value	0x1bc
+	.uleb128 0x1
+	.long	.LASF139
+	.value	0x1bd
+	.uleb128 0x1
+	.long	.LASF140
+	.value	0x1be
+	.uleb128 0x1
+	.long	.LASF141
+	.value	0x1bf
+	.uleb128 0x1
+	.long	.LASF142
+	.value	0x1c0
+	.uleb128 0x1
+	.long	.LASF143
+	.value	0x1c1
+	.uleb128 0x1
+	.long	.LASF144
+	.value	0x1c2
+	.uleb128 0x1
+	.long	.LASF145
+	.value	0x1c3
+	.uleb128 0x1
+	.long	.LASF146
+	.value	0x1c4
+	.uleb128 0x1
+	.long	.LASF147
+	.value	0x1c5
+	.uleb128 0x1
+	.long	.LASF148
+	.value	0x1c6
+	.uleb128 0x1
+	.long	.LASF149
+	.value	0x1c7
+	.uleb128 0x1
+	.long	.LASF150
+	.value	0x1c8
+	.uleb128 0x1
+	.long	.LASF151
+	.value	0x1c9
+	.uleb128 0x1
+	.long	.LASF152
+	.value	0x1ca
+	.uleb128 0x1
+	.long	.LASF153
+	.value	0x1cb
+	.uleb128 0x1
+	.long	.LASF154
+	.value	0x1cc
+	.uleb128 0x1
+	.long	.LASF155
+	.value	0x1cd
+	.uleb128 0x1
+	.long	.LASF156
+	.value	0x1ce
+	.uleb128 0x1
+	.long	.LASF157
+	.value	0x1cf
+	.uleb128 0x1
+	.long	.LASF158
+	.value	0x1d0
+	.uleb128 0x1
+	.long	.LASF159
+	.value	0x1d1
+	.uleb128 0x1
+	.long	.LASF160
+	.value	0x1d2
+	.uleb128 0x1
+	.long	.LASF161
+	.value	0x1d3
+	.uleb128 0x1
+	.long	.LASF162
+	.value	0x1d4
+	.uleb128 0x1
+	.long	.LASF163
+	.value	0x1d5
+	.uleb128 0x1
+	.long	.LASF164
+	.value	0x1d6
+	.uleb128 0x1
+	.long	.LASF165
+	.value	0x1d7
+	.uleb128 0x1
+	.long	.LASF166
+	.value	0x1d8
+	.uleb128 0x1
+	.long	.LASF167
+	.value	0x1d9
+	.uleb128 0x1
+	.long	.LASF168
+	.value	0x1da
+	.uleb128 0x1
+	.long	.LASF169
+	.value	0x1db
+	.uleb128 0x1
+	.long	.LASF170
+	.value	0x1dc
+	.uleb128 0x1
+	.long	.LASF171
+	.value	0x1dd
+	.uleb128 0x1
+	.long	.LASF172
+	.value	0x1de
+	.uleb128 0x1
+	.long	.LASF173
+	.value	0x1df
+	.uleb128 0x1
+	.long	.LASF174
+	.value	0x1e0
+	.uleb128 0x1
+	.long	.LASF175
+	.value	0x1e1
+	.uleb128 0x1
+	.long	.LASF176
+	.value	0x1e2
+	.uleb128 0x1
+	.long	.LASF177
+	.value	0x1e3
+	.uleb128 0x1
+	.long	.LASF178
+	.value	0x1e4
+	.uleb128 0x1
+	.long	.LASF179
+	.value	0x1e5
+	.uleb128 0x1
+	.long	.LASF180
+	.value	0x1e6
+	.uleb128 0x1
+	.long	.LASF181
+	.value	0x1e7
+	.uleb128 0x1
+	.long	.LASF182
+	.value	0x1e8
+	.uleb128 0x1
+	.long	.LASF183
+	.value	0x1e9
+	.uleb128 0x1
+	.long	.LASF184
+	.value	0x1ea
+	.byte	0
+	.uleb128 0x7
+	.long	.LASF187
+	.byte	0x1
+	.byte	0x1d
+	.byte	0x6
+	.quad	.LFB301
+	.quad	.LFE301-.LFB301
+	.uleb128 0x1
+	.byte	0x9c
+	.byte	0
+	.section	.debug_abbrev,"",@progbits
+.Ldebug_abbrev0:
+	.uleb128 0x1
+	.uleb128 0x28
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x1c
+	.uleb128 0x5
+	.byte	0
+	.byte	0
+	.uleb128 0x2
+	.uleb128 0x24
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0xe
+	.byte	0
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0x28
+	.byte	0
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x1c
+	.uleb128 0xb
+	.byte	0
+	.byte	0
+	.uleb128 0x4
+	.uleb128 0x11
+	.byte	0x1
+	.uleb128 0x25
+	.uleb128 0xe
+	.uleb128 0x13
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x1f
+	.uleb128 0x1b
+	.uleb128 0x1f
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x10
+	.uleb128 0x17
+	.byte	0
+	.byte	0
+	.uleb128 0x5
+	.uleb128 0x24
+	.byte	0
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0x3
+	.uleb128 0x8
+	.byte	0
+	.byte	0
+	.uleb128 0x6
+	.uleb128 0x4
+	.byte	0x1
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3e
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0xb
+	.uleb128 0x49
+	.uleb128 0x13
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x1
+	.uleb128 0x13
+	.byte	0
+	.byte	0
+	.uleb128 0x7
+	.uleb128 0x2e
+	.byte	0
+	.uleb128 0x3f
+	.uleb128 0x19
+	.uleb128 0x3
+	.uleb128 0xe
+	.uleb128 0x3a
+	.uleb128 0xb
+	.uleb128 0x3b
+	.uleb128 0xb
+	.uleb128 0x39
+	.uleb128 0xb
+	.uleb128 0x27
+	.uleb128 0x19
+	.uleb128 0x11
+	.uleb128 0x1
+	.uleb128 0x12
+	.uleb128 0x7
+	.uleb128 0x40
+	.uleb128 0x18
+	.uleb128 0x7a
+	.uleb128 0x19
+	.byte	0
+	.byte	0
+	.byte	0
+	.section	.debug_aranges,"",@progbits
+	.long	0x2c
+	.value	0x2
+	.long	.Ldebug_info0
+	.byte	0x8
+	.byte	0
+	.value	0
+	.value	0
+	.quad	.Ltext0
+	.quad	.Letext0-.Ltext0
+	.quad	0
+	.quad	0
+	.section	.debug_line,"",@progbits
+.Ldebug_line0:
+	.section	.debug_str,"MS",@progbits,1
+.LASF44:
+	.string	"PERFC_shadow_fault_fast_mmio"
+.LASF24:
+	.string	"PERFC_num_page_updates"
+.LASF125:
+	.string	"PERFC_calls_to_multicall"
+.LASF155:
+	.string	"PERFC_load_balance_over"
+.LASF55:
+	.string	"PERFC_shadow_fault_mmio"
+.LASF58:
+	.string	"PERFC_shadow_validate_gl1e_calls"
+.LASF35:
+	.string	"PERFC_shadow_alloc_count"
+.LASF144:
+	.string	"PERFC_vcpu_wake_runnable"
+.LASF80:
+	.string	"PERFC_shadow_mappings_bf"
+.LASF157:
+	.string	"PERFC_steal_trylock_failed"
+.LASF165:
+	.string	"PERFC_migrate_running"
+.LASF139:
+	.string	"PERFC_acct_vcpu_active"
+.LASF10:
+	.string	"PERFC_exceptions"
+.LASF183:
+	.string	"PERFC_flask_grant_av_miss"
+.LASF107:
+	.string	"PERFC_mshv_rdmsr_tpr"
+.LASF49:
+	.string	"PERFC_shadow_fault_emulate_write"
+.LASF122:
+	.string	"PERFC_mem_sharing_hash_grow"
+.LASF135:
+	.string	"PERFC_acct_no_work"
+.LASF174:
+	.string	"PERFC_page_cache_miss"
+.LASF142:
+	.string	"PERFC_vcpu_wake_running"
+.LASF69:
+	.string	"PERFC_shadow_writeable_h_1"
+.LASF70:
+	.string	"PERFC_shadow_writeable_h_2"
+.LASF71:
+	.string	"PERFC_shadow_writeable_h_3"
+.LASF72:
+	.string	"PERFC_shadow_writeable_h_4"
+.LASF73:
+	.string	"PERFC_shadow_writeable_h_5"
+.LASF74:
+	.string	"PERFC_shadow_writeable_h_6"
+.LASF75:
+	.string	"PERFC_shadow_writeable_h_7"
+.LASF76:
+	.string	"PERFC_shadow_writeable_h_8"
+.LASF32:
+	.string	"PERFC_guest_walk"
+.LASF6:
+	.string	"signed char"
+.LASF62:
+	.string	"PERFC_shadow_hash_lookups"
+.LASF102:
+	.string	"PERFC_mshv_call_long_wait"
+.LASF18:
+	.string	"PERFC_seg_fixups"
+.LASF126:
+	.string	"PERFC_calls_from_multicall"
+.LASF124:
+	.string	"PERFC_LAST_hypercalls"
+.LASF27:
+	.string	"PERFC_page_faults"
+.LASF29:
+	.string	"PERFC_map_domain_page_count"
+.LASF9:
+	.string	"long int"
+.LASF112:
+	.string	"PERFC_mshv_wrmsr_tpr"
+.LASF178:
+	.string	"PERFC_scrub_pages_idle"
+.LASF163:
+	.string	"PERFC_steal_remote"
+.LASF119:
+	.string	"PERFC_mem_sharing_unshare"
+.LASF167:
+	.string	"PERFC_dom_destroy"
+.LASF56:
+	.string	"PERFC_shadow_fault_fixed"
+.LASF129:
+	.string	"PERFC_sched_irq"
+.LASF22:
+	.string	"PERFC_num_mmuext_ops"
+.LASF15:
+	.string	"PERFC_LAST_cause_vector"
+.LASF12:
+	.string	"PERFC_vmexits"
+.LASF33:
+	.string	"PERFC_shadow_alloc"
+.LASF179:
+	.string	"PERFC_scrub_pages_demand"
+.LASF105:
+	.string	"PERFC_mshv_rdmsr_vp_index"
+.LASF110:
+	.string	"PERFC_mshv_wrmsr_vp_index"
+.LASF40:
+	.string	"PERFC_shadow_a_update"
+.LASF83:
+	.string	"PERFC_shadow_up_pointer"
+.LASF182:
+	.string	"PERFC_flask_grant_av_hit"
+.LASF37:
+	.string	"PERFC_shadow_prealloc_1"
+.LASF38:
+	.string	"PERFC_shadow_prealloc_2"
+.LASF3:
+	.string	"unsigned int"
+.LASF159:
+	.string	"PERFC_steal_peer_skipped"
+.LASF87:
+	.string	"PERFC_shadow_inconsistent_gwalk"
+.LASF186:
+	.string	"perfcounter"
+.LASF5:
+	.string	"long unsigned int"
+.LASF106:
+	.string	"PERFC_mshv_rdmsr_icr"
+.LASF147:
+	.string	"PERFC_vcpu_unpark"
+.LASF121:
+	.string	"PERFC_mem_sharing_hash_chain"
+.LASF20:
+	.string	"PERFC_domain_page_tlb_flush"
+.LASF11:
+	.string	"PERFC_LAST_exceptions"
+.LASF8:
+	.string	"short unsigned int"
+.LASF99:
+	.string	"PERFC_mshv_call_sw_addr_space"
+.LASF152:
+	.string	"PERFC_tickle_idlers_none"
+.LASF104:
+	.string	"PERFC_mshv_rdmsr_hc_page"
+.LASF21:
+	.string	"PERFC_calls_to_mmuext_op"
+.LASF149:
+	.string	"PERFC_tickle_local_over"
+.LASF98:
+	.string	"PERFC_shadow_resync"
+.LASF67:
+	.string	"PERFC_shadow_hash_deletes"
+.LASF61:
+	.string	"PERFC_shadow_validate_gl4e_calls"
+.LASF143:
+	.string	"PERFC_vcpu_wake_onrunq"
+.LASF54:
+	.string	"PERFC_shadow_fault_fast_emulate_fail"
+.LASF63:
+	.string	"PERFC_shadow_hash_lookup_head"
+.LASF133:
+	.string	"PERFC_schedule"
+.LASF171:
+	.string	"PERFC_need_flush_tlb_flush"
+.LASF7:
+	.string	"short int"
+.LASF109:
+	.string	"PERFC_mshv_wrmsr_hc_page"
+.LASF176:
+	.string	"PERFC_page_cache_drain"
+.LASF111:
+	.string	"PERFC_mshv_wrmsr_icr"
+.LASF103:
+	.string	"PERFC_mshv_rdmsr_osid"
+.LASF100:
+	.string	"PERFC_mshv_call_flush_tlb_list"
+.LASF136:
+	.string	"PERFC_acct_balance"
+.LASF97:
+	.string	"PERFC_shadow_unsync_evict"
+.LASF50:
+	.string	"PERFC_shadow_fault_emulate_failed"
+.LASF79:
+	.string	"PERFC_shadow_mappings"
+.LASF118:
+	.string	"PERFC_mem_sharing_share"
+.LASF151:
+	.string	"PERFC_tickle_local_other"
+.LASF77:
+	.string	"PERFC_shadow_writeable_bf"
+.LASF25:
+	.string	"PERFC_writable_mmu_updates"
+.LASF42:
+	.string	"PERFC_shadow_fault"
+.LASF91:
+	.string	"PERFC_shadow_em_ex_pt"
+.LASF64:
+	.string	"PERFC_shadow_hash_lookup_miss"
+.LASF26:
+	.string	"PERFC_calls_to_update_va"
+.LASF51:
+	.string	"PERFC_shadow_fault_emulate_stack"
+.LASF48:
+	.string	"PERFC_shadow_fault_emulate_read"
+.LASF156:
+	.string	"PERFC_load_balance_other"
+.LASF108:
+	.string	"PERFC_mshv_wrmsr_osid"
+.LASF120:
+	.string	"PERFC_mem_sharing_unshare_retry"
+.LASF131:
+	.string	"PERFC_sched_ctx"
+.LASF173:
+	.string	"PERFC_page_cache_hit"
+.LASF154:
+	.string	"PERFC_load_balance_idle"
+.LASF140:
+	.string	"PERFC_acct_vcpu_idle"
+.LASF123:
+	.string	"PERFC_hypercalls"
+.LASF160:
+	.string	"PERFC_steal_smt"
+.LASF4:
+	.string	"unsigned char"
+.LASF90:
+	.string	"PERFC_shadow_invlpg_fault"
+.LASF175:
+	.string	"PERFC_page_cache_refill"
+.LASF47:
+	.string	"PERFC_shadow_fault_bail_real_fault"
+.LASF89:
+	.string	"PERFC_shadow_invlpg"
+.LASF17:
+	.string	"PERFC_LAST_svmexits"
+.LASF177:
+	.string	"PERFC_scrub_pages_queued"
+.LASF138:
+	.string	"PERFC_acct_min_credit"
+.LASF150:
+	.string	"PERFC_tickle_local_under"
+.LASF162:
+	.string	"PERFC_steal_node"
+.LASF93:
+	.string	"PERFC_shadow_em_ex_fail"
+.LASF141:
+	.string	"PERFC_vcpu_sleep"
+.LASF146:
+	.string	"PERFC_vcpu_park"
+.LASF180:
+	.string	"PERFC_flask_evtchn_av_hit"
+.LASF101:
+	.string	"PERFC_mshv_call_flush_tlb_all"
+.LASF36:
+	.string	"PERFC_shadow_free"
+.LASF114:
+	.string	"PERFC_realmode_emulations"
+.LASF60:
+	.string	"PERFC_shadow_validate_gl3e_calls"
+.LASF172:
+	.string	"PERFC_heap_lock_contended"
+.LASF153:
+	.string	"PERFC_tickle_idlers_some"
+.LASF128:
+	.string	"PERFC_ipis"
+.LASF59:
+	.string	"PERFC_shadow_validate_gl2e_calls"
+.LASF53:
+	.string	"PERFC_shadow_fault_fast_emulate"
+.LASF66:
+	.string	"PERFC_shadow_hash_inserts"
+.LASF96:
+	.string	"PERFC_shadow_unsync"
+.LASF13:
+	.string	"PERFC_LAST_vmexits"
+.LASF30:
+	.string	"PERFC_ptwr_emulations"
+.LASF2:
+	.string	"char"
+.LASF164:
+	.string	"PERFC_migrate_queued"
+.LASF113:
+	.string	"PERFC_mshv_wrmsr_eoi"
+.LASF127:
+	.string	"PERFC_irqs"
+.LASF85:
+	.string	"PERFC_shadow_get_page_fail"
+.LASF28:
+	.string	"PERFC_copy_user_faults"
+.LASF92:
+	.string	"PERFC_shadow_em_ex_non_pt"
+.LASF82:
+	.string	"PERFC_shadow_unshadow"
+.LASF148:
+	.string	"PERFC_tickle_local_idler"
+.LASF16:
+	.string	"PERFC_svmexits"
+.LASF132:
+	.string	"PERFC_vcpu_check"
+.LASF134:
+	.string	"PERFC_acct_run"
+.LASF170:
+	.string	"PERFC_vcpu_hot"
+.LASF181:
+	.string	"PERFC_flask_evtchn_av_miss"
+.LASF81:
+	.string	"PERFC_shadow_early_unshadow"
+.LASF158:
+	.string	"PERFC_steal_peer_idle"
+.LASF68:
+	.string	"PERFC_shadow_writeable"
+.LASF184:
+	.string	"NUM_PERFCOUNTERS"
+.LASF65:
+	.string	"PERFC_shadow_get_shadow_status"
+.LASF78:
+	.string	"PERFC_shadow_writeable_bf_1"
+.LASF185:
+	.string	"GNU C99 12.2.0 -m64 -msoft-float -mno-red-zone -mtune=generic -march=x86-64 -g -O2 -std=gnu99 -fomit-frame-pointer -fno-strict-aliasing -fno-builtin -fno-common -fno-stack-protector -fno-exceptions -fpic -fno-asynchronous-unwind-tables"
+.LASF23:
+	.string	"PERFC_calls_to_mmu_update"
+.LASF52:
+	.string	"PERFC_shadow_fault_emulate_wp"
+.LASF14:
+	.string	"PERFC_cause_vector"
+.LASF116:
+	.string	"PERFC_pauseloop_exits"
+.LASF166:
+	.string	"PERFC_dom_init"
+.LASF169:
+	.string	"PERFC_vcpu_destroy"
+.LASF31:
+	.string	"PERFC_exception_fixed"
+.LASF117:
+	.string	"PERFC_mem_sharing_nominate"
+.LASF86:
+	.string	"PERFC_shadow_check_gwalk"
+.LASF34:
+	.string	"PERFC_shadow_alloc_tlbflush"
+.LASF84:
+	.string	"PERFC_shadow_unshadow_bf"
+.LASF88:
+	.string	"PERFC_shadow_rm_write_flush_tlb"
+.LASF19:
+	.string	"PERFC_apic_timer"
+.LASF115:
+	.string	"PERFC_realmode_exits"
+.LASF41:
+	.string	"PERFC_shadow_ad_update"
+.LASF57:
+	.string	"PERFC_shadow_ptwr_emulate"
+.LASF137:
+	.string	"PERFC_acct_reorder"
+.LASF168:
+	.string	"PERFC_vcpu_init"
+.LASF94:
+	.string	"PERFC_shadow_oos_fixup_add"
+.LASF46:
+	.string	"PERFC_shadow_fault_bail_bad_gfn"
+.LASF43:
+	.string	"PERFC_shadow_fault_fast_gnp"
+.LASF145:
+	.string	"PERFC_vcpu_wake_not_runnable"
+.LASF161:
+	.string	"PERFC_steal_socket"
+.LASF187:
+	.string	"__dummy__"
+.LASF39:
+	.string	"PERFC_shadow_linear_map_failed"
+.LASF95:
+	.string	"PERFC_shadow_oos_fixup_evict"
+.LASF45:
+	.string	"PERFC_shadow_fault_fast_fail"
+.LASF130:
+	.string	"PERFC_sched_run"
+	.section	.debug_line_str,"MS",@progbits,1
+.LASF0:
+	.string	"x86_64/asm-offsets.c"
+.LASF1:
+	.string	"/root/repo/xen/arch/x86"
+	.ident	"GCC: (Debian 12.2.0-14+deb12u1) 12.2.0"
+	.section	.note.GNU-stack,"",@progbits
@@ -113,7 +113,7 @@ void mem_event_put_request(struct domain *d, mem_event_request_t *req)
     notify_via_xen_event_channel(d, d->mem_event.xen_port);
 }
 
-void mem_event_get_response(struct domain *d, mem_event_response_t *rsp)
+int mem_event_get_response(struct domain *d, mem_event_response_t *rsp)
 {
     mem_event_front_ring_t *front_ring;
     RING_IDX rsp_cons;
@@ -123,6 +123,12 @@ void mem_event_get_response(struct domain *d, mem_event_response_t *rsp)
     front_ring = &d->mem_event.front_ring;
     rsp_cons = front_ring->rsp_cons;
 
+    if ( !RING_HAS_UNCONSUMED_RESPONSES(front_ring) )
+    {
+        mem_event_ring_unlock(d);
+        return 0;
+    }
+
     /* Copy response */
     memcpy(rsp, RING_GET_RESPONSE(front_ring, rsp_cons), sizeof(*rsp));
     rsp_cons++;
@@ -132,6 +138,8 @@ void mem_event_get_response(struct domain *d, mem_event_response_t *rsp)
     front_ring->sring->rsp_event = rsp_cons + 1;
 
     mem_event_ring_unlock(d);
+
+    return 1;
 }
 
 void mem_event_unpause_vcpus(struct domain *d)
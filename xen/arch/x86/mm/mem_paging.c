@@ -21,6 +21,9 @@
  */
 
 
+#include <xen/event.h>
+#include <xen/guest_access.h>
+#include <xen/sched.h>
 #include <asm/p2m.h>
 #include <asm/mem_event.h>
 
@@ -60,6 +63,43 @@ int mem_paging_domctl(struct domain *d, xen_domctl_mem_event_op_t *mec,
     }
     break;
 
+    case XEN_DOMCTL_MEM_EVENT_OP_PAGING_RESTORE:
+    {
+        unsigned long gfn = mec->gfn;
+        rc = p2m_mem_paging_restore(d, gfn);
+    }
+    break;
+
+    case XEN_DOMCTL_MEM_EVENT_OP_PAGING_NOMINATE_BATCH:
+    case XEN_DOMCTL_MEM_EVENT_OP_PAGING_EVICT_BATCH:
+    {
+        uint64_t gfn;
+        int err;
+        uint32_t i;
+
+        rc = 0;
+        for ( i = 0; i < mec->nr; i++ )
+        {
+            if ( i && hypercall_preempt_check() )
+                break;
+
+            rc = -EFAULT;
+            if ( copy_from_guest_offset(&gfn, mec->gfns, i, 1) )
+                break;
+
+            if ( mec->op == XEN_DOMCTL_MEM_EVENT_OP_PAGING_NOMINATE_BATCH )
+                err = p2m_mem_paging_nominate(d, gfn);
+            else
+                err = p2m_mem_paging_evict(d, gfn);
+
+            if ( copy_to_guest_offset(mec->errs, i, &err, 1) )
+                break;
+            rc = 0;
+        }
+        mec->nr = i;
+    }
+    break;
+
     default:
         rc = -ENOSYS;
         break;
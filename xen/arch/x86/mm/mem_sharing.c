@@ -30,6 +30,10 @@
 #include <xen/spinlock.h>
 #include <xen/mm.h>
 #include <xen/sched.h>
+#include <xen/xmalloc.h>
+#include <xen/perfc.h>
+#include <xen/event.h>
+#include <xen/guest_access.h>
 
 /* Auditing of memory sharing code? */
 #define MEM_SHARING_AUDIT  0 
@@ -56,6 +60,7 @@ static void mem_sharing_audit(void);
 #define page_to_mfn(_pg) _mfn(__page_to_mfn(_pg))
 
 static shr_handle_t next_handle = 1;
+static DEFINE_SPINLOCK(next_handle_lock);
 static atomic_t nr_saved_mfns = ATOMIC_INIT(0); 
 
 typedef struct shr_hash_entry 
@@ -66,8 +71,30 @@ typedef struct shr_hash_entry
     struct list_head gfns;
 } shr_hash_entry_t;
 
-#define SHR_HASH_LENGTH 1000
-static shr_hash_entry_t *shr_hash[SHR_HASH_LENGTH];
+/*
+ * Handles are hashed into buckets, each with its own lock protecting the
+ * chain and the gfn lists of the entries on it.  The bucket array doubles
+ * (up to a limit) as entries are added, so that chains stay short; the
+ * table lock is only taken for writing while rehashing.
+ * Lock order: table lock, then bucket locks in increasing bucket order.
+ */
+typedef struct shr_bucket
+{
+    spinlock_t lock;
+    shr_hash_entry_t *head;
+} shr_bucket_t;
+
+#define SHR_HASH_INITIAL  1024
+#define SHR_HASH_MAX      (1u << 20)
+
+static struct shr_hash
+{
+    rwlock_t      lock;
+    unsigned int  mask;
+    shr_bucket_t *buckets;
+    atomic_t      nr_entries;
+} shr_hash;
+static shr_bucket_t shr_hash_initial[SHR_HASH_INITIAL];
 
 typedef struct gfn_info
 {
@@ -76,14 +103,6 @@ typedef struct gfn_info
     struct list_head list;
 } gfn_info_t;
 
-typedef struct shr_lock
-{
-    spinlock_t  lock;            /* mem sharing lock */
-    int         locker;          /* processor which holds the lock */
-    const char *locker_function; /* func that took it */
-} shr_lock_t;
-static shr_lock_t shr_lock;
-
 /* Returns true if list has only one entry. O(1) complexity. */
 static inline int list_has_one_entry(struct list_head *head)
 {
@@ -95,45 +114,125 @@ static inline struct gfn_info* gfn_get_info(struct list_head *list)
     return list_entry(list->next, struct gfn_info, list);
 }
 
-#define shr_lock_init(_i)                      \
-    do {                                       \
-        spin_lock_init(&shr_lock.lock);        \
-        shr_lock.locker = -1;                  \
-        shr_lock.locker_function = "nobody";   \
-    } while (0)
-
-#define shr_locked_by_me(_i)                   \
-    (current->processor == shr_lock.locker)
-
-#define shr_lock(_i)                                           \
-    do {                                                       \
-        if ( unlikely(shr_lock.locker == current->processor) ) \
-        {                                                      \
-            printk("Error: shr lock held by %s\n",             \
-                   shr_lock.locker_function);                  \
-            BUG();                                             \
-        }                                                      \
-        spin_lock(&shr_lock.lock);                             \
-        ASSERT(shr_lock.locker == -1);                         \
-        shr_lock.locker = current->processor;                  \
-        shr_lock.locker_function = __func__;                   \
-    } while (0)
-
-#define shr_unlock(_i)                                    \
-    do {                                                  \
-        ASSERT(shr_lock.locker == current->processor);    \
-        shr_lock.locker = -1;                             \
-        shr_lock.locker_function = "nobody";              \
-        spin_unlock(&shr_lock.lock);                      \
-    } while (0)
+static inline shr_bucket_t *shr_bucket(shr_handle_t handle)
+{
+    return &shr_hash.buckets[handle & shr_hash.mask];
+}
+
+/* Lock the bucket of a handle; the table stays locked for reading. */
+static shr_bucket_t *shr_lock(shr_handle_t handle)
+{
+    shr_bucket_t *b;
+
+    read_lock(&shr_hash.lock);
+    b = shr_bucket(handle);
+    spin_lock(&b->lock);
+
+    return b;
+}
+
+static void shr_unlock(shr_bucket_t *b)
+{
+    spin_unlock(&b->lock);
+    read_unlock(&shr_hash.lock);
+}
+
+/* Lock the buckets of two handles, which may share a bucket. */
+static void shr_lock_pair(shr_handle_t h1, shr_handle_t h2,
+                          shr_bucket_t **b1, shr_bucket_t **b2)
+{
+    read_lock(&shr_hash.lock);
+    *b1 = shr_bucket(h1);
+    *b2 = shr_bucket(h2);
+
+    if ( *b1 == *b2 )
+        spin_lock(&(*b1)->lock);
+    else if ( *b1 < *b2 )
+    {
+        spin_lock(&(*b1)->lock);
+        spin_lock(&(*b2)->lock);
+    }
+    else
+    {
+        spin_lock(&(*b2)->lock);
+        spin_lock(&(*b1)->lock);
+    }
+}
+
+static void shr_unlock_pair(shr_bucket_t *b1, shr_bucket_t *b2)
+{
+    if ( b1 != b2 )
+        spin_unlock(&b2->lock);
+    spin_unlock(&b1->lock);
+    read_unlock(&shr_hash.lock);
+}
 
 static void mem_sharing_hash_init(void)
 {
     int i;
 
-    shr_lock_init();
-    for(i=0; i<SHR_HASH_LENGTH; i++)
-        shr_hash[i] = NULL;
+    rwlock_init(&shr_hash.lock);
+    shr_hash.buckets = shr_hash_initial;
+    shr_hash.mask = SHR_HASH_INITIAL - 1;
+    atomic_set(&shr_hash.nr_entries, 0);
+    for(i=0; i<SHR_HASH_INITIAL; i++)
+    {
+        spin_lock_init(&shr_hash_initial[i].lock);
+        shr_hash_initial[i].head = NULL;
+    }
+}
+
+/* Double the bucket array once chains get longer than two entries. */
+static void mem_sharing_hash_grow(void)
+{
+    shr_bucket_t *old, *new;
+    shr_hash_entry_t *e, *next;
+    unsigned int i, size, new_mask;
+
+    size = shr_hash.mask + 1;
+    if ( (atomic_read(&shr_hash.nr_entries) <= 2 * size) ||
+         (size >= SHR_HASH_MAX) )
+        return;
+
+    new = xmalloc_array(shr_bucket_t, 2 * size);
+    if ( new == NULL )
+        return;
+    for ( i = 0; i < 2 * size; i++ )
+    {
+        spin_lock_init(&new[i].lock);
+        new[i].head = NULL;
+    }
+
+    write_lock(&shr_hash.lock);
+
+    /* Someone else may have grown the table meanwhile */
+    if ( shr_hash.mask + 1 != size )
+    {
+        write_unlock(&shr_hash.lock);
+        xfree(new);
+        return;
+    }
+
+    old = shr_hash.buckets;
+    new_mask = 2 * size - 1;
+    for ( i = 0; i < size; i++ )
+    {
+        for ( e = old[i].head; e != NULL; e = next )
+        {
+            next = e->next;
+            e->next = new[e->handle & new_mask].head;
+            new[e->handle & new_mask].head = e;
+        }
+    }
+    shr_hash.buckets = new;
+    shr_hash.mask = new_mask;
+
+    write_unlock(&shr_hash.lock);
+
+    perfc_incr(mem_sharing_hash_grow);
+
+    if ( old != shr_hash_initial )
+        xfree(old);
 }
 
 static shr_hash_entry_t *mem_sharing_hash_alloc(void)
@@ -168,46 +267,46 @@ static void mem_sharing_gfn_destroy(gfn_info_t *gfn, int was_shared)
     xfree(gfn);
 }
 
+/* Must be called with the handle's bucket locked. */
 static shr_hash_entry_t* mem_sharing_hash_lookup(shr_handle_t handle)
 {
     shr_hash_entry_t *e;
     
-    e = shr_hash[handle % SHR_HASH_LENGTH]; 
+    e = shr_bucket(handle)->head;
     while(e != NULL)
     {
         if(e->handle == handle)
             return e;
+        perfc_incr(mem_sharing_hash_chain);
         e = e->next;
     }
 
     return NULL;
 }
 
-static shr_hash_entry_t* mem_sharing_hash_insert(shr_handle_t handle, mfn_t mfn)
+/* Must be called with the handle's bucket locked. */
+static void mem_sharing_hash_insert(shr_hash_entry_t *e)
 {
-    shr_hash_entry_t *e, **ee;
-    
-    e = mem_sharing_hash_alloc();
-    if(e == NULL) return NULL;
-    e->handle = handle;
-    e->mfn = mfn;
-    ee = &shr_hash[handle % SHR_HASH_LENGTH]; 
-    e->next = *ee;
-    *ee = e;
-    return e;
+    shr_bucket_t *b = shr_bucket(e->handle);
+
+    e->next = b->head;
+    b->head = e;
+    atomic_inc(&shr_hash.nr_entries);
 }
 
+/* Must be called with the handle's bucket locked. */
 static void mem_sharing_hash_delete(shr_handle_t handle)
 {
     shr_hash_entry_t **pprev, *e;  
 
-    pprev = &shr_hash[handle % SHR_HASH_LENGTH];
+    pprev = &shr_bucket(handle)->head;
     e = *pprev;
     while(e != NULL)
     {
         if(e->handle == handle)
         {
             *pprev = e->next;
+            atomic_dec(&shr_hash.nr_entries);
             mem_sharing_hash_destroy(e);
             return;
         }
@@ -227,11 +326,11 @@ static void mem_sharing_audit(void)
     int bucket;
     struct page_info *pg;
 
-    shr_lock();
+    write_lock(&shr_hash.lock);
 
-    for(bucket=0; bucket < SHR_HASH_LENGTH; bucket++)
+    for(bucket=0; bucket <= shr_hash.mask; bucket++)
     {
-        e = shr_hash[bucket];    
+        e = shr_hash.buckets[bucket].head;
         /* Loop over all shr_hash_entries */ 
         while(e != NULL)
         {
@@ -288,7 +387,7 @@ static void mem_sharing_audit(void)
         }
     }
 
-    shr_unlock();
+    write_unlock(&shr_hash.lock);
 }
 #endif
 
@@ -343,7 +442,8 @@ int mem_sharing_sharing_resume(struct domain *d)
     mem_event_response_t rsp;
 
     /* Get request off the ring */
-    mem_event_get_response(d, &rsp);
+    if ( !mem_event_get_response(d, &rsp) )
+        return 0;
 
     /* Unpause domain/vcpu */
     if( rsp.flags & MEM_EVENT_FLAG_VCPU_PAUSED )
@@ -460,7 +560,6 @@ static int mem_sharing_gfn_account(struct gfn_info *gfn, int sharing)
 
         return 1;
     }
-    mem_sharing_audit();
 
     return 0;
 }
@@ -502,6 +601,7 @@ int mem_sharing_nominate_page(struct domain *d,
     shr_handle_t handle;
     shr_hash_entry_t *hash_entry;
     struct gfn_info *gfn_info;
+    shr_bucket_t *b;
 
     *phandle = 0UL;
 
@@ -524,20 +624,24 @@ int mem_sharing_nominate_page(struct domain *d,
 
     /* Create the handle */
     ret = -ENOMEM;
-    shr_lock(); 
-    handle = next_handle++;  
-    if((hash_entry = mem_sharing_hash_insert(handle, mfn)) == NULL)
+    hash_entry = mem_sharing_hash_alloc();
+    gfn_info = mem_sharing_gfn_alloc();
+    if((hash_entry == NULL) || (gfn_info == NULL))
     {
-        shr_unlock();
-        goto out;
-    }
-    if((gfn_info = mem_sharing_gfn_alloc()) == NULL)
-    {
-        mem_sharing_hash_destroy(hash_entry);
-        shr_unlock();
+        if(hash_entry)
+            mem_sharing_hash_destroy(hash_entry);
+        if(gfn_info)
+            mem_sharing_gfn_destroy(gfn_info, 0);
+        BUG_ON(page_make_private(d, page) != 0);
         goto out;
     }
 
+    spin_lock(&next_handle_lock);
+    handle = next_handle++;
+    spin_unlock(&next_handle_lock);
+
+    b = shr_lock(handle);
+
     /* Change the p2m type */
     if(p2m_change_type(d, gfn, p2mt, p2m_ram_shared) != p2mt) 
     {
@@ -548,21 +652,27 @@ int mem_sharing_nominate_page(struct domain *d,
         BUG_ON(page_make_private(d, page) != 0);
         mem_sharing_hash_destroy(hash_entry);
         mem_sharing_gfn_destroy(gfn_info, 0);
-        shr_unlock();
+        shr_unlock(b);
         goto out;
     }
 
     /* Update m2p entry to SHARED_M2P_ENTRY */
     set_gpfn_from_mfn(mfn_x(mfn), SHARED_M2P_ENTRY);
 
+    hash_entry->handle = handle;
+    hash_entry->mfn = mfn;
     INIT_LIST_HEAD(&hash_entry->gfns);
     INIT_LIST_HEAD(&gfn_info->list);
     list_add(&gfn_info->list, &hash_entry->gfns);
     gfn_info->gfn = gfn;
     gfn_info->domain = d->domain_id;
     page->shr_handle = handle;
+    mem_sharing_hash_insert(hash_entry);
     *phandle = handle;
-    shr_unlock();
+    shr_unlock(b);
+
+    perfc_incr(mem_sharing_nominate);
+    mem_sharing_hash_grow();
 
     ret = 0;
 
@@ -577,9 +687,14 @@ int mem_sharing_share_pages(shr_handle_t sh, shr_handle_t ch)
     struct list_head *le, *te;
     struct gfn_info *gfn;
     struct domain *d;
+    shr_bucket_t *sb, *cb;
     int ret;
 
-    shr_lock();
+    /* Sharing a page with itself would empty its gfn list */
+    if(sh == ch)
+        return XEN_DOMCTL_MEM_SHARING_C_HANDLE_INVALID;
+
+    shr_lock_pair(sh, ch, &sb, &cb);
 
     ret = XEN_DOMCTL_MEM_SHARING_S_HANDLE_INVALID;
     se = mem_sharing_hash_lookup(sh);
@@ -596,7 +711,7 @@ int mem_sharing_share_pages(shr_handle_t sh, shr_handle_t ch)
     {
         gfn = list_entry(le, struct gfn_info, list);
         /* Get the source page and type, this should never fail 
-         * because we are under shr lock, and got non-null se */
+         * because we hold the bucket lock, and got non-null se */
         BUG_ON(!get_page_and_type(spage, dom_cow, PGT_shared_page));
         /* Move the gfn_info from ce list to se list */
         list_del(&gfn->list);
@@ -613,10 +728,11 @@ int mem_sharing_share_pages(shr_handle_t sh, shr_handle_t ch)
     /* Free the client page */
     if(test_and_clear_bit(_PGC_allocated, &cpage->count_info))
         put_page(cpage);
+    perfc_incr(mem_sharing_share);
     ret = 0;
     
 err_out:
-    shr_unlock();
+    shr_unlock_pair(sb, cb);
 
     return ret;
 }
@@ -634,16 +750,30 @@ int mem_sharing_unshare_page(struct domain *d,
     struct gfn_info *gfn_info = NULL;
     shr_handle_t handle;
     struct list_head *le;
+    shr_bucket_t *b;
 
+    mem_sharing_audit();
+
+ again:
     mfn = gfn_to_mfn(d, gfn, &p2mt);
 
+    /* Another vcpu may have unshared it already */
+    if(!p2m_is_shared(p2mt))
+        return 0;
+
     page = mfn_to_page(mfn);
     handle = page->shr_handle;
  
-    mem_sharing_audit();
     /* Remove the gfn_info from the list */
-    shr_lock();
+    b = shr_lock(handle);
     hash_entry = mem_sharing_hash_lookup(handle); 
+    if((hash_entry == NULL) || (mfn_x(hash_entry->mfn) != mfn_x(mfn)))
+    {
+        /* The gfn was moved to another page by a concurrent share */
+        shr_unlock(b);
+        perfc_incr(mem_sharing_unshare_retry);
+        goto again;
+    }
     list_for_each(le, &hash_entry->gfns)
     {
         gfn_info = list_entry(le, struct gfn_info, list);
@@ -669,7 +799,7 @@ gfn_found:
             /* Even though we don't allocate a private page, we have to account
              * for the MFN that originally backed this PFN. */
             atomic_dec(&nr_saved_mfns);
-        shr_unlock();
+        shr_unlock(b);
         put_page_and_type(page);
         if(last_gfn && 
            test_and_clear_bit(_PGC_allocated, &page->count_info)) 
@@ -689,7 +819,7 @@ gfn_found:
         /* We've failed to obtain memory for private page. Need to re-add the
          * gfn_info to relevant list */
         list_add(&gfn_info->list, &hash_entry->gfns);
-        shr_unlock();
+        shr_unlock(b);
         return -ENOMEM;
     }
 
@@ -709,7 +839,9 @@ private_page_found:
         mem_sharing_hash_delete(handle);
     else
         atomic_dec(&nr_saved_mfns);
-    shr_unlock();
+    shr_unlock(b);
+
+    perfc_incr(mem_sharing_unshare);
 
     if(p2m_change_type(d, gfn, p2m_ram_shared, p2m_ram_rw) != 
                                                 p2m_ram_shared) 
@@ -723,6 +855,59 @@ private_page_found:
     return 0;
 }
 
+static int mem_sharing_batch(xen_domctl_mem_sharing_op_t *mec)
+{
+    xen_mem_sharing_batch_entry_t e;
+    struct domain *d = NULL;
+    shr_handle_t handle;
+    uint32_t i;
+    int rc = 0;
+
+    for ( i = 0; i < mec->u.batch.nr; i++ )
+    {
+        if ( i && hypercall_preempt_check() )
+            break;
+
+        rc = -EFAULT;
+        if ( copy_from_guest_offset(&e, mec->u.batch.entries, i, 1) )
+            break;
+
+        if ( mec->op == XEN_DOMCTL_MEM_SHARING_OP_NOMINATE_GFN_BATCH )
+        {
+            /* entries for the same domain tend to come together */
+            if ( (d == NULL) || (d->domain_id != e.u.nominate.domain) )
+            {
+                if ( d != NULL )
+                    rcu_unlock_domain(d);
+                d = rcu_lock_domain_by_id(e.u.nominate.domain);
+            }
+            if ( d == NULL )
+                e.rc = -ESRCH;
+            else if ( !mem_sharing_enabled(d) )
+                e.rc = -EINVAL;
+            else
+            {
+                e.rc = mem_sharing_nominate_page(d, e.u.nominate.gfn, 0,
+                                                 &handle);
+                e.u.nominate.handle = handle;
+            }
+        }
+        else
+            e.rc = mem_sharing_share_pages(e.u.share.source_handle,
+                                           e.u.share.client_handle);
+
+        if ( copy_to_guest_offset(mec->u.batch.entries, i, &e, 1) )
+            break;
+        rc = 0;
+    }
+    if ( d != NULL )
+        rcu_unlock_domain(d);
+    mec->u.batch.nr = i;
+    mem_sharing_audit();
+
+    return rc;
+}
+
 int mem_sharing_domctl(struct domain *d, xen_domctl_mem_sharing_op_t *mec)
 {
     int rc;
@@ -807,6 +992,11 @@ int mem_sharing_domctl(struct domain *d, xen_domctl_mem_sharing_op_t *mec)
         }
         break;
 
+        case XEN_DOMCTL_MEM_SHARING_OP_NOMINATE_GFN_BATCH:
+        case XEN_DOMCTL_MEM_SHARING_OP_SHARE_BATCH:
+            rc = mem_sharing_batch(mec);
+            break;
+
         default:
             rc = -ENOSYS;
             break;
@@ -109,6 +109,8 @@ static void audit_p2m(struct domain *d);
 # define audit_p2m(_d) do { (void)(_d); } while(0)
 #endif /* P2M_AUDIT */
 
+static void p2m_pod_reclaim_kick(struct domain *d);
+
 // Find the next level's P2M entry, checking for out-of-range gfn's...
 // Returns NULL on error.
 //
@@ -539,6 +541,8 @@ p2m_pod_set_mem_target(struct domain *d, unsigned long target)
 
     ret = p2m_pod_set_cache_target(d, pod_target);
 
+    p2m_pod_reclaim_kick(d);
+
 out:
     p2m_unlock(p2md);
 
@@ -555,6 +559,8 @@ p2m_pod_empty_cache(struct domain *d)
     BUG_ON(!d->is_dying);
     spin_barrier(&p2md->lock);
 
+    kill_timer(&p2md->pod.reclaim_timer);
+
     spin_lock(&d->page_alloc_lock);
 
     while ( (page = page_list_remove_head(&p2md->pod.super)) )
@@ -722,6 +728,21 @@ p2m_pod_dump_data(struct domain *d)
 }
 
 
+/* Returns 1 if the page is all zeroes.  Eight words are ORed together
+ * per iteration, leaving one branch per cache line. */
+static inline int
+p2m_pod_page_is_zero(const unsigned long *map)
+{
+    unsigned int i;
+
+    for ( i = 0; i < PAGE_SIZE / sizeof(*map); i += 8 )
+        if ( map[i]   | map[i+1] | map[i+2] | map[i+3] |
+             map[i+4] | map[i+5] | map[i+6] | map[i+7] )
+            return 0;
+
+    return 1;
+}
+
 /* Search for all-zero superpages to be reclaimed as superpages for the
  * PoD cache. Must be called w/ p2m lock held, page_alloc lock not held. */
 static int
@@ -816,12 +837,8 @@ p2m_pod_zero_check_superpage(struct domain *d, unsigned long gfn)
     {
         map = map_domain_page(mfn_x(mfn0) + i);
 
-        for ( j=0; j<PAGE_SIZE/sizeof(*map); j++ )
-            if( *(map+j) != 0 )
-            {
-                reset = 1;
-                break;
-            }
+        if ( !p2m_pod_page_is_zero(map) )
+            reset = 1;
 
         unmap_domain_page(map);
 
@@ -929,15 +946,13 @@ p2m_pod_zero_check(struct domain *d, unsigned long *gfns, int count)
         if(!map[i])
             continue;
 
-        for ( j=0; j<PAGE_SIZE/sizeof(*map[i]); j++ )
-            if( *(map[i]+j) != 0 )
-                break;
+        j = p2m_pod_page_is_zero(map[i]);
 
         unmap_domain_page(map[i]);
 
         /* See comment in p2m_pod_zero_check_superpage() re gnttab
          * check timing.  */
-        if ( j < PAGE_SIZE/sizeof(*map[i]) )
+        if ( !j )
         {
             set_p2m_entry(d, gfns[i], mfns[i], 0, types[i]);
         }
@@ -967,6 +982,54 @@ p2m_pod_zero_check(struct domain *d, unsigned long *gfns, int count)
 }
 
 #define POD_SWEEP_LIMIT 1024
+#define POD_SWEEP_STRIDE  16
+
+/* Flags a superpage in the recently-populated ring */
+#define POD_MRP_SUPER   (1UL << (BITS_PER_LONG - 1))
+
+static void
+p2m_pod_record_populated(struct domain *d, unsigned long gfn,
+                         unsigned int order)
+{
+    struct p2m_domain *p2md = d->arch.p2m;
+
+    p2md->pod.mrp[p2md->pod.mrp_idx] = gfn | (order == 9 ? POD_MRP_SUPER : 0);
+    p2md->pod.mrp_idx = (p2md->pod.mrp_idx + 1) % POD_HISTORY_MAX;
+}
+
+/* Zero-check the recently populated gfns.  Each is only checked once. */
+static void
+p2m_pod_sweep_recent(struct domain *d)
+{
+    struct p2m_domain *p2md = d->arch.p2m;
+    unsigned long gfns[POD_SWEEP_STRIDE], gfn;
+    unsigned int i, j = 0;
+
+    for ( i = 0; i < POD_HISTORY_MAX; i++ )
+    {
+        gfn = p2md->pod.mrp[i];
+        if ( gfn == INVALID_GFN )
+            continue;
+        p2md->pod.mrp[i] = INVALID_GFN;
+
+        if ( gfn & POD_MRP_SUPER )
+        {
+            p2m_pod_zero_check_superpage(d, gfn & ~POD_MRP_SUPER);
+            continue;
+        }
+
+        gfns[j++] = gfn;
+        if ( j == POD_SWEEP_STRIDE )
+        {
+            p2m_pod_zero_check(d, gfns, j);
+            j = 0;
+        }
+    }
+
+    if ( j )
+        p2m_pod_zero_check(d, gfns, j);
+}
+
 static void
 p2m_pod_emergency_sweep_super(struct domain *d)
 {
@@ -998,7 +1061,6 @@ p2m_pod_emergency_sweep_super(struct domain *d)
 
 }
 
-#define POD_SWEEP_STRIDE  16
 static void
 p2m_pod_emergency_sweep(struct domain *d)
 {
@@ -1045,6 +1107,49 @@ p2m_pod_emergency_sweep(struct domain *d)
 
 }
 
+/* Background refill: while the guest still has outstanding PoD entries,
+ * periodically reclaim zeroed recently populated pages so the cache stays
+ * above a low watermark and faults rarely need an emergency sweep. */
+#define POD_RECLAIM_PERIOD  MILLISECS(100)
+#define POD_RECLAIM_LOW     512
+
+static int
+p2m_pod_reclaim_wanted(struct domain *d)
+{
+    struct p2m_domain *p2md = d->arch.p2m;
+    int low = min(POD_RECLAIM_LOW, p2md->pod.entry_count);
+
+    return !d->is_dying && (p2md->pod.count < low);
+}
+
+static void
+p2m_pod_reclaim_kick(struct domain *d)
+{
+    struct p2m_domain *p2md = d->arch.p2m;
+
+    if ( p2m_pod_reclaim_wanted(d) && !active_timer(&p2md->pod.reclaim_timer) )
+        set_timer(&p2md->pod.reclaim_timer, NOW() + POD_RECLAIM_PERIOD);
+}
+
+static void
+p2m_pod_reclaim_timer_fn(void *data)
+{
+    struct domain *d = data;
+    struct p2m_domain *p2md = d->arch.p2m;
+
+    p2m_lock(p2md);
+
+    if ( p2m_pod_reclaim_wanted(d) )
+    {
+        p2m_pod_sweep_recent(d);
+        /* Keep going while the guest keeps populating */
+        if ( p2m_pod_reclaim_wanted(d) )
+            set_timer(&p2md->pod.reclaim_timer, NOW() + POD_RECLAIM_PERIOD);
+    }
+
+    p2m_unlock(p2md);
+}
+
 int
 p2m_pod_demand_populate(struct domain *d, unsigned long gfn,
                         unsigned int order,
@@ -1064,7 +1169,12 @@ p2m_pod_demand_populate(struct domain *d, unsigned long gfn,
     if ( unlikely(d->is_dying) )
         goto out_fail;
 
-    /* If we're low, start a sweep */
+    /* If we're low, try the recently populated pages first, and only
+     * start a linear sweep if that doesn't turn up enough */
+    if ( (order == 9 && page_list_empty(&p2md->pod.super))
+         || (order == 0 && page_list_empty(&p2md->pod.single)) )
+        p2m_pod_sweep_recent(d);
+
     if ( order == 9 && page_list_empty(&p2md->pod.super) )
         p2m_pod_emergency_sweep_super(d);
 
@@ -1103,6 +1213,9 @@ p2m_pod_demand_populate(struct domain *d, unsigned long gfn,
     p2md->pod.entry_count -= (1 << order); /* Lock: p2m */
     BUG_ON(p2md->pod.entry_count < 0);
 
+    p2m_pod_record_populated(d, gfn_aligned, order);
+    p2m_pod_reclaim_kick(d);
+
     if ( tb_init_done )
     {
         struct {
@@ -1563,6 +1676,8 @@ int p2m_init(struct domain *d)
     INIT_PAGE_LIST_HEAD(&p2m->pages);
     INIT_PAGE_LIST_HEAD(&p2m->pod.super);
     INIT_PAGE_LIST_HEAD(&p2m->pod.single);
+    memset(p2m->pod.mrp, 0xff, sizeof(p2m->pod.mrp)); /* INVALID_GFN */
+    init_timer(&p2m->pod.reclaim_timer, p2m_pod_reclaim_timer_fn, d, 0);
 
     p2m->set_entry = p2m_set_entry;
     p2m->get_entry = p2m_gfn_to_mfn;
@@ -1742,6 +1857,8 @@ void p2m_teardown(struct domain *d)
 
 void p2m_final_teardown(struct domain *d)
 {
+    if ( d->arch.p2m )
+        kill_timer(&d->arch.p2m->pod.reclaim_timer);
     xfree(d->arch.p2m);
     d->arch.p2m = NULL;
 }
@@ -2461,6 +2578,16 @@ set_shared_p2m_entry(struct domain *d, unsigned long gfn, mfn_t mfn)
     return rc;
 }
 
+/*
+ * Type of a frame once it has been paged back in.  While log-dirty mode is
+ * on, the frame is write-protected again so that guest writes to it are
+ * still logged.
+ */
+static p2m_type_t p2m_paged_in_type(struct domain *d)
+{
+    return paging_mode_log_dirty(d) ? p2m_ram_logdirty : p2m_ram_rw;
+}
+
 int p2m_mem_paging_nominate(struct domain *d, unsigned long gfn)
 {
     struct page_info *page;
@@ -2555,7 +2682,7 @@ void p2m_mem_paging_populate(struct domain *d, unsigned long gfn)
     /* XXX: It seems inefficient to have this here, as it's only needed
      *      in one case (ept guest accessing paging out page) */
     gfn_to_mfn(d, gfn, &p2mt);
-    if ( p2mt != p2m_ram_paging_out )
+    if ( (p2mt != p2m_ram_paging_out) && (p2mt != p2m_ram_paging_in) )
     {
         p2m_lock(d->arch.p2m);
         set_p2m_entry(d, gfn, _mfn(PAGING_MFN), 0, p2m_ram_paging_in_start);
@@ -2594,24 +2721,45 @@ int p2m_mem_paging_prep(struct domain *d, unsigned long gfn)
     return 0;
 }
 
-void p2m_mem_paging_resume(struct domain *d)
+int p2m_mem_paging_restore(struct domain *d, unsigned long gfn)
 {
-    mem_event_response_t rsp;
     p2m_type_t p2mt;
     mfn_t mfn;
 
-    /* Pull the response off the ring */
-    mem_event_get_response(d, &rsp);
+    /* Only frames the pager has prepared and filled */
+    mfn = gfn_to_mfn(d, gfn, &p2mt);
+    if ( p2mt != p2m_ram_paging_in )
+        return -EINVAL;
 
-    /* Fix p2m entry */
-    mfn = gfn_to_mfn(d, rsp.gfn, &p2mt);
     p2m_lock(d->arch.p2m);
-    set_p2m_entry(d, rsp.gfn, mfn, 0, p2m_ram_rw);
+    set_p2m_entry(d, gfn, mfn, 0, p2m_paged_in_type(d));
     p2m_unlock(d->arch.p2m);
 
-    /* Unpause domain */
-    if ( rsp.flags & MEM_EVENT_FLAG_VCPU_PAUSED )
-        vcpu_unpause(d->vcpu[rsp.vcpu_id]);
+    return 0;
+}
+
+void p2m_mem_paging_resume(struct domain *d)
+{
+    mem_event_response_t rsp;
+    p2m_type_t p2mt;
+    mfn_t mfn;
+
+    /*
+     * Pull all pending responses off the ring, so that a pager may post a
+     * batch of them and resume once.
+     */
+    while ( mem_event_get_response(d, &rsp) )
+    {
+        /* Fix p2m entry */
+        mfn = gfn_to_mfn(d, rsp.gfn, &p2mt);
+        p2m_lock(d->arch.p2m);
+        set_p2m_entry(d, rsp.gfn, mfn, 0, p2m_paged_in_type(d));
+        p2m_unlock(d->arch.p2m);
+
+        /* Unpause domain */
+        if ( rsp.flags & MEM_EVENT_FLAG_VCPU_PAUSED )
+            vcpu_unpause(d->vcpu[rsp.vcpu_id]);
+    }
 
     /* Unpause any domains that were paused because the ring was full */
     mem_event_unpause_vcpus(d);
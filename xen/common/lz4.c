@@ -0,0 +1,231 @@
+/*
+ *  lz4.c -- LZ4 block format compressor and decompressor
+ *
+ *  A sequence is a token byte (literal run length in the high nibble,
+ *  match length - 4 in the low nibble), optional extra length bytes for
+ *  the literal run, the literals, a 16-bit little endian match offset and
+ *  optional extra length bytes for the match.  The final sequence has
+ *  literals only; the last 5 bytes of input are always literals and no
+ *  match starts within the last 12.
+ */
+
+#include <xen/types.h>
+#include <xen/string.h>
+#include <xen/lz4.h>
+
+#define MINMATCH        4
+#define MFLIMIT         12
+#define LASTLITERALS    5
+#define MAX_DISTANCE    0xffff
+
+#define ML_BITS         4
+#define ML_MASK         ((1U << ML_BITS) - 1)
+#define RUN_MASK        ((1U << (8 - ML_BITS)) - 1)
+
+/* after 2^SKIP_TRIGGER failed probes, start stepping over input faster */
+#define SKIP_TRIGGER    6
+
+static inline u32 read32(const unsigned char *p)
+{
+    u32 v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline u64 read64(const unsigned char *p)
+{
+    u64 v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline u32 lz4_hash(u32 v)
+{
+    return (v * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+static inline unsigned char *put_length(unsigned char *op, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = len;
+    return op;
+}
+
+int lz4_compress(const unsigned char *in, size_t in_len, unsigned char *out,
+                 size_t *out_len, void *wrkmem)
+{
+    u16 *table = wrkmem;
+    const unsigned char *ip = in, *anchor = in;
+    const unsigned char *const in_end = in + in_len;
+    const unsigned char *const mflimit = in_end - MFLIMIT;
+    const unsigned char *const match_limit = in_end - LASTLITERALS;
+    unsigned char *op = out, *token;
+    size_t lit, len;
+
+    if (unlikely(in_len > LZ4_MAX_INPUT_SIZE))
+        return LZ4_E_ERROR;
+    if (unlikely(in_len < MFLIMIT + 1))
+        goto last_literals;
+
+    memset(table, 0, LZ4_MEM_COMPRESS);
+    table[lz4_hash(read32(ip))] = 0;
+    ip++;
+
+    for (;;) {
+        const unsigned char *ref, *fwd = ip;
+        size_t step = 1, probes = 1 << SKIP_TRIGGER;
+        u32 h;
+
+        /* find a match */
+        do {
+            ip = fwd;
+            fwd = ip + step;
+            step = probes++ >> SKIP_TRIGGER;
+            if (unlikely(fwd > mflimit))
+                goto last_literals;
+            h = lz4_hash(read32(ip));
+            ref = in + table[h];
+            table[h] = ip - in;
+        } while (ref + MAX_DISTANCE < ip || read32(ref) != read32(ip));
+
+        /* extend the match backwards over pending literals */
+        while (ip > anchor && ref > in && ip[-1] == ref[-1]) {
+            ip--;
+            ref--;
+        }
+
+        /* literal run */
+        lit = ip - anchor;
+        token = op++;
+        if (lit >= RUN_MASK) {
+            *token = RUN_MASK << ML_BITS;
+            op = put_length(op, lit - RUN_MASK);
+        } else {
+            *token = lit << ML_BITS;
+        }
+        memcpy(op, anchor, lit);
+        op += lit;
+
+        /* offset */
+        *op++ = (ip - ref) & 0xff;
+        *op++ = (ip - ref) >> 8;
+
+        /* match length, a word at a time where possible */
+        ip += MINMATCH;
+        ref += MINMATCH;
+        anchor = ip;
+        while (ip + sizeof(u64) <= match_limit && read64(ip) == read64(ref)) {
+            ip += sizeof(u64);
+            ref += sizeof(u64);
+        }
+        while (ip < match_limit && *ip == *ref) {
+            ip++;
+            ref++;
+        }
+        len = ip - anchor;
+        if (len >= ML_MASK) {
+            *token += ML_MASK;
+            op = put_length(op, len - ML_MASK);
+        } else {
+            *token += len;
+        }
+        anchor = ip;
+
+        if (ip > mflimit)
+            break;
+        table[lz4_hash(read32(ip - 2))] = ip - 2 - in;
+    }
+
+last_literals:
+    lit = in_end - anchor;
+    if (lit >= RUN_MASK) {
+        *op++ = RUN_MASK << ML_BITS;
+        op = put_length(op, lit - RUN_MASK);
+    } else {
+        *op++ = lit << ML_BITS;
+    }
+    memcpy(op, anchor, lit);
+    op += lit;
+
+    *out_len = op - out;
+    return LZ4_E_OK;
+}
+
+int lz4_decompress_safe(const unsigned char *in, size_t in_len,
+                        unsigned char *out, size_t *out_len)
+{
+    const unsigned char *ip = in;
+    const unsigned char *const ip_end = in + in_len;
+    unsigned char *op = out;
+    unsigned char *const op_end = out + *out_len;
+
+    for (;;) {
+        const unsigned char *ref;
+        unsigned int token, s;
+        size_t len, off;
+
+        if (unlikely(ip >= ip_end))
+            return LZ4_E_INPUT_OVERRUN;
+        token = *ip++;
+
+        /* literal run */
+        len = token >> ML_BITS;
+        if (len == RUN_MASK) {
+            do {
+                if (unlikely(ip >= ip_end))
+                    return LZ4_E_INPUT_OVERRUN;
+                s = *ip++;
+                len += s;
+            } while (s == 255);
+        }
+        if (unlikely(len > (size_t)(ip_end - ip)))
+            return LZ4_E_INPUT_OVERRUN;
+        if (unlikely(len > (size_t)(op_end - op)))
+            return LZ4_E_OUTPUT_OVERRUN;
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+
+        /* the last sequence has no match */
+        if (ip == ip_end)
+            break;
+
+        if (unlikely(ip_end - ip < 2))
+            return LZ4_E_INPUT_OVERRUN;
+        off = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (unlikely(off == 0 || off > (size_t)(op - out)))
+            return LZ4_E_LOOKBEHIND_OVERRUN;
+        ref = op - off;
+
+        len = token & ML_MASK;
+        if (len == ML_MASK) {
+            do {
+                if (unlikely(ip >= ip_end))
+                    return LZ4_E_INPUT_OVERRUN;
+                s = *ip++;
+                len += s;
+            } while (s == 255);
+        }
+        len += MINMATCH;
+        if (unlikely(len > (size_t)(op_end - op)))
+            return LZ4_E_OUTPUT_OVERRUN;
+
+        /* the match may overlap its own output */
+        if (off >= sizeof(u64)) {
+            for (; len >= sizeof(u64); len -= sizeof(u64)) {
+                memcpy(op, ref, sizeof(u64));
+                op += sizeof(u64);
+                ref += sizeof(u64);
+            }
+        }
+        while (len--)
+            *op++ = *ref++;
+    }
+
+    *out_len = op - out;
+    return LZ4_E_OK;
+}
@@ -54,6 +54,13 @@ string_param("badpage", opt_badpage);
 static int opt_bootscrub __initdata = 1;
 boolean_param("bootscrub", opt_bootscrub);
 
+/*
+ * Keep small per-CPU caches of free domheap pages in front of the buddy
+ * allocator?
+ */
+static int opt_page_cache __initdata = 1;
+boolean_param("page_cache", opt_page_cache);
+
 /*
  * Bit width of the DMA heap -- used to override NUMA-node-first.
  * allocation strategy, which can otherwise exhaust low memory.
@@ -292,15 +299,98 @@ static unsigned long init_node_heap(int node, unsigned long mfn,
     return needed;
 }
 
+/* Take heap_lock, counting how often it is found already held. */
+static void lock_heap(void)
+{
+    if ( !spin_trylock(&heap_lock) )
+    {
+        perfc_incr(heap_lock_contended);
+        spin_lock(&heap_lock);
+    }
+}
+
+/* Add the CPUs which must flush their TLBs before @pg is reused to @mask. */
+static void page_tlbflush_mask(const struct page_info *pg, cpumask_t *mask)
+{
+    cpumask_t extra_cpus_mask;
+
+    if ( !pg->u.free.need_tlbflush )
+        return;
+
+    cpus_andnot(extra_cpus_mask, cpu_online_map, *mask);
+    tlbflush_filter(extra_cpus_mask, pg->tlbflush_timestamp);
+    cpus_or(*mask, *mask, extra_cpus_mask);
+}
+
+/*
+ * Take 2^@order contiguous pages from @node's free lists, accumulating the
+ * CPUs which need a TLB flush in @mask.  Caller must hold heap_lock.
+ */
+static struct page_info *take_heap_pages(
+    unsigned int zone_lo, unsigned int zone_hi,
+    unsigned int node, unsigned int order, cpumask_t *mask)
+{
+    unsigned int i, j, zone = zone_hi;
+    unsigned long request = 1UL << order;
+    struct page_info *pg;
+
+    ASSERT(spin_is_locked(&heap_lock));
+
+    if ( !avail[node] || (zone_lo > zone_hi) )
+        return NULL;
+
+    do {
+        /* Check if target node can support the allocation. */
+        if ( avail[node][zone] < request )
+            continue;
+
+        /* Find smallest order which can satisfy the request. */
+        for ( j = order; j <= MAX_ORDER; j++ )
+            if ( (pg = page_list_remove_head(&heap(node, zone, j))) )
+                goto found;
+    } while ( zone-- > zone_lo ); /* careful: unsigned zone may wrap */
+
+    return NULL;
+
+ found: 
+    /* We may have to halve the chunk a number of times. */
+    while ( j != order )
+    {
+        PFN_ORDER(pg) = --j;
+        page_list_add_tail(pg, &heap(node, zone, j));
+        pg += 1 << j;
+    }
+
+    ASSERT(avail[node][zone] >= request);
+    avail[node][zone] -= request;
+    total_avail_pages -= request;
+    ASSERT(total_avail_pages >= 0);
+
+    for ( i = 0; i < (1 << order); i++ )
+    {
+        /* Reference count must continuously be zero for free pages. */
+        BUG_ON(pg[i].count_info != PGC_state_free);
+        pg[i].count_info = PGC_state_inuse;
+
+        /* Add in extra CPUs that need flushing because of this page. */
+        page_tlbflush_mask(&pg[i], mask);
+
+        /* Initialise fields which have other uses for free pages. */
+        pg[i].u.inuse.type_info = 0;
+        page_set_owner(&pg[i], NULL);
+    }
+
+    return pg;
+}
+
 /* Allocate 2^@order contiguous pages. */
 static struct page_info *alloc_heap_pages(
     unsigned int zone_lo, unsigned int zone_hi,
     unsigned int node, unsigned int order, unsigned int memflags)
 {
-    unsigned int i, j, zone = 0;
+    unsigned int i;
     unsigned int num_nodes = num_online_nodes();
-    unsigned long request = 1UL << order;
-    cpumask_t extra_cpus_mask, mask;
+    cpumask_t mask;
     struct page_info *pg;
 
     if ( node == NUMA_NO_NODE )
@@ -313,7 +403,7 @@ static struct page_info *alloc_heap_pages(
     if ( unlikely(order > MAX_ORDER) )
         return NULL;
 
-    spin_lock(&heap_lock);
+    lock_heap();
 
     /*
      * TMEM: When available memory is scarce due to tmem absorbing it, allow
@@ -326,6 +416,8 @@ static struct page_info *alloc_heap_pages(
          tmem_freeable_pages() )
         goto try_tmem;
 
+    cpus_clear(mask);
+
     /*
      * Start with requested node, but exhaust all node memory in requested 
      * zone before failing, only calc new node value if we fail to find memory 
@@ -333,17 +425,8 @@ static struct page_info *alloc_heap_pages(
      */
     for ( i = 0; i < num_nodes; i++ )
     {
-        zone = zone_hi;
-        do {
-            /* Check if target node can support the allocation. */
-            if ( !avail[node] || (avail[node][zone] < request) )
-                continue;
-
-            /* Find smallest order which can satisfy the request. */
-            for ( j = order; j <= MAX_ORDER; j++ )
-                if ( (pg = page_list_remove_head(&heap(node, zone, j))) )
-                    goto found;
-        } while ( zone-- > zone_lo ); /* careful: unsigned zone may wrap */
+        if ( (pg = take_heap_pages(zone_lo, zone_hi, node, order, &mask)) )
+            goto found;
 
         /* Pick next node, wrapping around if needed. */
         node = next_node(node, node_online_map);
@@ -365,40 +448,6 @@ static struct page_info *alloc_heap_pages(
     return NULL;
 
  found: 
-    /* We may have to halve the chunk a number of times. */
-    while ( j != order )
-    {
-        PFN_ORDER(pg) = --j;
-        page_list_add_tail(pg, &heap(node, zone, j));
-        pg += 1 << j;
-    }
-
-    ASSERT(avail[node][zone] >= request);
-    avail[node][zone] -= request;
-    total_avail_pages -= request;
-    ASSERT(total_avail_pages >= 0);
-
-    cpus_clear(mask);
-
-    for ( i = 0; i < (1 << order); i++ )
-    {
-        /* Reference count must continuously be zero for free pages. */
-        BUG_ON(pg[i].count_info != PGC_state_free);
-        pg[i].count_info = PGC_state_inuse;
-
-        if ( pg[i].u.free.need_tlbflush )
-        {
-            /* Add in extra CPUs that need flushing because of this page. */
-            cpus_andnot(extra_cpus_mask, cpu_online_map, mask);
-            tlbflush_filter(extra_cpus_mask, pg[i].tlbflush_timestamp);
-            cpus_or(mask, mask, extra_cpus_mask);
-        }
-
-        /* Initialise fields which have other uses for free pages. */
-        pg[i].u.inuse.type_info = 0;
-        page_set_owner(&pg[i], NULL);
-    }
-
     spin_unlock(&heap_lock);
 
     if ( unlikely(!cpus_empty(mask)) )
@@ -485,8 +534,11 @@ static int reserve_offlined_page(struct page_info *head)
     return count;
 }
 
-/* Free 2^@order set of pages. */
-static void free_heap_pages(
+/*
+ * Return 2^@order set of pages to the free lists, leaving their TLB flush
+ * state untouched.  Caller must hold heap_lock.
+ */
+static void put_heap_pages(
     struct page_info *pg, unsigned int order)
 {
     unsigned long mask;
@@ -495,8 +547,7 @@ static void free_heap_pages(
 
     ASSERT(order <= MAX_ORDER);
     ASSERT(node >= 0);
-
-    spin_lock(&heap_lock);
+    ASSERT(spin_is_locked(&heap_lock));
 
     for ( i = 0; i < (1 << order); i++ )
     {
@@ -518,11 +569,6 @@ static void free_heap_pages(
               ? PGC_state_offlined : PGC_state_free));
         if ( page_state_is(&pg[i], offlined) )
             tainted = 1;
-
-        /* If a page has no owner it will need no safety TLB flush. */
-        pg[i].u.free.need_tlbflush = (page_get_owner(&pg[i]) != NULL);
-        if ( pg[i].u.free.need_tlbflush )
-            pg[i].tlbflush_timestamp = tlbflush_current_time();
     }
 
     avail[node][zone] += 1 << order;
@@ -568,10 +614,558 @@ static void free_heap_pages(
 
     if ( tainted )
         reserve_offlined_page(pg);
+}
+
+/* Note whether a page being freed needs a safety TLB flush before reuse. */
+static void page_set_tlbflush(struct page_info *pg)
+{
+    /* If a page has no owner it will need no safety TLB flush. */
+    pg->u.free.need_tlbflush = (page_get_owner(pg) != NULL);
+    if ( pg->u.free.need_tlbflush )
+        pg->tlbflush_timestamp = tlbflush_current_time();
+}
+
+/* Free 2^@order set of pages. */
+static void free_heap_pages(
+    struct page_info *pg, unsigned int order)
+{
+    unsigned int i;
+
+    for ( i = 0; i < (1 << order); i++ )
+        page_set_tlbflush(&pg[i]);
+
+    lock_heap();
+    put_heap_pages(pg, order);
+    spin_unlock(&heap_lock);
+}
+
+
+/*************************
+ * PER-CPU PAGE CACHES
+ *
+ * Order-0 and superpage allocations and frees of domain-heap pages go
+ * through a small cache of free pages on each CPU, so that most of them
+ * do not need heap_lock.  A cache holds only pages of its CPU's node and
+ * of zones above the DMA zone, and is refilled from and drained to the
+ * buddy lists in batches.  Cached pages stay PGC_state_inuse so that the
+ * buddy allocator never merges them, and carry the TLB flush state they
+ * were freed with.  They are not counted in avail[], but are reported as
+ * free by avail_heap_pages() and handed back to the buddy lists when an
+ * allocation would otherwise fail or a page is offlined.
+ */
+
+#define PAGE_CACHE_SUPERPAGE_ORDER 9
+#define PAGE_CACHE_NR_LISTS        2
+
+struct page_cache {
+    spinlock_t lock;
+    struct page_list_head list[PAGE_CACHE_NR_LISTS];
+    unsigned int count[PAGE_CACHE_NR_LISTS];
+    unsigned int zone_pages[NR_ZONES];
+};
+
+static DEFINE_PER_CPU(struct page_cache, page_cache);
+static bool_t page_cache_enabled;
+
+/* Per list: entries kept before draining, and entries moved per batch. */
+static const unsigned int page_cache_high[PAGE_CACHE_NR_LISTS] = { 64, 2 };
+static const unsigned int page_cache_batch[PAGE_CACHE_NR_LISTS] = { 16, 1 };
+
+static int page_cache_list(unsigned int order)
+{
+    if ( order == 0 )
+        return 0;
+    if ( order == PAGE_CACHE_SUPERPAGE_ORDER )
+        return 1;
+    return -1;
+}
+
+/* Lowest zone the caches hold pages from: anything above the DMA zone. */
+static unsigned int page_cache_zone_lo(void)
+{
+    return dma_bitsize ? bits_to_zone(dma_bitsize) + 1 : MEMZONE_XEN + 1;
+}
+
+/*
+ * Move up to @nr of the least recently cached entries of list @idx back to
+ * the buddy allocator.  Caller must hold the cache's lock.
+ */
+static unsigned long page_cache_drain(
+    struct page_cache *pc, int idx, unsigned int nr)
+{
+    unsigned int order = idx ? PAGE_CACHE_SUPERPAGE_ORDER : 0;
+    unsigned long drained = 0;
+    struct page_info *pg, *tmp;
+
+    if ( nr == 0 )
+        return 0;
+
+    perfc_incr(page_cache_drain);
+
+    lock_heap();
+
+    page_list_for_each_safe_reverse ( pg, tmp, &pc->list[idx] )
+    {
+        page_list_del(pg, &pc->list[idx]);
+        pc->count[idx]--;
+        pc->zone_pages[page_to_zone(pg)] -= 1U << order;
+        put_heap_pages(pg, order);
+        drained += 1UL << order;
+        if ( --nr == 0 )
+            break;
+    }
 
     spin_unlock(&heap_lock);
+
+    return drained;
 }
 
+/* Refill list @idx from @node's free lists.  Caller must hold the lock. */
+static void page_cache_refill(
+    struct page_cache *pc, int idx, unsigned int node)
+{
+    unsigned int n, order = idx ? PAGE_CACHE_SUPERPAGE_ORDER : 0;
+    unsigned int zone_lo = page_cache_zone_lo();
+    cpumask_t mask;
+    struct page_info *pg;
+
+    perfc_incr(page_cache_refill);
+
+    cpus_clear(mask);
+
+    lock_heap();
+
+    for ( n = 0; n < page_cache_batch[idx]; n++ )
+    {
+        pg = take_heap_pages(zone_lo, NR_ZONES - 1, node, order, &mask);
+        if ( pg == NULL )
+            break;
+        page_list_add_tail(pg, &pc->list[idx]);
+        pc->count[idx]++;
+        pc->zone_pages[page_to_zone(pg)] += 1U << order;
+    }
+
+    spin_unlock(&heap_lock);
+
+    /* The whole batch is flushed now; take_heap_pages() cleared the flags. */
+    if ( unlikely(!cpus_empty(mask)) )
+    {
+        perfc_incr(need_flush_tlb_flush);
+        flush_tlb_mask(&mask);
+    }
+}
+
+/*
+ * Allocate 2^@order pages of @node from this CPU's cache, from zones no
+ * higher than @zone_hi.  Returns NULL if the cache can't satisfy this
+ * request, in which case the caller falls back to the buddy allocator.
+ */
+static struct page_info *page_cache_alloc(
+    unsigned int node, unsigned int zone_hi, unsigned int order)
+{
+    int idx = page_cache_list(order);
+    unsigned int i, zone, cpu = smp_processor_id();
+    struct page_cache *pc;
+    struct page_info *pg;
+    cpumask_t mask;
+
+    if ( !page_cache_enabled || (idx < 0) )
+        return NULL;
+
+    if ( node == NUMA_NO_NODE )
+        node = cpu_to_node(cpu);
+    if ( node != cpu_to_node(cpu) )
+        return NULL;
+
+    pc = &per_cpu(page_cache, cpu);
+    spin_lock(&pc->lock);
+
+    if ( page_list_empty(&pc->list[idx]) )
+    {
+        perfc_incr(page_cache_miss);
+        page_cache_refill(pc, idx, node);
+    }
+    else
+        perfc_incr(page_cache_hit);
+
+    if ( page_list_empty(&pc->list[idx]) ||
+         ((zone = page_to_zone(page_list_first(&pc->list[idx]))) > zone_hi) )
+    {
+        spin_unlock(&pc->lock);
+        return NULL;
+    }
+
+    pg = page_list_first(&pc->list[idx]);
+    page_list_del(pg, &pc->list[idx]);
+    pc->count[idx]--;
+    pc->zone_pages[zone] -= 1U << order;
+
+    spin_unlock(&pc->lock);
+
+    /* A page offlined while cached has to go through the buddy lists. */
+    for ( i = 0; i < (1 << order); i++ )
+    {
+        if ( pg[i].count_info != PGC_state_inuse )
+        {
+            lock_heap();
+            put_heap_pages(pg, order);
+            spin_unlock(&heap_lock);
+            return NULL;
+        }
+    }
+
+    cpus_clear(mask);
+
+    for ( i = 0; i < (1 << order); i++ )
+    {
+        page_tlbflush_mask(&pg[i], &mask);
+        pg[i].u.inuse.type_info = 0;
+    }
+
+    if ( unlikely(!cpus_empty(mask)) )
+    {
+        perfc_incr(need_flush_tlb_flush);
+        flush_tlb_mask(&mask);
+    }
+
+    return pg;
+}
+
+/*
+ * Free 2^@order set of domain-heap pages into this CPU's cache, or to the
+ * buddy allocator if they can't be cached.
+ */
+static void page_cache_free(struct page_info *pg, unsigned int order)
+{
+    int idx = page_cache_list(order);
+    unsigned int i, zone, node = phys_to_nid(page_to_maddr(pg));
+    unsigned int cpu = smp_processor_id();
+    unsigned long x;
+    struct page_cache *pc;
+
+    if ( !page_cache_enabled || (idx < 0) || (node != cpu_to_node(cpu)) ||
+         ((zone = page_to_zone(pg)) < page_cache_zone_lo()) )
+        goto free;
+
+    /* Broken and offlining pages must reach the buddy lists. */
+    for ( i = 0; i < (1 << order); i++ )
+    {
+        x = pg[i].count_info;
+        if ( ((x & (PGC_state | PGC_broken)) != PGC_state_inuse) ||
+             (cmpxchg(&pg[i].count_info, x, PGC_state_inuse) != x) )
+            goto free;
+    }
+
+    for ( i = 0; i < (1 << order); i++ )
+    {
+        page_set_tlbflush(&pg[i]);
+        page_set_owner(&pg[i], NULL);
+    }
+
+    pc = &per_cpu(page_cache, cpu);
+    spin_lock(&pc->lock);
+
+    page_list_add(pg, &pc->list[idx]);
+    pc->count[idx]++;
+    pc->zone_pages[zone] += 1U << order;
+
+    if ( pc->count[idx] > page_cache_high[idx] )
+        page_cache_drain(pc, idx, page_cache_batch[idx]);
+
+    spin_unlock(&pc->lock);
+    return;
+
+ free:
+    free_heap_pages(pg, order);
+}
+
+/* Return every cached page to the buddy allocator. */
+static unsigned long drain_page_caches(void)
+{
+    unsigned int cpu;
+    unsigned long drained = 0;
+    struct page_cache *pc;
+    int idx;
+
+    if ( !page_cache_enabled )
+        return 0;
+
+    for_each_possible_cpu ( cpu )
+    {
+        pc = &per_cpu(page_cache, cpu);
+        spin_lock(&pc->lock);
+        for ( idx = 0; idx < PAGE_CACHE_NR_LISTS; idx++ )
+            drained += page_cache_drain(pc, idx, pc->count[idx]);
+        spin_unlock(&pc->lock);
+    }
+
+    return drained;
+}
+
+/* Cached pages of @node in zones @zone_lo to @zone_hi (-1: any node). */
+static unsigned long page_cache_avail(
+    unsigned int zone_lo, unsigned int zone_hi, unsigned int node)
+{
+    unsigned int cpu, zone;
+    unsigned long pages = 0;
+    struct page_cache *pc;
+
+    if ( !page_cache_enabled )
+        return 0;
+
+    for_each_possible_cpu ( cpu )
+    {
+        if ( (node != -1) && (node != cpu_to_node(cpu)) )
+            continue;
+        pc = &per_cpu(page_cache, cpu);
+        for ( zone = zone_lo; zone <= zone_hi; zone++ )
+            pages += pc->zone_pages[zone];
+    }
+
+    return pages;
+}
+
+static int __init page_cache_init(void)
+{
+    unsigned int cpu;
+    struct page_cache *pc;
+    int idx;
+
+    for_each_possible_cpu ( cpu )
+    {
+        pc = &per_cpu(page_cache, cpu);
+        spin_lock_init(&pc->lock);
+        for ( idx = 0; idx < PAGE_CACHE_NR_LISTS; idx++ )
+            INIT_PAGE_LIST_HEAD(&pc->list[idx]);
+    }
+
+    /* tmem relies on exact accounting of free memory. */
+    page_cache_enabled = opt_page_cache && !opt_tmem;
+
+    return 0;
+}
+__initcall(page_cache_init);
+
+
+/*************************
+ * IDLE-TIME PAGE SCRUBBING
+ *
+ * Pages which may hold another domain's data are not scrubbed when they
+ * are freed, but queued on a per-node list of dirty blocks, indexed by
+ * order.  Idle CPUs scrub the queued pages, their own node's first, and
+ * release them to the buddy allocator.  An allocation which can't be
+ * satisfied otherwise scrubs a bounded number of queued pages from the
+ * zones and node it could use, then fails.  Queued pages stay
+ * PGC_state_inuse and have no owner; they are counted as scrub_pages,
+ * not free_pages, by XEN_SYSCTL_physinfo.
+ */
+
+/* Largest block scrubbed in one go: larger blocks are split first. */
+#define SCRUB_MAX_ORDER 9
+
+/* How long an idle CPU scrubs before checking for other work again. */
+#define SCRUB_SLICE     MILLISECS(1)
+
+/* Most pages one allocation scrubs on demand before it gives up. */
+#define SCRUB_DEMAND_MAX    (4UL << SCRUB_MAX_ORDER)
+
+/* Queued blocks examined per order when looking for a suitable zone. */
+#define SCRUB_ZONE_SCAN     64
+
+struct scrub_node {
+    spinlock_t lock;
+    struct page_list_head list[MAX_ORDER + 1];
+    unsigned long pages;
+} __cacheline_aligned;
+
+static struct scrub_node scrub_node[MAX_NUMNODES];
+
+/* Queue 2^@order pages, already taken off their owner, for scrubbing. */
+static void scrub_list_add(struct page_info *pg, unsigned int order)
+{
+    struct scrub_node *sn = &scrub_node[phys_to_nid(page_to_maddr(pg))];
+    bool_t was_empty;
+
+    perfc_add(scrub_pages_queued, 1UL << order);
+
+    spin_lock(&sn->lock);
+    page_list_add_tail(pg, &sn->list[order]);
+    was_empty = (sn->pages == 0);
+    sn->pages += 1UL << order;
+    spin_unlock(&sn->lock);
+
+    /* Wake idle CPUs; busy ones ignore the softirq. */
+    if ( was_empty )
+        cpumask_raise_softirq(cpu_online_map, PAGE_SCRUB_SOFTIRQ);
+}
+
+/* Queue the pages of a dying domain (or of dom_cow) for scrubbing. */
+static void scrub_free_pages(struct page_info *pg, unsigned int order)
+{
+    unsigned int i;
+
+    for ( i = 0; i < (1 << order); i++ )
+    {
+        page_set_tlbflush(&pg[i]);
+        page_set_owner(&pg[i], NULL);
+    }
+
+    scrub_list_add(pg, order);
+}
+
+/*
+ * Dequeue a block of at most 2^SCRUB_MAX_ORDER pages from @sn, lying in
+ * zones @zone_lo to @zone_hi.  Only the first SCRUB_ZONE_SCAN blocks of
+ * each order are looked at.
+ */
+static struct page_info *scrub_list_take(
+    struct scrub_node *sn, unsigned int zone_lo, unsigned int zone_hi,
+    unsigned int *order)
+{
+    struct page_info *pg = NULL, *cur;
+    unsigned int j, n, zone;
+
+    if ( sn->pages == 0 )
+        return NULL;
+
+    spin_lock(&sn->lock);
+
+    for ( j = 0; j <= MAX_ORDER; j++ )
+    {
+        n = 0;
+        page_list_for_each ( cur, &sn->list[j] )
+        {
+            /* Blocks never straddle zones: the head's zone is the block's. */
+            zone = page_to_zone(cur);
+            if ( (zone >= zone_lo) && (zone <= zone_hi) )
+            {
+                page_list_del(cur, &sn->list[j]);
+                pg = cur;
+                break;
+            }
+            if ( ++n >= SCRUB_ZONE_SCAN )
+                break;
+        }
+        if ( pg != NULL )
+            break;
+    }
+
+    if ( pg != NULL )
+    {
+        /* Requeue the upper halves of a block which is too large. */
+        while ( j > SCRUB_MAX_ORDER )
+        {
+            j--;
+            page_list_add(pg + (1UL << j), &sn->list[j]);
+        }
+        sn->pages -= 1UL << j;
+        *order = j;
+    }
+
+    spin_unlock(&sn->lock);
+
+    return pg;
+}
+
+/*
+ * Scrub at least @nr queued pages in zones @zone_lo to @zone_hi, or all of
+ * them if fewer are queued, and hand them to the buddy allocator.  If
+ * @idle, all nodes' queues are used, this CPU's node's first, and scrubbing
+ * stops early when other work turns up.  Otherwise only @node's queue is
+ * used (NUMA_NO_NODE means this CPU's node).  Returns the number of pages
+ * scrubbed.
+ */
+static unsigned long scrub_dirty_pages(
+    unsigned int node, unsigned int zone_lo, unsigned int zone_hi,
+    unsigned long nr, bool_t idle)
+{
+    unsigned int i, n, order, cpu = smp_processor_id();
+    unsigned int num_nodes = idle ? num_online_nodes() : 1;
+    unsigned long done = 0;
+    s_time_t end = NOW() + SCRUB_SLICE;
+    struct page_info *pg;
+
+    if ( node == NUMA_NO_NODE )
+        node = cpu_to_node(cpu);
+
+    for ( n = 0; (n < num_nodes) && (done < nr); n++ )
+    {
+        while ( (done < nr) &&
+                ((pg = scrub_list_take(&scrub_node[node], zone_lo, zone_hi,
+                                       &order)) != NULL) )
+        {
+            for ( i = 0; i < (1 << order); i++ )
+                scrub_one_page(&pg[i]);
+
+            lock_heap();
+            put_heap_pages(pg, order);
+            spin_unlock(&heap_lock);
+
+            done += 1UL << order;
+
+            if ( idle && (softirq_pending(cpu) || (NOW() >= end)) )
+                goto out;
+        }
+
+        /* Pick next node, wrapping around if needed. */
+        node = next_node(node, node_online_map);
+        if ( node == MAX_NUMNODES )
+            node = first_node(node_online_map);
+    }
+
+ out:
+    if ( idle )
+        perfc_add(scrub_pages_idle, done);
+    else
+        perfc_add(scrub_pages_demand, done);
+
+    return done;
+}
+
+static void page_scrub_softirq(void)
+{
+    /* Scrubbing is for idle time only: leave busy CPUs alone. */
+    if ( !is_idle_vcpu(current) )
+        return;
+
+    scrub_dirty_pages(NUMA_NO_NODE, 0, NR_ZONES - 1, ~0UL, 1);
+}
+
+/* Called from the idle loop: keep scrubbing while pages are queued. */
+void page_scrub_schedule_work(void)
+{
+    if ( avail_scrub_pages() )
+        raise_softirq(PAGE_SCRUB_SOFTIRQ);
+}
+
+unsigned long avail_scrub_pages(void)
+{
+    unsigned int node;
+    unsigned long pages = 0;
+
+    for_each_online_node ( node )
+        pages += scrub_node[node].pages;
+
+    return pages;
+}
+
+static int __init page_scrub_init(void)
+{
+    unsigned int node, j;
+
+    for ( node = 0; node < MAX_NUMNODES; node++ )
+    {
+        spin_lock_init(&scrub_node[node].lock);
+        for ( j = 0; j <= MAX_ORDER; j++ )
+            INIT_PAGE_LIST_HEAD(&scrub_node[node].list[j]);
+    }
+
+    open_softirq(PAGE_SCRUB_SOFTIRQ, page_scrub_softirq);
+
+    return 0;
+}
+__initcall(page_scrub_init);
+
 
 /*
  * Following rules applied for page offline:
@@ -666,6 +1260,9 @@ int offline_page(unsigned long mfn, int broken, uint32_t *status)
         return -EINVAL;
     }
 
+    /* A free page may be sitting in a per-CPU cache. */
+    drain_page_caches();
+
     spin_lock(&heap_lock);
 
     old_info = mark_page_offline(pg, broken);
@@ -865,7 +1462,7 @@ static unsigned long avail_heap_pages(
                 free_pages += avail[i][zone];
     }
 
-    return free_pages;
+    return free_pages + page_cache_avail(zone_lo, zone_hi, node);
 }
 
 unsigned long total_free_pages(void)
@@ -916,13 +1513,15 @@ void __init end_boot_allocator(void)
 }
 
 /*
- * Scrub all unallocated pages in all heap zones. This function is more
- * convoluted than appears necessary because we do not want to continuously
- * hold the lock while scrubbing very large memory areas.
+ * Scrub all unallocated pages in all heap zones.  Domain-heap pages are
+ * queued for the idle-time scrubber rather than scrubbed here, so they
+ * are scrubbed by all idle CPUs in parallel, and on demand by allocations
+ * made before then.  The Xen heap, if separate, is small and scrubbed now.
  */
 void __init scrub_heap_pages(void)
 {
-    unsigned long mfn;
+    unsigned int node, zone, j;
+    unsigned long i, queued = 0;
     struct page_info *pg;
 
     if ( !opt_bootscrub )
@@ -930,30 +1529,41 @@ void __init scrub_heap_pages(void)
 
     printk("Scrubbing Free RAM: ");
 
-    for ( mfn = first_valid_mfn; mfn < max_page; mfn++ )
-    {
-        process_pending_softirqs();
+    /* Pages in the per-CPU caches are free and need scrubbing too. */
+    drain_page_caches();
 
-        pg = mfn_to_page(mfn);
+    spin_lock(&heap_lock);
 
-        /* Quick lock-free check. */
-        if ( !mfn_valid(mfn) || !page_state_is(pg, free) )
+    for_each_online_node ( node )
+    {
+        if ( !avail[node] )
             continue;
 
-        /* Every 100MB, print a progress dot. */
-        if ( (mfn % ((100*1024*1024)/PAGE_SIZE)) == 0 )
-            printk(".");
-
-        spin_lock(&heap_lock);
-
-        /* Re-check page status with lock held. */
-        if ( page_state_is(pg, free) )
-            scrub_one_page(pg);
+        for ( j = 0; j <= MAX_ORDER; j++ )
+            page_list_for_each ( pg, &heap(node, MEMZONE_XEN, j) )
+                for ( i = 0; i < (1UL << j); i++ )
+                    scrub_one_page(&pg[i]);
 
-        spin_unlock(&heap_lock);
+        for ( zone = MEMZONE_XEN + 1; zone < NR_ZONES; zone++ )
+        {
+            for ( j = 0; j <= MAX_ORDER; j++ )
+            {
+                while ( (pg = page_list_remove_head(&heap(node, zone, j))) )
+                {
+                    for ( i = 0; i < (1UL << j); i++ )
+                        pg[i].count_info = PGC_state_inuse;
+                    avail[node][zone] -= 1UL << j;
+                    total_avail_pages -= 1UL << j;
+                    queued += 1UL << j;
+                    scrub_list_add(pg, j);
+                }
+            }
+        }
     }
 
-    printk("done.\n");
+    spin_unlock(&heap_lock);
+
+    printk("%lukB queued for idle CPUs.\n", queued << (PAGE_SHIFT-10));
 }
 
 
@@ -1137,6 +1747,9 @@ struct page_info *alloc_domheap_pages(
     struct page_info *pg = NULL;
     unsigned int bits = memflags >> _MEMF_bits, zone_hi = NR_ZONES - 1;
     unsigned int node = (uint8_t)((memflags >> _MEMF_node) - 1), dma_zone;
+    unsigned int zone_lo = MEMZONE_XEN + 1;
+    unsigned long scrub_budget = SCRUB_DEMAND_MAX, scrubbed;
+    bool_t drained = 0;
 
     ASSERT(!in_irq());
 
@@ -1147,14 +1760,38 @@ struct page_info *alloc_domheap_pages(
     if ( (zone_hi = min_t(unsigned int, bits_to_zone(bits), zone_hi)) == 0 )
         return NULL;
 
-    if ( dma_bitsize && ((dma_zone = bits_to_zone(dma_bitsize)) < zone_hi) )
+    pg = page_cache_alloc(node, zone_hi, order);
+
+ retry:
+    if ( (pg == NULL) && dma_bitsize &&
+         ((dma_zone = bits_to_zone(dma_bitsize)) < zone_hi) )
         pg = alloc_heap_pages(dma_zone + 1, zone_hi, node, order, memflags);
 
-    if ( (pg == NULL) &&
-         ((memflags & MEMF_no_dma) ||
-          ((pg = alloc_heap_pages(MEMZONE_XEN + 1, zone_hi,
-                                  node, order, memflags)) == NULL)) )
-         return NULL;
+    if ( (pg == NULL) && !(memflags & MEMF_no_dma) )
+        pg = alloc_heap_pages(MEMZONE_XEN + 1, zone_hi, node, order, memflags);
+
+    if ( pg == NULL )
+    {
+        /* The memory may be sitting in the per-CPU caches... */
+        if ( !drained )
+        {
+            drained = 1;
+            if ( drain_page_caches() )
+                goto retry;
+        }
+        /* ...or be waiting to be scrubbed, within this allocation's budget. */
+        if ( (memflags & MEMF_no_dma) && dma_bitsize )
+            zone_lo = bits_to_zone(dma_bitsize) + 1;
+        if ( scrub_budget != 0 )
+        {
+            scrubbed = scrub_dirty_pages(node, zone_lo, zone_hi,
+                                         min(1UL << order, scrub_budget), 0);
+            scrub_budget -= min(scrubbed, scrub_budget);
+            if ( scrubbed )
+                goto retry;
+        }
+        return NULL;
+    }
 
     if ( (d != NULL) && assign_pages(d, pg, order, memflags) )
     {
@@ -1207,22 +1844,20 @@ void free_domheap_pages(struct page_info *pg, unsigned int order)
          * domain has died we assume responsibility for erasure.
          */
         if ( unlikely(d->is_dying) )
-            for ( i = 0; i < (1 << order); i++ )
-                scrub_one_page(&pg[i]);
-
-        free_heap_pages(pg, order);
+            scrub_free_pages(pg, order);
+        else
+            page_cache_free(pg, order);
     }
     else if ( unlikely(d == dom_cow) )
     {
         ASSERT(order == 0); 
-        scrub_one_page(pg);
-        free_heap_pages(pg, 0);
+        scrub_free_pages(pg, 0);
         drop_dom_ref = 0;
     }
     else
     {
         /* Freeing anonymous domain-heap pages. */
-        free_heap_pages(pg, order);
+        page_cache_free(pg, order);
         drop_dom_ref = 0;
     }
 
@@ -1276,6 +1911,8 @@ static void pagealloc_info(unsigned char key)
     }
 
     printk("    Dom heap: %lukB free\n", total << (PAGE_SHIFT-10));
+    printk("    Scrub pending: %lukB\n",
+           avail_scrub_pages() << (PAGE_SHIFT-10));
 }
 
 static struct keyhandler pagealloc_info_keyhandler = {
@@ -17,6 +17,8 @@
 #include <xen/event.h>
 #include <xen/time.h>
 #include <xen/perfc.h>
+#include <xen/trace.h>
+#include <xen/numa.h>
 #include <xen/sched-if.h>
 #include <xen/softirq.h>
 #include <asm/atomic.h>
@@ -43,6 +45,7 @@
 #define CSCHED_TICKS_PER_TSLICE     3
 #define CSCHED_TICKS_PER_ACCT       3
 #define CSCHED_MSECS_PER_TICK       10
+#define CSCHED_MSECS_PER_LAT_TSLICE 1
 #define CSCHED_MSECS_PER_TSLICE     \
     (CSCHED_MSECS_PER_TICK * CSCHED_TICKS_PER_TSLICE)
 #define CSCHED_CREDITS_PER_MSEC     10
@@ -55,6 +58,7 @@
 /*
  * Priorities
  */
+#define CSCHED_PRI_TS_LAT_BOOST  1      /* latency class waking up */
 #define CSCHED_PRI_TS_BOOST      0      /* time-share waking up */
 #define CSCHED_PRI_TS_UNDER     -1      /* time-share w/ credits */
 #define CSCHED_PRI_TS_OVER      -2      /* time-share w/o credits */
@@ -67,6 +71,12 @@
 #define CSCHED_FLAG_VCPU_PARKED 0x0001  /* VCPU over capped credits */
 
 
+/*
+ * Wake-to-run latency histogram: bucket b counts latencies below 2^b us.
+ */
+#define CSCHED_WAKE_LAT_BUCKETS 16
+
+
 /*
  * Useful macros
  */
@@ -112,8 +122,22 @@ struct csched_pcpu {
     struct timer ticker;
     unsigned int tick;
     unsigned int idle_bias;
+    /* Runq summary, updated under the runq lock and read without it. */
+    unsigned int runq_len;          /* non-idle VCPUs queued */
+    int16_t runq_pri;               /* priority at the head of the runq */
 };
 
+/*
+ * Load balancing steals from peers in order of increasing distance: SMT
+ * siblings, then other cores of the socket (which share the last level
+ * cache), then the rest of the NUMA node, then everything else.
+ */
+#define CSCHED_STEAL_SMT            0
+#define CSCHED_STEAL_SOCKET         1
+#define CSCHED_STEAL_NODE           2
+#define CSCHED_STEAL_REMOTE         3
+#define CSCHED_STEAL_LEVELS         4
+
 /*
  * Virtual CPU
  */
@@ -126,6 +150,8 @@ struct csched_vcpu {
     s_time_t start_time;   /* When we were scheduled (used for credit) */
     uint16_t flags;
     int16_t pri;
+    s_time_t wake_time;    /* When we were last woken, 0 once running */
+    uint32_t wake_lat[CSCHED_WAKE_LAT_BUCKETS];
 #ifdef CSCHED_STATS
     struct {
         int credit_last;
@@ -148,6 +174,7 @@ struct csched_dom {
     uint16_t active_vcpu_count;
     uint16_t weight;
     uint16_t cap;
+    uint16_t latency;
 };
 
 /*
@@ -186,10 +213,18 @@ __runq_elem(struct list_head *elem)
     return list_entry(elem, struct csched_vcpu, runq_elem);
 }
 
+static inline void
+__runq_summarise(struct csched_pcpu *spc)
+{
+    spc->runq_pri = list_empty(&spc->runq) ?
+        CSCHED_PRI_IDLE : __runq_elem(spc->runq.next)->pri;
+}
+
 static inline void
 __runq_insert(unsigned int cpu, struct csched_vcpu *svc)
 {
-    const struct list_head * const runq = RUNQ(cpu);
+    struct csched_pcpu * const spc = CSCHED_PCPU(cpu);
+    const struct list_head * const runq = &spc->runq;
     struct list_head *iter;
 
     BUG_ON( __vcpu_on_runq(svc) );
@@ -203,13 +238,23 @@ __runq_insert(unsigned int cpu, struct csched_vcpu *svc)
     }
 
     list_add_tail(&svc->runq_elem, iter);
+
+    if ( !is_idle_vcpu(svc->vcpu) )
+        spc->runq_len++;
+    __runq_summarise(spc);
 }
 
 static inline void
 __runq_remove(struct csched_vcpu *svc)
 {
+    struct csched_pcpu * const spc = CSCHED_PCPU(svc->vcpu->processor);
+
     BUG_ON( !__vcpu_on_runq(svc) );
     list_del_init(&svc->runq_elem);
+
+    if ( !is_idle_vcpu(svc->vcpu) )
+        spc->runq_len--;
+    __runq_summarise(spc);
 }
 
 static void burn_credits(struct csched_vcpu *svc, s_time_t now)
@@ -299,6 +344,7 @@ csched_pcpu_init(int cpu)
 
     init_timer(&spc->ticker, csched_tick, (void *)(unsigned long)cpu, cpu);
     INIT_LIST_HEAD(&spc->runq);
+    spc->runq_pri = CSCHED_PRI_IDLE;
     spc->runq_sort_last = csched_priv.runq_sort;
     spc->idle_bias = NR_CPUS - 1;
     per_cpu(schedule_data, cpu).sched_priv = spc;
@@ -530,7 +576,7 @@ csched_vcpu_acct(unsigned int cpu)
      * If the VCPU is found here, then it's consuming a non-negligeable
      * amount of CPU resources and should no longer be boosted.
      */
-    if ( svc->pri == CSCHED_PRI_TS_BOOST )
+    if ( svc->pri > CSCHED_PRI_TS_UNDER )
         svc->pri = CSCHED_PRI_TS_UNDER;
 
     /*
@@ -676,13 +722,20 @@ csched_vcpu_wake(struct vcpu *vc)
      * The one exception is for VCPUs of capped domains unpausing
      * after earning credits they had overspent. We don't boost
      * those.
+     *
+     * VCPUs of domains in the latency class are boosted above other
+     * waking VCPUs, so they preempt those too, but only until they
+     * are next descheduled.
      */
     if ( svc->pri == CSCHED_PRI_TS_UNDER &&
          !(svc->flags & CSCHED_FLAG_VCPU_PARKED) )
     {
-        svc->pri = CSCHED_PRI_TS_BOOST;
+        svc->pri = svc->sdom->latency ?
+            CSCHED_PRI_TS_LAT_BOOST : CSCHED_PRI_TS_BOOST;
     }
 
+    svc->wake_time = NOW();
+
     /* Put the VCPU on the runq and tickle CPUs */
     __runq_insert(cpu, svc);
     __runq_tickle(cpu, svc);
@@ -700,6 +753,7 @@ csched_dom_cntl(
     {
         op->u.credit.weight = sdom->weight;
         op->u.credit.cap = sdom->cap;
+        op->u.credit.latency = sdom->latency;
     }
     else
     {
@@ -720,6 +774,9 @@ csched_dom_cntl(
         if ( op->u.credit.cap != (uint16_t)~0U )
             sdom->cap = op->u.credit.cap;
 
+        if ( op->u.credit.latency != (uint16_t)~0U )
+            sdom->latency = !!op->u.credit.latency;
+
         spin_unlock_irqrestore(&csched_priv.lock, flags);
     }
 
@@ -748,6 +805,7 @@ csched_dom_init(struct domain *dom)
     sdom->dom = dom;
     sdom->weight = CSCHED_DEFAULT_WEIGHT;
     sdom->cap = 0U;
+    sdom->latency = 0U;
     dom->sched_priv = sdom;
 
     return 0;
@@ -807,6 +865,9 @@ csched_runq_sort(unsigned int cpu)
         elem = next;
     }
 
+    /* Priorities may have changed since the head was last summarised. */
+    __runq_summarise(spc);
+
     spin_unlock_irqrestore(&per_cpu(schedule_data, cpu).schedule_lock, flags);
 }
 
@@ -1083,12 +1144,34 @@ csched_runq_steal(int peer_cpu, int cpu, int pri)
     return NULL;
 }
 
+/* Peers of @cpu at distance @level, or wider when a level is unknown. */
+static void
+csched_steal_peers(int cpu, int level, cpumask_t *peers)
+{
+    switch ( level )
+    {
+    case CSCHED_STEAL_SMT:
+        *peers = per_cpu(cpu_sibling_map, cpu);
+        break;
+    case CSCHED_STEAL_SOCKET:
+        *peers = per_cpu(cpu_core_map, cpu);
+        break;
+    case CSCHED_STEAL_NODE:
+        cpus_and(*peers, node_to_cpumask(cpu_to_node(cpu)), cpu_online_map);
+        break;
+    default:
+        *peers = cpu_online_map;
+        break;
+    }
+}
+
 static struct csched_vcpu *
 csched_load_balance(int cpu, struct csched_vcpu *snext)
 {
     struct csched_vcpu *speer;
-    cpumask_t workers;
-    int peer_cpu;
+    const struct csched_pcpu *peer_pcpu;
+    cpumask_t workers, peers;
+    int peer_cpu, level;
 
     BUG_ON( cpu != snext->vcpu->processor );
 
@@ -1104,38 +1187,77 @@ csched_load_balance(int cpu, struct csched_vcpu *snext)
         CSCHED_STAT_CRANK(load_balance_other);
 
     /*
-     * Peek at non-idling CPUs in the system, starting with our
-     * immediate neighbour.
+     * Peek at non-idling CPUs in the system, nearest first, and starting
+     * with our immediate neighbour within each level.
      */
     cpus_andnot(workers, cpu_online_map, csched_priv.idlers);
     cpu_clear(cpu, workers);
-    peer_cpu = cpu;
 
-    while ( !cpus_empty(workers) )
+    for ( level = 0; (level < CSCHED_STEAL_LEVELS) && !cpus_empty(workers);
+          level++ )
     {
-        peer_cpu = cycle_cpu(peer_cpu, workers);
-        cpu_clear(peer_cpu, workers);
+        csched_steal_peers(cpu, level, &peers);
+        cpus_and(peers, peers, workers);
+        cpus_andnot(workers, workers, peers);
+        peer_cpu = cpu;
 
-        /*
-         * Get ahold of the scheduler lock for this peer CPU.
-         *
-         * Note: We don't spin on this lock but simply try it. Spinning could
-         * cause a deadlock if the peer CPU is also load balancing and trying
-         * to lock this CPU.
-         */
-        if ( !spin_trylock(&per_cpu(schedule_data, peer_cpu).schedule_lock) )
+        while ( !cpus_empty(peers) )
         {
-            CSCHED_STAT_CRANK(steal_trylock_failed);
-            continue;
-        }
+            peer_cpu = cycle_cpu(peer_cpu, peers);
+            cpu_clear(peer_cpu, peers);
 
-        /*
-         * Any work over there to steal?
-         */
-        speer = csched_runq_steal(peer_cpu, cpu, snext->pri);
-        spin_unlock(&per_cpu(schedule_data, peer_cpu).schedule_lock);
-        if ( speer != NULL )
-            return speer;
+            /*
+             * Skip, without touching its lock, a peer whose runq has
+             * nothing queued of strictly higher priority than ours.  The
+             * summary may be stale, which costs at most a missed or a
+             * useless steal attempt.
+             */
+            peer_pcpu = CSCHED_PCPU(peer_cpu);
+            if ( (peer_pcpu == NULL) || (peer_pcpu->runq_len == 0) ||
+                 (peer_pcpu->runq_pri <= snext->pri) )
+            {
+                CSCHED_STAT_CRANK(steal_peer_skipped);
+                continue;
+            }
+
+            /*
+             * Get ahold of the scheduler lock for this peer CPU.
+             *
+             * Note: We don't spin on this lock but simply try it. Spinning
+             * could cause a deadlock if the peer CPU is also load balancing
+             * and trying to lock this CPU.
+             */
+            if ( !spin_trylock(&per_cpu(schedule_data, peer_cpu).schedule_lock) )
+            {
+                CSCHED_STAT_CRANK(steal_trylock_failed);
+                continue;
+            }
+
+            /*
+             * Any work over there to steal?
+             */
+            speer = csched_runq_steal(peer_cpu, cpu, snext->pri);
+            spin_unlock(&per_cpu(schedule_data, peer_cpu).schedule_lock);
+            if ( speer != NULL )
+            {
+                switch ( level )
+                {
+                case CSCHED_STEAL_SMT:
+                    CSCHED_STAT_CRANK(steal_smt);
+                    break;
+                case CSCHED_STEAL_SOCKET:
+                    CSCHED_STAT_CRANK(steal_socket);
+                    break;
+                case CSCHED_STEAL_NODE:
+                    CSCHED_STAT_CRANK(steal_node);
+                    break;
+                default:
+                    CSCHED_STAT_CRANK(steal_remote);
+                    break;
+                }
+                return speer;
+            }
+        }
     }
 
  out:
@@ -1144,6 +1266,29 @@ csched_load_balance(int cpu, struct csched_vcpu *snext)
     return snext;
 }
 
+static void
+csched_wake_lat_account(struct csched_vcpu *svc, s_time_t now)
+{
+    s_time_t delta = now - svc->wake_time;
+    unsigned long us;
+    int b;
+
+    svc->wake_time = 0;
+    if ( delta < 0 )
+        return;
+
+    us = delta / MICROSECS(1);
+    if ( us >= (1UL << (CSCHED_WAKE_LAT_BUCKETS - 1)) )
+        b = CSCHED_WAKE_LAT_BUCKETS - 1;
+    else
+        b = us ? fls(us) : 0;
+    svc->wake_lat[b]++;
+
+    TRACE_3D(TRC_SCHED_WAKE_LATENCY, svc->vcpu->domain->domain_id,
+             svc->vcpu->vcpu_id,
+             (uint32_t)min_t(s_time_t, delta, (uint32_t)~0U));
+}
+
 /*
  * This function is in the critical path. It is designed to be simple and
  * fast for the common case.
@@ -1168,10 +1313,15 @@ csched_schedule(s_time_t now)
     }
 
     /*
-     * Select next runnable local VCPU (ie top of local runq)
+     * Select next runnable local VCPU (ie top of local runq).  A latency
+     * class VCPU which is still runnable has had its wake-up boost.
      */
     if ( vcpu_runnable(current) )
+    {
+        if ( scurr->pri == CSCHED_PRI_TS_LAT_BOOST )
+            scurr->pri = CSCHED_PRI_TS_UNDER;
         __runq_insert(cpu, scurr);
+    }
     else
         BUG_ON( is_idle_vcpu(current) || list_empty(runq) );
 
@@ -1205,13 +1355,21 @@ csched_schedule(s_time_t now)
     }
 
     if ( !is_idle_vcpu(snext->vcpu) )
+    {
         snext->start_time += now;
+        if ( snext->wake_time != 0 )
+            csched_wake_lat_account(snext, now);
+    }
 
     /*
-     * Return task to run next...
+     * Return task to run next...  Latency class VCPUs get short slices.
      */
-    ret.time = (is_idle_vcpu(snext->vcpu) ?
-                -1 : MILLISECS(CSCHED_MSECS_PER_TSLICE));
+    if ( is_idle_vcpu(snext->vcpu) )
+        ret.time = -1;
+    else if ( snext->sdom->latency )
+        ret.time = MILLISECS(CSCHED_MSECS_PER_LAT_TSLICE);
+    else
+        ret.time = MILLISECS(CSCHED_MSECS_PER_TSLICE);
     ret.task = snext->vcpu;
 
     CSCHED_VCPU_CHECK(ret.task);
@@ -1232,7 +1390,8 @@ csched_dump_vcpu(struct csched_vcpu *svc)
 
     if ( sdom )
     {
-        printk(" credit=%i [w=%u]", atomic_read(&svc->credit), sdom->weight);
+        printk(" credit=%i [w=%u%s]", atomic_read(&svc->credit), sdom->weight,
+               sdom->latency ? ",lat" : "");
 #ifdef CSCHED_STATS
         printk(" (%d+%u) {a/i=%u/%u m=%u+%u}",
                 svc->stats.credit_last,
@@ -1262,7 +1421,8 @@ csched_dump_pcpu(int cpu)
     cpumask_scnprintf(cpustr, sizeof(cpustr), per_cpu(cpu_sibling_map, cpu));
     printk(" sort=%d, sibling=%s, ", spc->runq_sort_last, cpustr);
     cpumask_scnprintf(cpustr, sizeof(cpustr), per_cpu(cpu_core_map, cpu));
-    printk("core=%s\n", cpustr);
+    printk("core=%s, node=%u, runq len=%u pri=%d\n", cpustr,
+           (unsigned int)cpu_to_node(cpu), spc->runq_len, spc->runq_pri);
 
     /* current VCPU */
     svc = CSCHED_VCPU(per_cpu(schedule_data, cpu).curr);
@@ -1285,6 +1445,46 @@ csched_dump_pcpu(int cpu)
 #undef cpustr
 }
 
+static void
+csched_dump_wake_lat(void)
+{
+    struct domain *d;
+    struct vcpu *v;
+    uint32_t lat[CSCHED_WAKE_LAT_BUCKETS];
+    uint32_t total;
+    int b;
+
+    printk("wake-to-run latency (count below 2^n us):\n");
+
+    rcu_read_lock(&domlist_read_lock);
+
+    for_each_domain ( d )
+    {
+        if ( CSCHED_DOM(d) == NULL )
+            continue;
+
+        memset(lat, 0, sizeof(lat));
+        total = 0;
+        for_each_vcpu ( d, v )
+            for ( b = 0; b < CSCHED_WAKE_LAT_BUCKETS; b++ )
+            {
+                lat[b] += CSCHED_VCPU(v)->wake_lat[b];
+                total += CSCHED_VCPU(v)->wake_lat[b];
+            }
+        if ( total == 0 )
+            continue;
+
+        printk("\td%d%s:", d->domain_id,
+               CSCHED_DOM(d)->latency ? " (lat)" : "");
+        for ( b = 0; b < CSCHED_WAKE_LAT_BUCKETS; b++ )
+            if ( lat[b] != 0 )
+                printk(" %d:%u", b, lat[b]);
+        printk("\n");
+    }
+
+    rcu_read_unlock(&domlist_read_lock);
+}
+
 static void
 csched_dump(void)
 {
@@ -1337,6 +1537,8 @@ csched_dump(void)
             csched_dump_vcpu(svc);
         }
     }
+
+    csched_dump_wake_lat();
 #undef idlers_buf
 }
 
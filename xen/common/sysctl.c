@@ -137,6 +137,89 @@ long do_sysctl(XEN_GUEST_HANDLE(xen_sysctl_t) u_sysctl)
     }
     break;
 
+    case XEN_SYSCTL_getvcpuinfolist:
+    {
+        struct domain *d;
+        struct vcpu *v;
+        struct vcpu_runstate_info runstate;
+        struct xen_sysctl_vcpuinfo info;
+        u32 num_vcpus = 0, nr, limit;
+
+        op->u.getvcpuinfolist.next_domain = DOMID_INVALID;
+
+        rcu_read_lock(&domlist_read_lock);
+
+        for_each_domain ( d )
+        {
+            if ( d->domain_id < op->u.getvcpuinfolist.first_domain )
+                continue;
+
+            if ( xsm_getvcpuinfo(d) )
+                continue;
+
+            nr = 0;
+            for_each_vcpu ( d, v )
+                nr++;
+            if ( num_vcpus + nr > op->u.getvcpuinfolist.max_vcpus )
+            {
+                op->u.getvcpuinfolist.next_domain = d->domain_id;
+                break;
+            }
+
+            /*
+             * Never write more than was counted (and so checked against
+             * max_vcpus): vcpus created since then are left for next time.
+             */
+            limit = num_vcpus + nr;
+            for_each_vcpu ( d, v )
+            {
+                if ( num_vcpus == limit )
+                    break;
+
+                vcpu_runstate_get(v, &runstate);
+
+                info.domain   = d->domain_id;
+                info.vcpu     = v->vcpu_id;
+                info.online   = !test_bit(_VPF_down, &v->pause_flags);
+                info.blocked  = test_bit(_VPF_blocked, &v->pause_flags);
+                info.running  = v->is_running;
+                info.cpu_time = runstate.time[RUNSTATE_running];
+                info.cpu      = v->processor;
+
+                if ( copy_to_guest_offset(op->u.getvcpuinfolist.buffer,
+                                          num_vcpus, &info, 1) )
+                {
+                    ret = -EFAULT;
+                    break;
+                }
+
+                num_vcpus++;
+            }
+
+            if ( ret != 0 )
+                break;
+        }
+
+        rcu_read_unlock(&domlist_read_lock);
+
+        if ( ret != 0 )
+            break;
+
+        /* The first domain must fit, or the caller can make no progress. */
+        if ( (num_vcpus == 0) &&
+             (op->u.getvcpuinfolist.next_domain != DOMID_INVALID) )
+        {
+            ret = -ENOBUFS;
+            break;
+        }
+
+        op->u.getvcpuinfolist.num_vcpus = num_vcpus;
+
+        if ( copy_to_guest(u_sysctl, op, 1) )
+            ret = -EFAULT;
+    }
+    break;
+
 #ifdef PERF_COUNTERS
     case XEN_SYSCTL_perfc_op:
     {
@@ -83,10 +83,11 @@ static int global_pgp_count_max = 0;
 static int global_pcd_count_max = 0;
 static int global_page_count_max = 0;
 static int global_rtree_node_count_max = 0;
-static long global_eph_count_max = 0;
+static int global_eph_count_max = 0;
 static unsigned long failed_copies;
 static unsigned long pcd_tot_tze_size = 0;
 static unsigned long pcd_tot_csize = 0;
+static unsigned long tot_samefill_puts = 0;
 
 DECL_CYC_COUNTER(succ_get);
 DECL_CYC_COUNTER(succ_put);
@@ -104,6 +105,11 @@ EXTERN_CYC_COUNTER(pg_copy);
 #endif
 DECL_CYC_COUNTER(compress);
 DECL_CYC_COUNTER(decompress);
+DECL_CYC_COUNTER(evict);
+/* time in the page operations themselves, i.e. object and LRU locking */
+DECL_CYC_COUNTER(core_put);
+DECL_CYC_COUNTER(core_get);
+DECL_CYC_COUNTER(core_flush);
 
 /************ CORE DATA STRUCTURES ************************************/
 
@@ -117,8 +123,9 @@ struct client {
     struct list_head client_list;
     struct tm_pool *pools[MAX_POOLS_PER_DOMAIN];
     tmh_client_t *tmh;
-    struct list_head ephemeral_page_list;
-    long eph_count, eph_count_max;
+    spinlock_t eph_lists_spinlock; /* protects ephemeral_page_list */
+    struct list_head ephemeral_page_list; /* LRU of pages in ephemeral pools */
+    long eph_count, eph_count_max; /* atomicity depends on eph_lists_spinlock */
     cli_id_t cli_id;
     uint32_t weight;
     uint32_t cap;
@@ -159,8 +166,8 @@ struct tm_pool {
     client_t *client;
     uint64_t uuid[2]; /* 0 for private, non-zero for shared */
     uint32_t pool_id;
-    rwlock_t pool_rwlock;
-    struct rb_root obj_rb_root[OBJ_HASH_BUCKETS]; /* protected by pool_rwlock */
+    rwlock_t obj_rb_rwlocks[OBJ_HASH_BUCKETS];
+    struct rb_root obj_rb_root[OBJ_HASH_BUCKETS]; /* protected by the above */
     struct list_head share_list; /* valid if shared */
     int shared_count; /* valid if shared */
     /* for save/restore/migration */
@@ -169,8 +176,8 @@ struct tm_pool {
     /* statistics collection */
     atomic_t pgp_count;
     int pgp_count_max;
-    long obj_count;  /* atomicity depends on pool_rwlock held for write */
-    long obj_count_max;  
+    atomic_t obj_count;
+    int obj_count_max;
     unsigned long objnode_count, objnode_count_max;
     uint64_t sum_life_cycles;
     uint64_t sum_evicted_cycles;
@@ -196,7 +203,7 @@ typedef struct oid OID;
 struct tmem_object_root {
     DECL_SENTINEL
     OID oid;
-    struct rb_node rb_tree_node; /* protected by pool->pool_rwlock */
+    struct rb_node rb_tree_node; /* protected by pool->obj_rb_rwlocks */
     unsigned long objnode_count; /* atomicity depends on obj_spinlock */
     long pgp_count; /* atomicity depends on obj_spinlock */
     struct radix_tree_root tree_root; /* tree of pages within object */
@@ -216,10 +223,7 @@ struct tmem_object_node {
 typedef struct tmem_object_node objnode_t;
 
 struct tmem_page_descriptor {
-    union {
-        struct list_head global_eph_pages;
-        struct list_head client_inv_pages;
-    };
+    struct list_head client_inv_pages;
     union {
         struct {
             union {
@@ -230,17 +234,19 @@ struct tmem_page_descriptor {
         } us;
         OID inv_oid;  /* used for invalid list only */
     };
-    pagesize_t size; /* 0 == PAGE_SIZE (pfp), -1 == data invalid,
+    pagesize_t size; /* 0 == PAGE_SIZE (pfp or fill), -1 == data invalid,
                     else compressed data (cdata) */
     uint32_t index;
     /* must hold pcd_tree_rwlocks[firstbyte] to use pcd pointer/siblings */
     uint16_t firstbyte; /* NON_SHAREABLE->pfp  otherwise->pcd */
     bool_t eviction_attempted;  /* CHANGE TO lifetimes? (settable) */
+    bool_t samefilled; /* page is one word repeated, stored in fill */
     struct list_head pcd_siblings;
     union {
         pfp_t *pfp;  /* page frame pointer */
         char *cdata; /* compressed data */
         struct tmem_page_content_descriptor *pcd; /* page dedup */
+        unsigned long fill; /* if samefilled */
     };
     union {
         uint64_t timestamp;
@@ -261,16 +267,16 @@ struct tmem_page_content_descriptor {
     struct list_head pgp_list;
     struct rb_node pcd_rb_tree_node;
     uint32_t pgp_ref_count;
+    uint32_t hash; /* of the contents if dedup_hash_enabled, else 0 */
     pagesize_t size; /* if compression_enabled -> 0<size<PAGE_SIZE (*cdata)
                      * else if tze, 0<=size<PAGE_SIZE, rounded up to mult of 8
                      * else PAGE_SIZE -> *pfp */
 };
 typedef struct tmem_page_content_descriptor pcd_t;
-struct rb_root pcd_tree_roots[256]; /* choose based on first byte of page */
+struct rb_root pcd_tree_roots[256]; /* choose based on first byte of page,
+                                       or low byte of its hash */
 rwlock_t pcd_tree_rwlocks[256]; /* poor man's concurrency for now */
 
-static LIST_HEAD(global_ephemeral_page_list); /* all pages in ephemeral pools */
-
 static LIST_HEAD(global_client_list);
 static LIST_HEAD(global_pool_list);
 
@@ -283,7 +289,7 @@ static int tmem_initialized = 0;
 
 EXPORT DEFINE_SPINLOCK(tmem_spinlock);  /* used iff tmh_lock_all */
 EXPORT DEFINE_RWLOCK(tmem_rwlock);      /* used iff !tmh_lock_all */
-static DEFINE_SPINLOCK(eph_lists_spinlock); /* protects global AND clients */
+static DEFINE_SPINLOCK(eph_clients_spinlock); /* global_client_list, evict */
 static DEFINE_SPINLOCK(pers_lists_spinlock);
 
 #define tmem_spin_lock(_l)  do {if (!tmh_lock_all) spin_lock(_l);}while(0)
@@ -299,7 +305,7 @@ static DEFINE_SPINLOCK(pers_lists_spinlock);
 #define ASSERT_WRITELOCK(_l) ASSERT(tmh_lock_all || rw_is_write_locked(_l))
 
 /* global counters (should use long_atomic_t access) */
-static long global_eph_count = 0; /* atomicity depends on eph_lists_spinlock */
+static atomic_t global_eph_count = ATOMIC_INIT(0);
 static atomic_t global_obj_count = ATOMIC_INIT(0);
 static atomic_t global_pgp_count = ATOMIC_INIT(0);
 static atomic_t global_pcd_count = ATOMIC_INIT(0);
@@ -468,11 +474,19 @@ static NOINLINE int pcd_associate(pgp_t *pgp, char *cdata, pagesize_t csize)
     pcd_t *pcd;
     int cmp;
     pagesize_t pfp_size = 0;
-    uint8_t firstbyte = (cdata == NULL) ? tmh_get_first_byte(pgp->pfp) : *cdata;
+    uint8_t firstbyte;
+    uint32_t hash = 0;
     int ret = 0;
 
     if ( !tmh_dedup_enabled() )
         return 0;
+    if ( tmh_dedup_hash_enabled() )
+    {
+        hash = (cdata == NULL) ? tmh_page_hash(pgp->pfp) :
+                                 tmh_hash_bytes(cdata, csize);
+        firstbyte = (uint8_t)hash;
+    } else
+        firstbyte = (cdata == NULL) ? tmh_get_first_byte(pgp->pfp) : *cdata;
     ASSERT(pgp->us.obj != NULL);
     ASSERT(pgp->us.obj->pool != NULL);
     ASSERT(!pgp->us.obj->pool->persistent);
@@ -499,7 +513,10 @@ static NOINLINE int pcd_associate(pgp_t *pgp, char *cdata, pagesize_t csize)
         pcd = container_of(*new, pcd_t, pcd_rb_tree_node);
         parent = *new;
         /* compare new entry and rbtree entry, set cmp accordingly */
-        if ( cdata != NULL )
+        if ( hash != pcd->hash )
+            /* contents differ, no need to look at them */
+            cmp = (hash < pcd->hash) ? -1 : 1;
+        else if ( cdata != NULL )
         {
             if ( pcd->size < PAGE_SIZE )
                 /* both new entry and rbtree entry are compressed */
@@ -557,6 +574,7 @@ static NOINLINE int pcd_associate(pgp_t *pgp, char *cdata, pagesize_t csize)
     RB_CLEAR_NODE(&pcd->pcd_rb_tree_node);  /* is this necessary */
     INIT_LIST_HEAD(&pcd->pgp_list);  /* is this necessary */
     pcd->pgp_ref_count = 0;
+    pcd->hash = hash;
     if ( cdata != NULL )
     {
         memcpy(pcd->cdata,cdata,csize);
@@ -609,9 +627,9 @@ static NOINLINE pgp_t *pgp_alloc(obj_t *obj)
     if ( (pgp = tmem_malloc(pgp_t, pool)) == NULL )
         return NULL;
     pgp->us.obj = obj;
-    INIT_LIST_HEAD(&pgp->global_eph_pages);
     INIT_LIST_HEAD(&pgp->us.client_eph_pages);
     pgp->pfp = NULL;
+    pgp->samefilled = 0;
     if ( tmh_dedup_enabled() )
     {
         pgp->firstbyte = NOT_SHAREABLE;
@@ -641,6 +659,13 @@ static NOINLINE void pgp_free_data(pgp_t *pgp, pool_t *pool)
 {
     pagesize_t pgp_size = pgp->size;
 
+    if ( pgp->samefilled )
+    {
+        pgp->samefilled = 0;
+        pgp->pfp = NULL;
+        pgp->size = -1;
+        return;
+    }
     if ( pgp->pfp == NULL )
         return;
     if ( tmh_dedup_enabled() && pgp->firstbyte != NOT_SHAREABLE )
@@ -673,7 +698,6 @@ static NOINLINE void pgp_free(pgp_t *pgp, int from_delete)
     pool = pgp->us.obj->pool;
     if ( is_ephemeral(pool) )
     {
-        ASSERT(list_empty(&pgp->global_eph_pages));
         ASSERT(list_empty(&pgp->us.client_eph_pages));
     }
     pgp_free_data(pgp, pool);
@@ -717,17 +741,17 @@ static void pgp_delist(pgp_t *pgp, bool_t no_eph_lock)
     if ( is_ephemeral(pgp->us.obj->pool) )
     {
         if ( !no_eph_lock )
-            tmem_spin_lock(&eph_lists_spinlock);
+            tmem_spin_lock(&client->eph_lists_spinlock);
+        ASSERT_SPINLOCK(&client->eph_lists_spinlock);
         if ( !list_empty(&pgp->us.client_eph_pages) )
+        {
             client->eph_count--;
+            atomic_dec_and_assert(global_eph_count);
+        }
         ASSERT(client->eph_count >= 0);
         list_del_init(&pgp->us.client_eph_pages);
-        if ( !list_empty(&pgp->global_eph_pages) )
-            global_eph_count--;
-        ASSERT(global_eph_count >= 0);
-        list_del_init(&pgp->global_eph_pages);
         if ( !no_eph_lock )
-            tmem_spin_unlock(&eph_lists_spinlock);
+            tmem_spin_unlock(&client->eph_lists_spinlock);
     } else {
         if ( client->live_migrating )
         {
@@ -890,6 +914,9 @@ unsigned oid_hash(OID *oidp)
                      BITS_PER_LONG) & OBJ_HASH_BUCKETS_MASK);
 }
 
+/* each object hash bucket has its own lock, protecting its rbtree */
+#define obj_rb_rwlock(_pool,_oidp) (&(_pool)->obj_rb_rwlocks[oid_hash(_oidp)])
+
 /* searches for object==oid in pool, returns locked object if found */
 static NOINLINE obj_t * obj_find(pool_t *pool, OID *oidp)
 {
@@ -897,7 +924,7 @@ static NOINLINE obj_t * obj_find(pool_t *pool, OID *oidp)
     obj_t *obj;
 
 restart_find:
-    tmem_read_lock(&pool->pool_rwlock);
+    tmem_read_lock(obj_rb_rwlock(pool,oidp));
     node = pool->obj_rb_root[oid_hash(oidp)].rb_node;
     while ( node )
     {
@@ -911,10 +938,10 @@ restart_find:
                 {
                     if ( !tmem_spin_trylock(&obj->obj_spinlock) )
                     {
-                        tmem_read_unlock(&pool->pool_rwlock);
+                        tmem_read_unlock(obj_rb_rwlock(pool,oidp));
                         goto restart_find;
                     }
-                    tmem_read_unlock(&pool->pool_rwlock);
+                    tmem_read_unlock(obj_rb_rwlock(pool,oidp));
                 }
                 return obj;
             case -1:
@@ -924,7 +951,7 @@ restart_find:
                 node = node->rb_right;
         }
     }
-    tmem_read_unlock(&pool->pool_rwlock);
+    tmem_read_unlock(obj_rb_rwlock(pool,oidp));
     return NULL;
 }
 
@@ -941,13 +968,12 @@ static NOINLINE void obj_free(obj_t *obj, int no_rebalance)
     pool = obj->pool;
     ASSERT(pool != NULL);
     ASSERT(pool->client != NULL);
-    ASSERT_WRITELOCK(&pool->pool_rwlock);
+    ASSERT_WRITELOCK(obj_rb_rwlock(pool,&obj->oid));
     if ( obj->tree_root.rnode != NULL ) /* may be a "stump" with no leaves */
         radix_tree_destroy(&obj->tree_root, pgp_destroy, rtn_free);
     ASSERT((long)obj->objnode_count == 0);
     ASSERT(obj->tree_root.rnode == NULL);
-    pool->obj_count--;
-    ASSERT(pool->obj_count >= 0);
+    atomic_dec_and_assert(pool->obj_count);
     INVERT_SENTINEL(obj,OBJ);
     obj->pool = NULL;
     old_oid = obj->oid;
@@ -996,12 +1022,10 @@ static NOINLINE obj_t * obj_new(pool_t *pool, OID *oidp)
     obj_t *obj;
 
     ASSERT(pool != NULL);
-    ASSERT_WRITELOCK(&pool->pool_rwlock);
+    ASSERT_WRITELOCK(obj_rb_rwlock(pool,oidp));
     if ( (obj = tmem_malloc(obj_t,pool)) == NULL )
         return NULL;
-    pool->obj_count++;
-    if (pool->obj_count > pool->obj_count_max)
-        pool->obj_count_max = pool->obj_count;
+    atomic_inc_and_max(pool->obj_count);
     atomic_inc_and_max(global_obj_count);
     INIT_RADIX_TREE(&obj->tree_root,0);
     spin_lock_init(&obj->obj_spinlock);
@@ -1021,7 +1045,7 @@ static NOINLINE obj_t * obj_new(pool_t *pool, OID *oidp)
 /* free an object after destroying any pgps in it */
 static NOINLINE void obj_destroy(obj_t *obj, int no_rebalance)
 {
-    ASSERT_WRITELOCK(&obj->pool->pool_rwlock);
+    ASSERT_WRITELOCK(obj_rb_rwlock(obj->pool,&obj->oid));
     radix_tree_destroy(&obj->tree_root, pgp_destroy, rtn_free);
     obj_free(obj,no_rebalance);
 }
@@ -1033,10 +1057,10 @@ static void pool_destroy_objs(pool_t *pool, bool_t selective, cli_id_t cli_id)
     obj_t *obj;
     int i;
 
-    tmem_write_lock(&pool->pool_rwlock);
     pool->is_dying = 1;
     for (i = 0; i < OBJ_HASH_BUCKETS; i++)
     {
+        tmem_write_lock(&pool->obj_rb_rwlocks[i]);
         node = rb_first(&pool->obj_rb_root[i]);
         while ( node != NULL )
         {
@@ -1052,8 +1076,8 @@ static void pool_destroy_objs(pool_t *pool, bool_t selective, cli_id_t cli_id)
             else
                 tmem_spin_unlock(&obj->obj_spinlock);
         }
+        tmem_write_unlock(&pool->obj_rb_rwlocks[i]);
     }
-    tmem_write_unlock(&pool->pool_rwlock);
 }
 
 
@@ -1067,15 +1091,17 @@ static pool_t * pool_alloc(void)
     if ( (pool = tmh_alloc_infra(sizeof(pool_t),__alignof__(pool_t))) == NULL )
         return NULL;
     for (i = 0; i < OBJ_HASH_BUCKETS; i++)
+    {
         pool->obj_rb_root[i] = RB_ROOT;
+        rwlock_init(&pool->obj_rb_rwlocks[i]);
+    }
     INIT_LIST_HEAD(&pool->pool_list);
     INIT_LIST_HEAD(&pool->persistent_page_list);
     pool->cur_pgp = NULL;
-    rwlock_init(&pool->pool_rwlock);
     pool->pgp_count_max = pool->obj_count_max = 0;
     pool->objnode_count = pool->objnode_count_max = 0;
     atomic_set(&pool->pgp_count,0);
-    pool->obj_count = 0; pool->shared_count = 0;
+    atomic_set(&pool->obj_count,0); pool->shared_count = 0;
     pool->pageshift = PAGE_SHIFT - 12;
     pool->good_puts = pool->puts = pool->dup_puts_flushed = 0;
     pool->dup_puts_replaced = pool->no_mem_puts = 0;
@@ -1134,10 +1160,21 @@ static NOINLINE void shared_pool_reassign(pool_t *pool)
         if (new_client->pools[poolid] == pool)
             break;
     ASSERT(poolid != MAX_POOLS_PER_DOMAIN);
+    /* take both clients' list locks in a fixed order */
+    if ( old_client < new_client )
+    {
+        tmem_spin_lock(&old_client->eph_lists_spinlock);
+        tmem_spin_lock(&new_client->eph_lists_spinlock);
+    } else {
+        tmem_spin_lock(&new_client->eph_lists_spinlock);
+        tmem_spin_lock(&old_client->eph_lists_spinlock);
+    }
     new_client->eph_count += _atomic_read(pool->pgp_count);
     old_client->eph_count -= _atomic_read(pool->pgp_count);
     list_splice_init(&old_client->ephemeral_page_list,
                      &new_client->ephemeral_page_list);
+    tmem_spin_unlock(&old_client->eph_lists_spinlock);
+    tmem_spin_unlock(&new_client->eph_lists_spinlock);
     printk("reassigned shared pool from %s=%d to %s=%d pool_id=%d\n",
         cli_id_str, old_client->cli_id, cli_id_str, new_client->cli_id, poolid);
     pool->pool_id = poolid;
@@ -1243,13 +1280,16 @@ static client_t *client_create(cli_id_t cli_id)
             client->shared_auth_uuid[i][1] = -1L;
     client->frozen = 0; client->live_migrating = 0;
     client->weight = 0; client->cap = 0;
-    list_add_tail(&client->client_list, &global_client_list);
+    spin_lock_init(&client->eph_lists_spinlock);
     INIT_LIST_HEAD(&client->ephemeral_page_list);
     INIT_LIST_HEAD(&client->persistent_invalidated_list);
     client->cur_pgp = NULL;
     client->eph_count = client->eph_count_max = 0;
     client->total_cycles = 0; client->succ_pers_puts = 0;
     client->succ_eph_gets = 0; client->succ_pers_gets = 0;
+    tmem_spin_lock(&eph_clients_spinlock);
+    list_add_tail(&client->client_list, &global_client_list);
+    tmem_spin_unlock(&eph_clients_spinlock);
     printk("ok\n");
     return client;
 
@@ -1260,7 +1300,9 @@ static client_t *client_create(cli_id_t cli_id)
 
 static void client_free(client_t *client)
 {
+    tmem_spin_lock(&eph_clients_spinlock);
     list_del(&client->client_list);
+    tmem_spin_unlock(&eph_clients_spinlock);
     tmh_client_destroy(client->tmh);
     tmh_free_infra(client);
 }
@@ -1291,7 +1333,7 @@ static bool_t client_over_quota(client_t *client)
     if ( (total == 0) || (client->weight == 0) || 
           (client->eph_count == 0) )
         return 0;
-    return ( ((global_eph_count*100L) / client->eph_count ) >
+    return ( ((_atomic_read(global_eph_count)*100L) / client->eph_count ) >
              ((total*100L) / client->weight) );
 }
 
@@ -1302,7 +1344,7 @@ static void client_freeze(client_t *client, int freeze)
 
 /************ MEMORY REVOCATION ROUTINES *******************************/
 
-static bool_t tmem_try_to_evict_pgp(pgp_t *pgp, bool_t *hold_pool_rwlock)
+static bool_t tmem_try_to_evict_pgp(pgp_t *pgp, rwlock_t **obj_rwlock)
 {
     obj_t *obj = pgp->us.obj;
     pool_t *pool = obj->pool;
@@ -1326,8 +1368,6 @@ static bool_t tmem_try_to_evict_pgp(pgp_t *pgp, bool_t *hold_pool_rwlock)
             if ( pgp->pcd->pgp_ref_count > 1 && !pgp->eviction_attempted )
             {
                 pgp->eviction_attempted++;
-                list_del(&pgp->global_eph_pages);
-                list_add_tail(&pgp->global_eph_pages,&global_ephemeral_page_list);
                 list_del(&pgp->us.client_eph_pages);
                 list_add_tail(&pgp->us.client_eph_pages,&client->ephemeral_page_list);
                 goto pcd_unlock;
@@ -1335,9 +1375,9 @@ static bool_t tmem_try_to_evict_pgp(pgp_t *pgp, bool_t *hold_pool_rwlock)
         }
         if ( obj->pgp_count > 1 )
             return 1;
-        if ( tmem_write_trylock(&pool->pool_rwlock) )
+        if ( tmem_write_trylock(obj_rb_rwlock(pool,&obj->oid)) )
         {
-            *hold_pool_rwlock = 1;
+            *obj_rwlock = obj_rb_rwlock(pool,&obj->oid);
             return 1;
         }
 pcd_unlock:
@@ -1348,6 +1388,36 @@ obj_unlock:
     return 0;
 }
 
+/*
+ * Pick the client whose ephemeral pages are most over its weighted share of
+ * all ephemeral pages, or simply the one with the most ephemeral pages if
+ * weights aren't in use.  Called with eph_clients_spinlock held; the
+ * result is a hint only, since eph_count is read without the client lock.
+ */
+static client_t *tmem_evict_victim(void)
+{
+    client_t *client, *victim = NULL;
+    int total = _atomic_read(client_weight_total);
+    long share, max_share = 0;
+
+    ASSERT_SPINLOCK(&eph_clients_spinlock);
+    list_for_each_entry(client,&global_client_list,client_list)
+    {
+        if ( client->eph_count == 0 )
+            continue;
+        if ( total == 0 )
+            share = client->eph_count;
+        else
+            share = (client->eph_count * 100L) / (client->weight + 1);
+        if ( victim == NULL || share > max_share )
+        {
+            victim = client;
+            max_share = share;
+        }
+    }
+    return victim;
+}
+
 static int tmem_evict(void)
 {
     client_t *client = tmh_client_from_current();
@@ -1355,26 +1425,24 @@ static int tmem_evict(void)
     obj_t *obj;
     pool_t *pool;
     int ret = 0;
-    bool_t hold_pool_rwlock = 0;
+    rwlock_t *obj_rwlock = NULL;
+    DECL_LOCAL_CYC_COUNTER(evict);
 
+    START_CYC_COUNTER(evict);
     evict_attempts++;
-    tmem_spin_lock(&eph_lists_spinlock);
-    if ( (client != NULL) && client_over_quota(client) &&
-         !list_empty(&client->ephemeral_page_list) )
-    {
-        list_for_each_entry_safe(pgp,pgp2,&client->ephemeral_page_list,us.client_eph_pages)
-            if ( tmem_try_to_evict_pgp(pgp,&hold_pool_rwlock) )
-                goto found;
-    } else if ( list_empty(&global_ephemeral_page_list) ) {
+    tmem_spin_lock(&eph_clients_spinlock);
+    if ( (client == NULL) || !client_over_quota(client) ||
+         list_empty(&client->ephemeral_page_list) )
+        client = tmem_evict_victim();
+    if ( client == NULL )
         goto out;
-    } else {
-        list_for_each_entry_safe(pgp,pgp2,&global_ephemeral_page_list,global_eph_pages)
-            if ( tmem_try_to_evict_pgp(pgp,&hold_pool_rwlock) )
-                goto found;
-    }
+    tmem_spin_lock(&client->eph_lists_spinlock);
+    list_for_each_entry_safe(pgp,pgp2,&client->ephemeral_page_list,us.client_eph_pages)
+        if ( tmem_try_to_evict_pgp(pgp,&obj_rwlock) )
+            goto found;
 
     ret = 0;
-    goto out;
+    goto out_client;
 
 found:
     ASSERT(pgp != NULL);
@@ -1397,18 +1465,21 @@ found:
     pgp_delete(pgp,1);
     if ( obj->pgp_count == 0 )
     {
-        ASSERT_WRITELOCK(&pool->pool_rwlock);
+        ASSERT_WRITELOCK(obj_rwlock);
         obj_free(obj,0);
     }
     else
         tmem_spin_unlock(&obj->obj_spinlock);
-    if ( hold_pool_rwlock )
-        tmem_write_unlock(&pool->pool_rwlock);
+    if ( obj_rwlock != NULL )
+        tmem_write_unlock(obj_rwlock);
     evicted_pgs++;
     ret = 1;
 
+out_client:
+    tmem_spin_unlock(&client->eph_lists_spinlock);
 out:
-    tmem_spin_unlock(&eph_lists_spinlock);
+    tmem_spin_unlock(&eph_clients_spinlock);
+    END_CYC_COUNTER(evict);
     return ret;
 }
 
@@ -1463,7 +1534,7 @@ static NOINLINE int do_tmem_put_compress(pgp_t *pgp, tmem_cli_mfn_t cmfn,
     return -ENOMEM;
 #endif
 
-    if ( pgp->pfp != NULL )
+    if ( pgp->pfp != NULL || pgp->samefilled )
         pgp_free_data(pgp, pgp->us.obj->pool);
     START_CYC_COUNTER(compress);
     ret = tmh_compress_from_client(cmfn, &dst, &size, cva);
@@ -1492,6 +1563,29 @@ out:
     return ret;
 }
 
+/* store a page that is a single word repeated as just that word */
+static NOINLINE int do_tmem_put_samefill(pgp_t *pgp, tmem_cli_mfn_t cmfn,
+                                         void *cva)
+{
+    unsigned long fill;
+    int ret;
+
+    ASSERT(pgp != NULL);
+    ASSERT(pgp->us.obj != NULL);
+    ASSERT_SPINLOCK(&pgp->us.obj->obj_spinlock);
+
+    ret = tmh_samefill_from_client(cmfn, &fill, cva);
+    if ( ret != 1 )
+        return ret;
+    if ( pgp->pfp != NULL || pgp->samefilled )
+        pgp_free_data(pgp, pgp->us.obj->pool);
+    pgp->fill = fill;
+    pgp->samefilled = 1;
+    pgp->size = 0;
+    tot_samefill_puts++;
+    return 1;
+}
+
 static NOINLINE int do_tmem_dup_put(pgp_t *pgp, tmem_cli_mfn_t cmfn,
        pagesize_t tmem_offset, pagesize_t pfn_offset, pagesize_t len, void *cva)
 {
@@ -1499,10 +1593,11 @@ static NOINLINE int do_tmem_dup_put(pgp_t *pgp, tmem_cli_mfn_t cmfn,
     obj_t *obj;
     client_t *client;
     pgp_t *pgpfound = NULL;
+    rwlock_t *obj_rwlock;
     int ret;
 
     ASSERT(pgp != NULL);
-    ASSERT(pgp->pfp != NULL);
+    ASSERT(pgp->pfp != NULL || pgp->samefilled);
     ASSERT(pgp->size != -1);
     obj = pgp->us.obj;
     ASSERT_SPINLOCK(&obj->obj_spinlock);
@@ -1513,6 +1608,15 @@ static NOINLINE int do_tmem_dup_put(pgp_t *pgp, tmem_cli_mfn_t cmfn,
     if ( client->live_migrating )
         goto failed_dup; /* no dups allowed when migrating */
     /* can we successfully manipulate pgp to change out the data? */
+    if ( tmh_samefill_enabled() && len == PAGE_SIZE &&
+         !tmem_offset && !pfn_offset )
+    {
+        ret = do_tmem_put_samefill(pgp,cmfn,cva);
+        if ( ret == 1 )
+            goto done;
+        else if ( ret == -EFAULT )
+            goto bad_copy;
+    }
     if ( len != 0 && client->compress && pgp->size != 0 )
     {
         ret = do_tmem_put_compress(pgp,cmfn,cva);
@@ -1527,7 +1631,7 @@ static NOINLINE int do_tmem_dup_put(pgp_t *pgp, tmem_cli_mfn_t cmfn,
     }
 
 copy_uncompressed:
-    if ( pgp->pfp )
+    if ( pgp->pfp || pgp->samefilled )
         pgp_free_data(pgp, pool);
     if ( ( pgp->pfp = tmem_page_alloc(pool) ) == NULL )
         goto failed_dup;
@@ -1570,9 +1674,10 @@ cleanup:
     pgp_delete(pgpfound,0);
     if ( obj->pgp_count == 0 )
     {
-        tmem_write_lock(&pool->pool_rwlock);
+        obj_rwlock = obj_rb_rwlock(pool,&obj->oid);
+        tmem_write_lock(obj_rwlock);
         obj_free(obj,0);
-        tmem_write_unlock(&pool->pool_rwlock);
+        tmem_write_unlock(obj_rwlock);
     } else {
         obj->no_evict = 0;
         tmem_spin_unlock(&obj->obj_spinlock);
@@ -1608,14 +1713,14 @@ static NOINLINE int do_tmem_put(pool_t *pool,
 
     if ( (objfound == NULL) )
     {
-        tmem_write_lock(&pool->pool_rwlock);
+        tmem_write_lock(obj_rb_rwlock(pool,oidp));
         if ( (obj = objnew = obj_new(pool,oidp)) == NULL )
         {
-            tmem_write_unlock(&pool->pool_rwlock);
+            tmem_write_unlock(obj_rb_rwlock(pool,oidp));
             return -ENOMEM;
         }
         ASSERT_SPINLOCK(&objnew->obj_spinlock);
-        tmem_write_unlock(&pool->pool_rwlock);
+        tmem_write_unlock(obj_rb_rwlock(pool,oidp));
     }
 
     ASSERT((obj != NULL)&&((objnew==obj)||(objfound==obj))&&(objnew!=objfound));
@@ -1631,6 +1736,16 @@ static NOINLINE int do_tmem_put(pool_t *pool,
     pgp->index = index;
     pgp->size = 0;
 
+    if ( tmh_samefill_enabled() && len == PAGE_SIZE &&
+         !tmem_offset && !pfn_offset )
+    {
+        ret = do_tmem_put_samefill(pgp,cmfn,cva);
+        if ( ret == 1 )
+            goto insert_page;
+        if ( ret == -EFAULT )
+            goto bad_copy;
+    }
+
     if ( len != 0 && client->compress )
     {
         ASSERT(pgp->pfp == NULL);
@@ -1670,16 +1785,13 @@ copy_uncompressed:
 insert_page:
     if ( is_ephemeral(pool) )
     {
-        tmem_spin_lock(&eph_lists_spinlock);
-        list_add_tail(&pgp->global_eph_pages,
-            &global_ephemeral_page_list);
-        if (++global_eph_count > global_eph_count_max)
-            global_eph_count_max = global_eph_count;
+        tmem_spin_lock(&client->eph_lists_spinlock);
         list_add_tail(&pgp->us.client_eph_pages,
             &client->ephemeral_page_list);
         if (++client->eph_count > client->eph_count_max)
             client->eph_count_max = client->eph_count;
-        tmem_spin_unlock(&eph_lists_spinlock);
+        atomic_inc_and_max(global_eph_count);
+        tmem_spin_unlock(&client->eph_lists_spinlock);
     } else { /* is_persistent */
         tmem_spin_lock(&pers_lists_spinlock);
         list_add_tail(&pgp->us.pool_pers_pages,
@@ -1718,9 +1830,9 @@ free:
     }
     if ( objnew )
     {
-        tmem_write_lock(&pool->pool_rwlock);
+        tmem_write_lock(obj_rb_rwlock(pool,oidp));
         obj_free(objnew,0);
-        tmem_write_unlock(&pool->pool_rwlock);
+        tmem_write_unlock(obj_rb_rwlock(pool,oidp));
     }
     pool->no_mem_puts++;
     return ret;
@@ -1755,7 +1867,11 @@ static NOINLINE int do_tmem_get(pool_t *pool, OID *oidp, uint32_t index,
         return 0;
     }
     ASSERT(pgp->size != -1);
-    if ( tmh_dedup_enabled() && !is_persistent(pool) &&
+    if ( pgp->samefilled )
+    {
+        if ( tmh_samefill_to_client(cmfn, pgp->fill, cva) == -EFAULT )
+            goto bad_copy;
+    } else if ( tmh_dedup_enabled() && !is_persistent(pool) &&
               pgp->firstbyte != NOT_SHAREABLE )
     {
         if ( pcd_copy_to_client(cmfn, pgp) == -EFAULT )
@@ -1776,18 +1892,16 @@ static NOINLINE int do_tmem_get(pool_t *pool, OID *oidp, uint32_t index,
             pgp_delete(pgp,0);
             if ( obj->pgp_count == 0 )
             {
-                tmem_write_lock(&pool->pool_rwlock);
+                tmem_write_lock(obj_rb_rwlock(pool,oidp));
                 obj_free(obj,0);
                 obj = NULL;
-                tmem_write_unlock(&pool->pool_rwlock);
+                tmem_write_unlock(obj_rb_rwlock(pool,oidp));
             }
         } else {
-            tmem_spin_lock(&eph_lists_spinlock);
-            list_del(&pgp->global_eph_pages);
-            list_add_tail(&pgp->global_eph_pages,&global_ephemeral_page_list);
+            tmem_spin_lock(&client->eph_lists_spinlock);
             list_del(&pgp->us.client_eph_pages);
             list_add_tail(&pgp->us.client_eph_pages,&client->ephemeral_page_list);
-            tmem_spin_unlock(&eph_lists_spinlock);
+            tmem_spin_unlock(&client->eph_lists_spinlock);
             ASSERT(obj != NULL);
             obj->last_client = tmh_get_cli_id_from_current();
         }
@@ -1830,9 +1944,9 @@ static NOINLINE int do_tmem_flush_page(pool_t *pool, OID *oidp, uint32_t index)
     pgp_delete(pgp,0);
     if ( obj->pgp_count == 0 )
     {
-        tmem_write_lock(&pool->pool_rwlock);
+        tmem_write_lock(obj_rb_rwlock(pool,oidp));
         obj_free(obj,0);
-        tmem_write_unlock(&pool->pool_rwlock);
+        tmem_write_unlock(obj_rb_rwlock(pool,oidp));
     } else {
         obj->no_evict = 0;
         tmem_spin_unlock(&obj->obj_spinlock);
@@ -1854,10 +1968,10 @@ static NOINLINE int do_tmem_flush_object(pool_t *pool, OID *oidp)
     obj = obj_find(pool,oidp);
     if ( obj == NULL )
         goto out;
-    tmem_write_lock(&pool->pool_rwlock);
+    tmem_write_lock(obj_rb_rwlock(pool,oidp));
     obj_destroy(obj,0);
     pool->flush_objs_found++;
-    tmem_write_unlock(&pool->pool_rwlock);
+    tmem_write_unlock(obj_rb_rwlock(pool,oidp));
 
 out:
     if ( pool->client->frozen )
@@ -2102,11 +2216,11 @@ static int tmemc_list_client(client_t *c, tmem_cli_va_t buf, int off,
                       use_long ? ',' : '\n');
         if (use_long)
             n += scnprintf(info+n,BSIZE-n,
-             "Pc:%d,Pm:%d,Oc:%ld,Om:%ld,Nc:%lu,Nm:%lu,"
+             "Pc:%d,Pm:%d,Oc:%d,Om:%d,Nc:%lu,Nm:%lu,"
              "ps:%lu,pt:%lu,pd:%lu,pr:%lu,px:%lu,gs:%lu,gt:%lu,"
              "fs:%lu,ft:%lu,os:%lu,ot:%lu\n",
              _atomic_read(p->pgp_count), p->pgp_count_max,
-             p->obj_count, p->obj_count_max,
+             _atomic_read(p->obj_count), p->obj_count_max,
              p->objnode_count, p->objnode_count_max,
              p->good_puts, p->puts,p->dup_puts_flushed, p->dup_puts_replaced,
              p->no_mem_puts, 
@@ -2141,11 +2255,11 @@ static int tmemc_list_shared(tmem_cli_va_t buf, int off, uint32_t len,
         n += scnprintf(info+n,BSIZE-n,"%c", use_long ? ',' : '\n');
         if (use_long)
             n += scnprintf(info+n,BSIZE-n,
-             "Pc:%d,Pm:%d,Oc:%ld,Om:%ld,Nc:%lu,Nm:%lu,"
+             "Pc:%d,Pm:%d,Oc:%d,Om:%d,Nc:%lu,Nm:%lu,"
              "ps:%lu,pt:%lu,pd:%lu,pr:%lu,px:%lu,gs:%lu,gt:%lu,"
              "fs:%lu,ft:%lu,os:%lu,ot:%lu\n",
              _atomic_read(p->pgp_count), p->pgp_count_max,
-             p->obj_count, p->obj_count_max,
+             _atomic_read(p->obj_count), p->obj_count_max,
              p->objnode_count, p->objnode_count_max,
              p->good_puts, p->puts,p->dup_puts_flushed, p->dup_puts_replaced,
              p->no_mem_puts, 
@@ -2183,6 +2297,10 @@ static int tmemc_list_global_perf(tmem_cli_va_t buf, int off, uint32_t len,
 #endif
     n += SCNPRINTF_CYC_COUNTER(info+n,BSIZE-n,compress,"c");
     n += SCNPRINTF_CYC_COUNTER(info+n,BSIZE-n,decompress,"d");
+    n += SCNPRINTF_CYC_COUNTER(info+n,BSIZE-n,evict,"E");
+    n += SCNPRINTF_CYC_COUNTER(info+n,BSIZE-n,core_put,"u");
+    n += SCNPRINTF_CYC_COUNTER(info+n,BSIZE-n,core_get,"r");
+    n += SCNPRINTF_CYC_COUNTER(info+n,BSIZE-n,core_flush,"f");
     n--; /* overwrite trailing comma */
     n += scnprintf(info+n,BSIZE-n,"\n");
     if ( sum + n >= len )
@@ -2211,15 +2329,16 @@ static int tmemc_list_global(tmem_cli_va_t buf, int off, uint32_t len,
       total_flush_pool, use_long ? ',' : '\n');
     if (use_long)
         n += scnprintf(info+n,BSIZE-n,
-          "Ec:%ld,Em:%ld,Oc:%d,Om:%d,Nc:%d,Nm:%d,Pc:%d,Pm:%d,"
-          "Fc:%d,Fm:%d,Sc:%d,Sm:%d,Ep:%lu,Gd:%lu,Zt:%lu,Gz:%lu\n",
-          global_eph_count, global_eph_count_max,
+          "Ec:%d,Em:%d,Oc:%d,Om:%d,Nc:%d,Nm:%d,Pc:%d,Pm:%d,"
+          "Fc:%d,Fm:%d,Sc:%d,Sm:%d,Ep:%lu,Gd:%lu,Zt:%lu,Gz:%lu,Sf:%lu\n",
+          _atomic_read(global_eph_count), global_eph_count_max,
           _atomic_read(global_obj_count), global_obj_count_max,
           _atomic_read(global_rtree_node_count), global_rtree_node_count_max,
           _atomic_read(global_pgp_count), global_pgp_count_max,
           _atomic_read(global_page_count), global_page_count_max,
           _atomic_read(global_pcd_count), global_pcd_count_max,
-         tot_good_eph_puts,deduped_puts,pcd_tot_tze_size,pcd_tot_csize);
+         tot_good_eph_puts,deduped_puts,pcd_tot_tze_size,pcd_tot_csize,
+         tot_samefill_puts);
     if ( sum + n >= len )
         return sum;
     tmh_copy_to_client_buf_offset(buf,off+sum,info,n+1);
@@ -2626,6 +2745,9 @@ EXPORT long do_tmem_op(tmem_cli_op_t uops)
     DECL_LOCAL_CYC_COUNTER(non_succ_put);
     DECL_LOCAL_CYC_COUNTER(flush);
     DECL_LOCAL_CYC_COUNTER(flush_obj);
+    DECL_LOCAL_CYC_COUNTER(core_put);
+    DECL_LOCAL_CYC_COUNTER(core_get);
+    DECL_LOCAL_CYC_COUNTER(core_flush);
 
     if ( !tmem_initialized )
         return -ENODEV;
@@ -2732,20 +2854,26 @@ EXPORT long do_tmem_op(tmem_cli_op_t uops)
         break;
     case TMEM_PUT_PAGE:
         tmem_ensure_avail_pages();
+        START_CYC_COUNTER(core_put);
         rc = do_tmem_put(pool, oidp,
                     op.u.gen.index, op.u.gen.cmfn, 0, 0, PAGE_SIZE, NULL);
+        END_CYC_COUNTER(core_put);
         if (rc == 1) succ_put = 1;
         else non_succ_put = 1;
         break;
     case TMEM_GET_PAGE:
+        START_CYC_COUNTER(core_get);
         rc = do_tmem_get(pool, oidp, op.u.gen.index, op.u.gen.cmfn,
                          0, 0, PAGE_SIZE, 0);
+        END_CYC_COUNTER(core_get);
         if (rc == 1) succ_get = 1;
         else non_succ_get = 1;
         break;
     case TMEM_FLUSH_PAGE:
         flush = 1;
+        START_CYC_COUNTER(core_flush);
         rc = do_tmem_flush_page(pool, oidp, op.u.gen.index);
+        END_CYC_COUNTER(core_flush);
         break;
     case TMEM_FLUSH_OBJECT:
         rc = do_tmem_flush_object(pool, oidp);
@@ -9,6 +9,7 @@
 #include <xen/tmem.h>
 #include <xen/tmem_xen.h>
 #include <xen/lzo.h> /* compression code */
+#include <xen/lz4.h>
 #include <xen/paging.h>
 #include <xen/domain_page.h>
 
@@ -26,6 +27,16 @@ boolean_param("tmem_dedup", opt_tmem_dedup);
 EXPORT int opt_tmem_tze = 0;
 boolean_param("tmem_tze", opt_tmem_tze);
 
+EXPORT int opt_tmem_samefill = 0;
+boolean_param("tmem_samefill", opt_tmem_samefill);
+
+EXPORT int opt_tmem_dedup_hash = 0;
+boolean_param("tmem_dedup_hash", opt_tmem_dedup_hash);
+
+/* opt_tmem_compressor: compression algorithm, default lzo */
+static char __initdata opt_tmem_compressor[8] = "lzo";
+string_param("tmem_compressor", opt_tmem_compressor);
+
 EXPORT int opt_tmem_shared_auth = 0;
 boolean_param("tmem_shared_auth", opt_tmem_shared_auth);
 
@@ -43,10 +54,24 @@ DECL_CYC_COUNTER(pg_copy4);
 DECL_CYC_COUNTER(pg_copy);
 #endif
 
+struct tmh_compressor {
+    const char *name;
+    size_t workmem_bytes;
+    int (*compress)(const unsigned char *src, size_t src_len,
+                    unsigned char *dst, size_t *dst_len, void *wrkmem);
+    int (*decompress)(const unsigned char *src, size_t src_len,
+                      unsigned char *dst, size_t *dst_len);
+};
+
+static const struct tmh_compressor tmh_compressors[] = {
+    { "lzo", LZO1X_1_MEM_COMPRESS, lzo1x_1_compress, lzo1x_decompress_safe },
+    { "lz4", LZ4_MEM_COMPRESS, lz4_compress, lz4_decompress_safe },
+};
+static const struct tmh_compressor *tmh_compressor = &tmh_compressors[0];
+
 /* these are a concurrency bottleneck, could be percpu and dynamically
  * allocated iff opt_tmem_compress */
-#define LZO_WORKMEM_BYTES LZO1X_1_MEM_COMPRESS
-#define LZO_DSTMEM_PAGES 2
+#define DSTMEM_PAGES 2
 static DEFINE_PER_CPU_READ_MOSTLY(unsigned char *, workmem);
 static DEFINE_PER_CPU_READ_MOSTLY(unsigned char *, dstmem);
 
@@ -192,12 +217,11 @@ EXPORT int tmh_compress_from_client(tmem_cli_mfn_t cmfn,
             return -EFAULT;
     }
     mb();
-    ret = lzo1x_1_compress(cli_va, PAGE_SIZE, dmem, out_len, wmem);
-    ASSERT(ret == LZO_E_OK);
+    ret = tmh_compressor->compress(cli_va, PAGE_SIZE, dmem, out_len, wmem);
+    ASSERT(ret == 0);
     *out_va = dmem;
     if ( !tmemc )
         cli_put_page(cli_va, cli_pfp, cli_mfn, 0);
-    unmap_domain_page(cli_va);
     return 1;
 }
 
@@ -244,8 +268,8 @@ EXPORT int tmh_decompress_to_client(tmem_cli_mfn_t cmfn, void *tmem_va,
         if ( cli_va == NULL )
             return -EFAULT;
     }
-    ret = lzo1x_decompress_safe(tmem_va, size, cli_va, &out_len);
-    ASSERT(ret == LZO_E_OK);
+    ret = tmh_compressor->decompress(tmem_va, size, cli_va, &out_len);
+    ASSERT(ret == 0);
     ASSERT(out_len == PAGE_SIZE);
     if ( !tmemc )
         cli_put_page(cli_va, cli_pfp, cli_mfn, 1);
@@ -275,6 +299,67 @@ EXPORT int tmh_copy_tze_to_client(tmem_cli_mfn_t cmfn, void *tmem_va,
     return 1;
 }
 
+/* returns 1 and the repeated word if the client page is a single word
+ * repeated throughout, else 0 */
+EXPORT int tmh_samefill_from_client(tmem_cli_mfn_t cmfn, unsigned long *fill,
+                                    void *cli_va)
+{
+    unsigned long cli_mfn = 0;
+    pfp_t *cli_pfp = NULL;
+    bool_t tmemc = cli_va != NULL; /* if true, cli_va is control-op buffer */
+    const unsigned long *p;
+    int i, ret = 0;
+
+    if ( !tmemc )
+    {
+        cli_va = cli_get_page(cmfn, &cli_mfn, &cli_pfp, 0);
+        if ( cli_va == NULL )
+            return -EFAULT;
+    }
+    mb();
+    p = cli_va;
+    i = PAGE_SIZE/sizeof(unsigned long) - 1;
+    /* most pages differ at one end or the other, check those first */
+    if ( p[i] == p[0] )
+    {
+        while ( --i && p[i] == p[0] );
+        if ( !i )
+        {
+            *fill = p[0];
+            ret = 1;
+        }
+    }
+    if ( !tmemc )
+        cli_put_page(cli_va, cli_pfp, cli_mfn, 0);
+    return ret;
+}
+
+EXPORT int tmh_samefill_to_client(tmem_cli_mfn_t cmfn, unsigned long fill,
+                                  void *cli_va)
+{
+    unsigned long cli_mfn = 0;
+    pfp_t *cli_pfp = NULL;
+    bool_t tmemc = cli_va != NULL; /* if true, cli_va is control-op buffer */
+    unsigned long *p;
+    int i;
+
+    if ( !tmemc )
+    {
+        cli_va = cli_get_page(cmfn, &cli_mfn, &cli_pfp, 1);
+        if ( cli_va == NULL )
+            return -EFAULT;
+    }
+    if ( fill == 0 )
+        memset(cli_va, 0, PAGE_SIZE);
+    else
+        for ( p = cli_va, i = PAGE_SIZE/sizeof(unsigned long); i--; )
+            *p++ = fill;
+    if ( !tmemc )
+        cli_put_page(cli_va, cli_pfp, cli_mfn, 1);
+    mb();
+    return 1;
+}
+
 /******************  XEN-SPECIFIC MEMORY ALLOCATION ********************/
 
 EXPORT struct xmem_pool *tmh_mempool = 0;
@@ -403,13 +488,22 @@ EXPORT int tmh_init(void)
     bool_t bad_alloc = 0;
     struct page_info *pi;
     unsigned char *p1, *p2;
-    int cpu;
+    int cpu, i;
 
     if ( !tmh_mempool_init() )
         return 0;
 
-    dstmem_order = get_order_from_pages(LZO_DSTMEM_PAGES);
-    workmem_order = get_order_from_bytes(LZO1X_1_MEM_COMPRESS);
+    for ( i = 0; i < ARRAY_SIZE(tmh_compressors); i++ )
+        if ( !strcmp(tmh_compressors[i].name, opt_tmem_compressor) )
+            break;
+    if ( i < ARRAY_SIZE(tmh_compressors) )
+        tmh_compressor = &tmh_compressors[i];
+    else
+        printk("tmem: unknown compressor %s, using %s\n",
+               opt_tmem_compressor, tmh_compressor->name);
+
+    dstmem_order = get_order_from_pages(DSTMEM_PAGES);
+    workmem_order = get_order_from_bytes(tmh_compressor->workmem_bytes);
     for_each_possible_cpu ( cpu )
     {
         pi = alloc_domheap_pages(0,dstmem_order,0);
@@ -28,6 +28,7 @@
 
 #include <xen/config.h>
 #include <xen/paging.h>
+#include <xen/timer.h>
 #include <asm/mem_sharing.h>
 
 /*
@@ -122,8 +123,9 @@ typedef enum {
 
 #define P2M_MAGIC_TYPES (p2m_to_mask(p2m_populate_on_demand))
 
-/* Pageable types */
-#define P2M_PAGEABLE_TYPES (p2m_to_mask(p2m_ram_rw))
+/* Pageable types: log-dirty pages come back as log-dirty on page-in */
+#define P2M_PAGEABLE_TYPES (p2m_to_mask(p2m_ram_rw)       \
+                            | p2m_to_mask(p2m_ram_logdirty))
 
 #define P2M_PAGING_TYPES (p2m_to_mask(p2m_ram_paging_out)        \
                           | p2m_to_mask(p2m_ram_paged)           \
@@ -214,6 +216,12 @@ struct p2m_domain {
         unsigned         reclaim_super; /* Last gpfn of a scan */
         unsigned         reclaim_single; /* Last gpfn of a scan */
         unsigned         max_guest;    /* gpfn of max guest demand-populate */
+        /* Ring of recently demand-populated gfns, the first candidates for
+         * reclaim: guests that zero memory leave these pages zero. */
+#define POD_HISTORY_MAX 128
+        unsigned long    mrp[POD_HISTORY_MAX];
+        unsigned int     mrp_idx;
+        struct timer     reclaim_timer; /* Background cache refill */
     } pod;
 };
 
@@ -445,6 +453,8 @@ int p2m_mem_paging_evict(struct domain *d, unsigned long gfn);
 void p2m_mem_paging_populate(struct domain *d, unsigned long gfn);
 /* Prepare the p2m for paging a frame in */
 int p2m_mem_paging_prep(struct domain *d, unsigned long gfn);
+/* Make a prepared frame accessible without a pager response */
+int p2m_mem_paging_restore(struct domain *d, unsigned long gfn);
 /* Resume normal operation (in case a domain was paused) */
 void p2m_mem_paging_resume(struct domain *d);
 #else
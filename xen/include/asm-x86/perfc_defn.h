@@ -132,4 +132,11 @@ PERFCOUNTER(realmode_exits,      "vmexits from realmode")
 
 PERFCOUNTER(pauseloop_exits, "vmexits from Pause-Loop Detection")
 
+PERFCOUNTER(mem_sharing_nominate,      "mem_sharing nominated pages")
+PERFCOUNTER(mem_sharing_share,         "mem_sharing shared pages")
+PERFCOUNTER(mem_sharing_unshare,       "mem_sharing unshared pages")
+PERFCOUNTER(mem_sharing_unshare_retry, "mem_sharing unshare races")
+PERFCOUNTER(mem_sharing_hash_chain,    "mem_sharing hash chain steps")
+PERFCOUNTER(mem_sharing_hash_grow,     "mem_sharing hash resizes")
+
 /*#endif*/ /* __XEN_PERFC_DEFN_H__ */
@@ -0,0 +1,7 @@
+#ifndef _COMPAT_FEATURES_H
+#define _COMPAT_FEATURES_H
+#include <xen/compat.h>
+#include <public/features.h>
+#pragma pack(4)
+#pragma pack()
+#endif /* _COMPAT_FEATURES_H */
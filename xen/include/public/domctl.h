@@ -35,7 +35,7 @@
 #include "xen.h"
 #include "grant_table.h"
 
-#define XEN_DOMCTL_INTERFACE_VERSION 0x00000006
+#define XEN_DOMCTL_INTERFACE_VERSION 0x00000007
 
 struct xenctl_cpumap {
     XEN_GUEST_HANDLE_64(uint8) bitmap;
@@ -320,6 +320,9 @@ struct xen_domctl_scheduler_op {
         struct xen_domctl_sched_credit {
             uint16_t weight;
             uint16_t cap;
+            /* Non-zero: latency class (boost and preempt on wake, 1ms
+             * timeslice).  (uint16_t)~0U on putinfo leaves it unchanged. */
+            uint16_t latency;
         } credit;
     } u;
 };
@@ -720,6 +723,18 @@ struct xen_domctl_gdbsx_domstatus {
 #define XEN_DOMCTL_MEM_EVENT_OP_PAGING_EVICT      1
 #define XEN_DOMCTL_MEM_EVENT_OP_PAGING_PREP       2
 #define XEN_DOMCTL_MEM_EVENT_OP_PAGING_RESUME     3
+/*
+ * Nominate or evict a list of gfns in one call.  The result for each gfn
+ * is stored in errs[].  Xen may stop early, so nr is updated with the number
+ * of gfns processed, which is at least one.
+ */
+#define XEN_DOMCTL_MEM_EVENT_OP_PAGING_NOMINATE_BATCH 4
+#define XEN_DOMCTL_MEM_EVENT_OP_PAGING_EVICT_BATCH    5
+/*
+ * Make a page the pager has prepared and filled accessible to the guest
+ * without a ring response, e.g. when it was read ahead of a fault.
+ */
+#define XEN_DOMCTL_MEM_EVENT_OP_PAGING_RESTORE        6
 
 struct xen_domctl_mem_event_op {
     uint32_t       op;           /* XEN_DOMCTL_MEM_EVENT_OP_* */
@@ -731,6 +746,11 @@ struct xen_domctl_mem_event_op {
 
     /* Other OPs */
     uint64_aligned_t gfn;          /* IN:  gfn of page being operated on */
+
+    /* OP_PAGING_*_BATCH */
+    XEN_GUEST_HANDLE_64(uint64) gfns; /* IN:  gfns to operate on */
+    XEN_GUEST_HANDLE_64(int) errs;    /* OUT: per-gfn result */
+    uint32_t nr;                      /* IN/OUT: gfns requested/processed */
 };
 typedef struct xen_domctl_mem_event_op xen_domctl_mem_event_op_t;
 DEFINE_XEN_GUEST_HANDLE(xen_domctl_mem_event_op_t);
@@ -748,10 +768,34 @@ DEFINE_XEN_GUEST_HANDLE(xen_domctl_mem_event_op_t);
 #define XEN_DOMCTL_MEM_SHARING_OP_DEBUG_GFN      5
 #define XEN_DOMCTL_MEM_SHARING_OP_DEBUG_MFN      6
 #define XEN_DOMCTL_MEM_SHARING_OP_DEBUG_GREF     7
+/*
+ * Nominate or share a list of pages in one call.  The result for each
+ * entry is stored in its rc field.  Xen may stop early, so nr is updated
+ * with the number of entries processed, which is at least one.
+ */
+#define XEN_DOMCTL_MEM_SHARING_OP_NOMINATE_GFN_BATCH 8
+#define XEN_DOMCTL_MEM_SHARING_OP_SHARE_BATCH        9
 
 #define XEN_DOMCTL_MEM_SHARING_S_HANDLE_INVALID  (-10)
 #define XEN_DOMCTL_MEM_SHARING_C_HANDLE_INVALID  (-9)
 
+struct xen_mem_sharing_batch_entry {
+    union {
+        struct {                          /* OP_NOMINATE_GFN_BATCH     */
+            uint64_aligned_t gfn;         /* IN: gfn to nominate       */
+            uint64_aligned_t handle;      /* OUT: the handle           */
+            domid_t          domain;      /* IN: domain owning the gfn */
+        } nominate;
+        struct {                          /* OP_SHARE_BATCH            */
+            uint64_aligned_t source_handle; /* IN: handle to the source page */
+            uint64_aligned_t client_handle; /* IN: handle to the client page */
+        } share;
+    } u;
+    int32_t rc;                           /* OUT: result for this entry */
+};
+typedef struct xen_mem_sharing_batch_entry xen_mem_sharing_batch_entry_t;
+DEFINE_XEN_GUEST_HANDLE(xen_mem_sharing_batch_entry_t);
+
 struct xen_domctl_mem_sharing_op {
     uint8_t op; /* XEN_DOMCTL_MEM_EVENT_OP_* */
 
@@ -776,6 +820,10 @@ struct xen_domctl_mem_sharing_op {
                 grant_ref_t    gref;       /* IN: gref to debug         */
             } u;
         } debug;
+        struct mem_sharing_op_batch {     /* OP_xxx_BATCH */
+            XEN_GUEST_HANDLE_64(xen_mem_sharing_batch_entry_t) entries;
+            uint32_t nr;           /* IN/OUT: entries requested/processed */
+        } batch;
     } u;
 };
 typedef struct xen_domctl_mem_sharing_op xen_domctl_mem_sharing_op_t;
@@ -491,6 +491,37 @@ struct xen_sysctl_lockprof_op {
 typedef struct xen_sysctl_lockprof_op xen_sysctl_lockprof_op_t;
 DEFINE_XEN_GUEST_HANDLE(xen_sysctl_lockprof_op_t);
 
+/*
+ * Get runtime information for the vcpus of all domains, starting at
+ * first_domain, in one call.  Only whole domains are returned: the output
+ * stops before the first domain whose vcpus do not all fit in the buffer,
+ * and next_domain is set to that domain (DOMID_INVALID once all domains
+ * have been returned).
+ */
+#define XEN_SYSCTL_getvcpuinfolist   16
+struct xen_sysctl_vcpuinfo {
+    domid_t  domain;
+    uint8_t  online;                  /* currently online (not hotplugged)? */
+    uint8_t  blocked;                 /* blocked waiting for an event? */
+    uint8_t  running;                 /* currently scheduled on its CPU? */
+    uint32_t vcpu;
+    uint32_t cpu;                     /* current mapping   */
+    uint64_aligned_t cpu_time;        /* total cpu time consumed (ns) */
+};
+typedef struct xen_sysctl_vcpuinfo xen_sysctl_vcpuinfo_t;
+DEFINE_XEN_GUEST_HANDLE(xen_sysctl_vcpuinfo_t);
+struct xen_sysctl_getvcpuinfolist {
+    /* IN variables. */
+    domid_t               first_domain;
+    uint32_t              max_vcpus;
+    XEN_GUEST_HANDLE_64(xen_sysctl_vcpuinfo_t) buffer;
+    /* OUT variables. */
+    uint32_t              num_vcpus;
+    domid_t               next_domain;
+};
+typedef struct xen_sysctl_getvcpuinfolist xen_sysctl_getvcpuinfolist_t;
+DEFINE_XEN_GUEST_HANDLE(xen_sysctl_getvcpuinfolist_t);
+
 struct xen_sysctl {
     uint32_t cmd;
     uint32_t interface_version; /* XEN_SYSCTL_INTERFACE_VERSION */
@@ -509,6 +540,7 @@ struct xen_sysctl {
         struct xen_sysctl_pm_op             pm_op;
         struct xen_sysctl_page_offline_op   page_offline;
         struct xen_sysctl_lockprof_op       lockprof_op;
+        struct xen_sysctl_getvcpuinfolist   getvcpuinfolist;
         uint8_t                             pad[128];
     } u;
 };
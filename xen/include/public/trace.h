@@ -39,6 +39,7 @@
 #define TRC_PV       0x0020f000    /* Xen PV traces            */
 #define TRC_SHADOW   0x0040f000    /* Xen shadow tracing       */
 #define TRC_PM       0x0080f000    /* Xen power management trace */
+#define TRC_XSM      0x0100f000    /* Xen security module trace */
 #define TRC_ALL      0x0ffff000
 #define TRC_HD_TO_EVENT(x) ((x)&0x0fffffff)
 #define TRC_HD_CYCLE_FLAG (1UL<<31)
@@ -79,6 +80,7 @@
 #define TRC_SCHED_SWITCH_INFPREV (TRC_SCHED_VERBOSE + 14)
 #define TRC_SCHED_SWITCH_INFNEXT (TRC_SCHED_VERBOSE + 15)
 #define TRC_SCHED_SHUTDOWN_CODE  (TRC_SCHED_VERBOSE + 16)
+#define TRC_SCHED_WAKE_LATENCY   (TRC_SCHED_VERBOSE + 17)
 
 #define TRC_MEM_PAGE_GRANT_MAP      (TRC_MEM + 1)
 #define TRC_MEM_PAGE_GRANT_UNMAP    (TRC_MEM + 2)
@@ -170,6 +172,9 @@
 #define TRC_PM_IDLE_ENTRY       (TRC_PM_IDLE + 0x01)
 #define TRC_PM_IDLE_EXIT        (TRC_PM_IDLE + 0x02)
 
+/* trace events for XSM */
+#define TRC_XSM_AVC_DECISION    (TRC_XSM + 0x01)
+
 /* This structure represents a single trace buffer record. */
 struct t_rec {
     uint32_t event:28;
@@ -33,8 +33,9 @@
 #define FLASK_MEMBER            20
 #define FLASK_ADD_OCONTEXT      21
 #define FLASK_DEL_OCONTEXT      22
+#define FLASK_HOOK_STATS        23
 
-#define FLASK_LAST              FLASK_DEL_OCONTEXT
+#define FLASK_LAST              FLASK_HOOK_STATS
 
 typedef struct flask_op {
     uint32_t  cmd;
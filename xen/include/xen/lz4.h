@@ -0,0 +1,36 @@
+#ifndef __LZ4_H__
+#define __LZ4_H__
+/*
+ *  LZ4 block format compressor and decompressor
+ *
+ *  A small, fast LZ77 codec: matches are found through a single hash
+ *  table probe and literals and matches are byte aligned, trading some
+ *  compression ratio against LZO for much cheaper compression.  The
+ *  encoded stream follows the LZ4 block format.
+ */
+
+/* input is limited to 64KB so that the hash table can hold 16-bit offsets */
+#define LZ4_MAX_INPUT_SIZE  0x10000
+#define LZ4_HASH_BITS       12
+#define LZ4_MEM_COMPRESS    ((1 << LZ4_HASH_BITS) * sizeof(u16))
+
+#define lz4_worst_compress(x) ((x) + ((x) / 255) + 16)
+
+/* This requires 'workmem' of size LZ4_MEM_COMPRESS */
+int lz4_compress(const unsigned char *src, size_t src_len,
+                 unsigned char *dst, size_t *dst_len, void *wrkmem);
+
+/* safe decompression with overrun testing, *dst_len is the buffer size */
+int lz4_decompress_safe(const unsigned char *src, size_t src_len,
+                        unsigned char *dst, size_t *dst_len);
+
+/*
+ * Return values (< 0 = Error)
+ */
+#define LZ4_E_OK                  0
+#define LZ4_E_ERROR               (-1)
+#define LZ4_E_INPUT_OVERRUN       (-4)
+#define LZ4_E_OUTPUT_OVERRUN      (-5)
+#define LZ4_E_LOOKBEHIND_OVERRUN  (-6)
+
+#endif
@@ -65,6 +65,8 @@ int query_page_offline(unsigned long mfn, uint32_t *status);
 unsigned long total_free_pages(void);
 
 void scrub_heap_pages(void);
+unsigned long avail_scrub_pages(void);
+void page_scrub_schedule_work(void);
 
 int assign_pages(
     struct domain *d,
@@ -43,6 +43,11 @@ PERFCOUNTER(load_balance_over,      "csched: load_balance_over")
 PERFCOUNTER(load_balance_other,     "csched: load_balance_other")
 PERFCOUNTER(steal_trylock_failed,   "csched: steal_trylock_failed")
 PERFCOUNTER(steal_peer_idle,        "csched: steal_peer_idle")
+PERFCOUNTER(steal_peer_skipped,     "csched: steal_peer_skipped")
+PERFCOUNTER(steal_smt,              "csched: steal_smt")
+PERFCOUNTER(steal_socket,           "csched: steal_socket")
+PERFCOUNTER(steal_node,             "csched: steal_node")
+PERFCOUNTER(steal_remote,           "csched: steal_remote")
 PERFCOUNTER(migrate_queued,         "csched: migrate_queued")
 PERFCOUNTER(migrate_running,        "csched: migrate_running")
 PERFCOUNTER(dom_init,               "csched: dom_init")
@@ -52,5 +57,18 @@ PERFCOUNTER(vcpu_destroy,           "csched: vcpu_destroy")
 PERFCOUNTER(vcpu_hot,               "csched: vcpu_hot")
 
 PERFCOUNTER(need_flush_tlb_flush,   "PG_need_flush tlb flushes")
+PERFCOUNTER(heap_lock_contended,    "heap_lock found held")
+PERFCOUNTER(page_cache_hit,         "page cache hits")
+PERFCOUNTER(page_cache_miss,        "page cache misses")
+PERFCOUNTER(page_cache_refill,      "page cache refills")
+PERFCOUNTER(page_cache_drain,       "page cache drains")
+PERFCOUNTER(scrub_pages_queued,     "pages queued for scrubbing")
+PERFCOUNTER(scrub_pages_idle,       "pages scrubbed when idle")
+PERFCOUNTER(scrub_pages_demand,     "pages scrubbed on demand")
+
+PERFCOUNTER(flask_evtchn_av_hit,    "flask: evtchn_send cached av hit")
+PERFCOUNTER(flask_evtchn_av_miss,   "flask: evtchn_send cached av miss")
+PERFCOUNTER(flask_grant_av_hit,     "flask: grant cached av hit")
+PERFCOUNTER(flask_grant_av_miss,    "flask: grant cached av miss")
 
 /*#endif*/ /* __XEN_PERFC_DEFN_H__ */
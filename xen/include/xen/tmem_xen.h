@@ -74,6 +74,18 @@ static inline void tmh_tze_disable(void)
     opt_tmem_tze = 0;
 }
 
+extern int opt_tmem_samefill;
+static inline int tmh_samefill_enabled(void)
+{
+    return opt_tmem_samefill;
+}
+
+extern int opt_tmem_dedup_hash;
+static inline int tmh_dedup_hash_enabled(void)
+{
+    return opt_tmem_dedup_hash;
+}
+
 extern int opt_tmem_shared_auth;
 static inline int tmh_shared_auth(void)
 {
@@ -424,6 +436,26 @@ static inline int tmh_tze_pfp_cmp(pfp_t *pfp1, pagesize_t pfp_len, void *tva, pa
     return 1;
 }
 
+static inline uint32_t tmh_hash_bytes(const void *va, pagesize_t len)
+{
+    const uint64_t *p = va;
+    const unsigned char *c;
+    uint64_t h = len;
+    pagesize_t i;
+
+    for ( i = len/sizeof(uint64_t); i--; p++ )
+        h = (h ^ *p) * 0x9e3779b97f4a7c15ULL;
+    for ( c = (const unsigned char *)p; c < (const unsigned char *)va + len; c++ )
+        h = (h ^ *c) * 0x9e3779b97f4a7c15ULL;
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+/* equal pages hash equal, used to order the dedup trees before comparing */
+static inline uint32_t tmh_page_hash(pfp_t *pfp)
+{
+    return tmh_hash_bytes(__map_domain_page(pfp), PAGE_SIZE);
+}
+
 /* return the size of the data in the pfp, ignoring trailing zeroes and
  * rounded up to the nearest multiple of 8 */
 static inline pagesize_t tmh_tze_pfp_scan(pfp_t *pfp)
@@ -509,6 +541,12 @@ extern int tmh_copy_to_client(tmem_cli_mfn_t cmfn, pfp_t *pfp,
 
 extern int tmh_copy_tze_to_client(tmem_cli_mfn_t cmfn, void *tmem_va, pagesize_t len);
 
+extern int tmh_samefill_from_client(tmem_cli_mfn_t cmfn, unsigned long *fill,
+                                    void *cva);
+
+extern int tmh_samefill_to_client(tmem_cli_mfn_t cmfn, unsigned long fill,
+                                  void *cva);
+
 
 #define TMEM_PERF
 #ifdef TMEM_PERF
@@ -26,6 +26,7 @@
 #include <xen/sched.h>
 #include <xen/init.h>
 #include <xen/rcupdate.h>
+#include <xen/trace.h>
 #include <asm/atomic.h>
 #include <asm/current.h>
 
@@ -71,6 +72,7 @@ const struct selinux_class_perm selinux_class_perm = {
 #define AVC_CACHE_SLOTS            512
 #define AVC_DEF_CACHE_THRESHOLD        512
 #define AVC_CACHE_RECLAIM        16
+#define AVC_PCPU_SLOTS            64
 
 #ifdef FLASK_AVC_STATS
 #define avc_cache_stats_incr(field)                 \
@@ -81,6 +83,26 @@ do {                                \
 #define avc_cache_stats_incr(field)    do {} while (0)
 #endif
 
+#ifdef FLASK_HOOK_PROFILE
+#define AVC_STATS_CLASSES        ARRAY_SIZE(class_to_string)
+#define AVC_LATENCY_BUCKETS      32
+
+/*
+ * Checks and security server computations by class and (lowest) requested
+ * permission, which identifies the calling hook, and a log2 histogram of
+ * the cycles each check took.  Allocated on each CPU's first check.  This
+ * costs two get_cycles() per decision, so it is only built with
+ * flask_hook_profile=y.
+ */
+struct avc_hook_stats {
+    unsigned int checks[AVC_STATS_CLASSES][32];
+    unsigned int misses[AVC_STATS_CLASSES][32];
+    unsigned int latency[AVC_LATENCY_BUCKETS];
+};
+
+static struct avc_hook_stats *avc_hook_stats[NR_CPUS];
+#endif
+
 struct avc_entry {
     u32            ssid;
     u32            tsid;
@@ -102,6 +124,19 @@ struct avc_cache {
     u32            latest_notif;    /* latest revocation notification */
 };
 
+/*
+ * Small direct-mapped cache of decisions in front of the shared AVC.  It is
+ * only ever touched by its own CPU outside interrupt context, so needs no
+ * locking.  The whole cache is dropped when avc_policy_gen moves on, which
+ * happens on every policy load, reset and switch to enforcing mode.
+ */
+struct avc_pcpu_cache {
+    struct avc_entry    slots[AVC_PCPU_SLOTS];
+    u32                 gen;
+    unsigned int        hits;
+    unsigned int        misses;
+};
+
 struct avc_callback_node {
     int (*callback) (u32 event, u32 ssid, u32 tsid,
                      u16 tclass, u32 perms,
@@ -117,11 +152,15 @@ struct avc_callback_node {
 /* Exported via Flask hypercall */
 unsigned int avc_cache_threshold = AVC_DEF_CACHE_THRESHOLD;
 
+/* Decisions cached outside the AVC are only valid for this generation */
+u32 avc_policy_gen = 1;
+
 #ifdef FLASK_AVC_STATS
 DEFINE_PER_CPU(struct avc_cache_stats, avc_cache_stats) = { 0 };
 #endif
 
 static struct avc_cache avc_cache;
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
 static struct avc_callback_node *avc_callbacks;
 
 static inline int avc_hash(u32 ssid, u32 tsid, u16 tclass)
@@ -252,6 +291,7 @@ void __init avc_init(void)
 int avc_get_hash_stats(char *buf, uint32_t size)
 {
     int i, chain_len, max_chain_len, slots_used;
+    unsigned long pcpu_hits = 0, pcpu_misses = 0;
     struct avc_node *node;
     struct hlist_head *head;
 
@@ -276,11 +316,19 @@ int avc_get_hash_stats(char *buf, uint32_t size)
     }
 
     rcu_read_unlock();
+
+    for_each_online_cpu ( i )
+    {
+        pcpu_hits += per_cpu(avc_pcpu_cache, i).hits;
+        pcpu_misses += per_cpu(avc_pcpu_cache, i).misses;
+    }
     
     return snprintf(buf, size, "entries: %d\nbuckets used: %d/%d\n"
-                                "longest chain: %d\n",
+                                "longest chain: %d\n"
+                                "percpu hits: %lu\npercpu misses: %lu\n",
                                 atomic_read(&avc_cache.active_nodes),
-                                slots_used, AVC_CACHE_SLOTS, max_chain_len);
+                                slots_used, AVC_CACHE_SLOTS, max_chain_len,
+                                pcpu_hits, pcpu_misses);
 }
 
 static void avc_node_free(struct rcu_head *rhead)
@@ -682,6 +730,7 @@ static int avc_update_node(u32 event, u32 perms, u32 ssid, u32 tsid, u16 tclass,
     {
     case AVC_CALLBACK_GRANT:
         node->ae.avd.allowed |= perms;
+        node->ae.avd.flags |= AVD_FLAGS_GRANTED;
     break;
     case AVC_CALLBACK_TRY_REVOKE:
     case AVC_CALLBACK_REVOKE:
@@ -707,14 +756,44 @@ out:
     return rc;
 }
 
+/*
+ * Tell the reset callbacks and the decision caches outside the AVC that
+ * the policy changed.
+ */
+static int avc_ss_notify(u32 seqno)
+{
+    struct avc_callback_node *c;
+    int rc = 0, tmprc;
+
+    for ( c = avc_callbacks; c; c = c->next )
+    {
+        if ( c->events & AVC_CALLBACK_RESET )
+        {
+            tmprc = c->callback(AVC_CALLBACK_RESET,
+                                0, 0, 0, 0, NULL);
+            /* save the first error encountered for the return
+               value and continue processing the callbacks */
+            if ( !rc )
+                rc = tmprc;
+        }
+    }
+
+    avc_latest_notif_update(seqno, 0);
+
+    wmb();
+    if ( ++avc_policy_gen == 0 )
+        avc_policy_gen = 1;
+
+    return rc;
+}
+
 /**
  * avc_ss_reset - Flush the cache and revalidate migrated permissions.
  * @seqno: policy sequence number
  */
 int avc_ss_reset(u32 seqno)
 {
-    struct avc_callback_node *c;
-    int i, rc = 0, tmprc;
+    int i;
     unsigned long flag;
     struct avc_node *node;
     struct hlist_head *head;
@@ -733,22 +812,93 @@ int avc_ss_reset(u32 seqno)
         rcu_read_unlock();
         spin_unlock_irqrestore(lock, flag);
     }
-    
-    for ( c = avc_callbacks; c; c = c->next )
+
+    return avc_ss_notify(seqno);
+}
+
+/*
+ * Find a node decided before @seqno in the chain, or NULL.  Must be called
+ * under rcu_read_lock or the slot lock.
+ */
+static struct avc_node *avc_find_stale(struct hlist_head *head, u32 seqno)
+{
+    struct avc_node *node;
+    struct hlist_node *next;
+
+    hlist_for_each_entry_rcu(node, next, head, list)
+        if ( node->ae.avd.seqno < seqno )
+            return node;
+
+    return NULL;
+}
+
+/**
+ * avc_ss_revalidate - Recompute cached decisions after a policy change.
+ * @seqno: policy sequence number
+ *
+ * Unlike avc_ss_reset, entries whose decision is the same under the new
+ * policy stay cached, with the new sequence number; only the entries that
+ * changed are dropped.  Decisions are computed without holding any AVC
+ * lock, so lookups carry on while this runs.
+ */
+int avc_ss_revalidate(u32 seqno)
+{
+    int i;
+    unsigned long flag;
+    struct avc_node *node, *new;
+    struct avc_entry ae;
+    struct av_decision avd;
+    struct hlist_head *head;
+    spinlock_t *lock;
+
+    for ( i = 0; i < AVC_CACHE_SLOTS; i++ )
     {
-        if ( c->events & AVC_CALLBACK_RESET )
+        head = &avc_cache.slots[i];
+        lock = &avc_cache.slots_lock[i];
+
+        for ( ; ; )
         {
-            tmprc = c->callback(AVC_CALLBACK_RESET,
-                                0, 0, 0, 0, NULL);
-            /* save the first error encountered for the return
-               value and continue processing the callbacks */
-            if ( !rc )
-                rc = tmprc;
+            rcu_read_lock();
+            node = avc_find_stale(head, seqno);
+            if ( node )
+                memcpy(&ae, &node->ae, sizeof(ae));
+            rcu_read_unlock();
+            if ( !node )
+                break;
+
+            new = NULL;
+            if ( !security_compute_av(ae.ssid, ae.tsid, ae.tclass, 0, &avd) &&
+                 avd.allowed == ae.avd.allowed &&
+                 avd.auditallow == ae.avd.auditallow &&
+                 avd.auditdeny == ae.avd.auditdeny &&
+                 avd.flags == ae.avd.flags )
+                new = avc_alloc_node();
+
+            /*
+             * Only touch the node if it wasn't updated in the meantime;
+             * otherwise it is picked up again on the next pass.
+             */
+            spin_lock_irqsave(lock, flag);
+            node = avc_find_stale(head, seqno);
+            if ( node && !memcmp(&node->ae, &ae, sizeof(ae)) )
+            {
+                if ( new )
+                {
+                    avc_node_populate(new, ae.ssid, ae.tsid, ae.tclass, &avd);
+                    avc_node_replace(new, node);
+                    new = NULL;
+                }
+                else
+                    avc_node_delete(node);
+            }
+            spin_unlock_irqrestore(lock, flag);
+
+            if ( new )
+                avc_node_kill(new);
         }
     }
 
-    avc_latest_notif_update(seqno, 0);
-    return rc;
+    return avc_ss_notify(seqno);
 }
 
 /**
@@ -770,16 +920,45 @@ int avc_ss_reset(u32 seqno)
  * auditing, e.g. in cases where a lock must be held for the check but
  * should be released for the auditing.
  */
-int avc_has_perm_noaudit(u32 ssid, u32 tsid, u16 tclass, u32 requested,
-                         struct av_decision *in_avd)
+static int avc_check_perm(u32 ssid, u32 tsid, u16 tclass, u32 requested,
+                          struct av_decision *in_avd, int *computed)
 {
     struct avc_node *node;
     struct av_decision avd_entry, *avd;
+    struct avc_pcpu_cache *pc = NULL;
+    struct avc_entry *pe = NULL;
     int rc = 0;
-    u32 denied;
+    u32 denied, gen;
 
     BUG_ON(!requested);
 
+    /*
+     * Per-CPU fast path: only a full grant is answered from here, anything
+     * else goes through the shared cache and the security server.
+     */
+    if ( !in_irq() )
+    {
+        pc = &this_cpu(avc_pcpu_cache);
+        gen = avc_policy_gen;
+        rmb();
+        if ( pc->gen != gen )
+        {
+            memset(pc->slots, 0, sizeof(pc->slots));
+            pc->gen = gen;
+        }
+        pe = &pc->slots[avc_hash(ssid, tsid, tclass) & (AVC_PCPU_SLOTS - 1)];
+        if ( pe->ssid == ssid && pe->tsid == tsid && pe->tclass == tclass &&
+             pe->avd.seqno == avc_cache.latest_notif &&
+             !(requested & ~pe->avd.allowed) )
+        {
+            pc->hits++;
+            if ( in_avd )
+                memcpy(in_avd, &pe->avd, sizeof(*in_avd));
+            return 0;
+        }
+        pc->misses++;
+    }
+
     rcu_read_lock();
 
     node = avc_lookup(ssid, tsid, tclass);
@@ -792,6 +971,7 @@ int avc_has_perm_noaudit(u32 ssid, u32 tsid, u16 tclass, u32 requested,
         else
             avd = &avd_entry;
 
+        *computed = 1;
         rc = security_compute_av(ssid,tsid,tclass,requested,avd);
         if ( rc )
             goto out;
@@ -805,6 +985,18 @@ int avc_has_perm_noaudit(u32 ssid, u32 tsid, u16 tclass, u32 requested,
 
     denied = requested & ~(avd->allowed);
 
+    /*
+     * Grants added while permissive must not outlive the switch back to
+     * enforcing, so they stay in the shared cache only.
+     */
+    if ( pe && !denied && !(avd->flags & AVD_FLAGS_GRANTED) )
+    {
+        pe->ssid = ssid;
+        pe->tsid = tsid;
+        pe->tclass = tclass;
+        pe->avd = *avd;
+    }
+
     if ( denied )
     {
         if ( !flask_enforcing || (avd->flags & AVD_FLAGS_PERMISSIVE) )
@@ -819,6 +1011,141 @@ out:
     return rc;
 }
 
+#ifdef FLASK_HOOK_PROFILE
+static void avc_hook_stats_update(u16 tclass, u32 requested, int computed,
+                                  cycles_t cycles)
+{
+    unsigned int cpu = smp_processor_id(), bit, bucket;
+    struct avc_hook_stats *st = avc_hook_stats[cpu];
+
+    if ( unlikely(st == NULL) )
+    {
+        /* xmalloc() can't be used with interrupts disabled */
+        if ( in_irq() || !local_irq_is_enabled() )
+            return;
+        st = xmalloc(struct avc_hook_stats);
+        if ( st == NULL )
+            return;
+        memset(st, 0, sizeof(*st));
+        avc_hook_stats[cpu] = st;
+    }
+
+    if ( tclass < AVC_STATS_CLASSES )
+    {
+        bit = find_first_set_bit(requested);
+        st->checks[tclass][bit]++;
+        if ( computed )
+            st->misses[tclass][bit]++;
+    }
+
+    bucket = (cycles >> 31) ? 31 : fls((u32)cycles);
+    st->latency[min_t(unsigned int, bucket, AVC_LATENCY_BUCKETS - 1)]++;
+}
+
+static const char *avc_perm_name(u16 tclass, u32 perm)
+{
+    int i;
+
+    for ( i = 0; i < ARRAY_SIZE(av_inherit); i++ )
+        if ( av_inherit[i].tclass == tclass && perm < av_inherit[i].common_base )
+            return av_inherit[i].common_pts[find_first_set_bit(perm)];
+
+    for ( i = 0; i < ARRAY_SIZE(av_perm_to_string); i++ )
+        if ( av_perm_to_string[i].tclass == tclass &&
+             av_perm_to_string[i].value == perm )
+            return av_perm_to_string[i].name;
+
+    return NULL;
+}
+
+#define HOOK_STATS_PRINT(fmt, args...)                          \
+do {                                                            \
+    n = snprintf(buf + len, size - len, fmt, ## args);          \
+    if ( n >= size - len )                                      \
+        return -EINVAL;                                         \
+    len += n;                                                   \
+} while ( 0 )
+
+int avc_get_hook_stats(char *buf, uint32_t size)
+{
+    unsigned int cpu, c, b, checks, misses;
+    struct avc_hook_stats *st;
+    const char *name;
+    int len = 0, n;
+
+    HOOK_STATS_PRINT("class permission checks misses\n");
+
+    for ( c = 0; c < AVC_STATS_CLASSES; c++ )
+    {
+        for ( b = 0; b < 32; b++ )
+        {
+            checks = misses = 0;
+            for ( cpu = 0; cpu < NR_CPUS; cpu++ )
+            {
+                if ( (st = avc_hook_stats[cpu]) == NULL )
+                    continue;
+                checks += st->checks[c][b];
+                misses += st->misses[c][b];
+            }
+            if ( !checks )
+                continue;
+
+            name = avc_perm_name(c, 1U << b);
+            if ( name )
+                HOOK_STATS_PRINT("%s %s %u %u\n", class_to_string[c], name,
+                                 checks, misses);
+            else
+                HOOK_STATS_PRINT("%s 0x%x %u %u\n", class_to_string[c],
+                                 1U << b, checks, misses);
+        }
+    }
+
+    HOOK_STATS_PRINT("cycles checks\n");
+
+    for ( b = 0; b < AVC_LATENCY_BUCKETS; b++ )
+    {
+        checks = 0;
+        for ( cpu = 0; cpu < NR_CPUS; cpu++ )
+            if ( (st = avc_hook_stats[cpu]) != NULL )
+                checks += st->latency[b];
+        if ( checks )
+            HOOK_STATS_PRINT("<%lu %u\n", 1UL << b, checks);
+    }
+
+    return len;
+}
+#endif
+
+/**
+ * avc_has_perm_noaudit - Check permissions but perform no auditing.
+ * @ssid: source security identifier
+ * @tsid: target security identifier
+ * @tclass: target security class
+ * @requested: requested permissions, interpreted based on @tclass
+ * @avd: access vector decisions
+ *
+ * See avc_check_perm(); this also accounts and traces the decision.
+ */
+int avc_has_perm_noaudit(u32 ssid, u32 tsid, u16 tclass, u32 requested,
+                         struct av_decision *in_avd)
+{
+    int rc, computed = 0;
+#ifdef FLASK_HOOK_PROFILE
+    cycles_t start = get_cycles();
+#endif
+
+    rc = avc_check_perm(ssid, tsid, tclass, requested, in_avd, &computed);
+
+#ifdef FLASK_HOOK_PROFILE
+    avc_hook_stats_update(tclass, requested, computed, get_cycles() - start);
+#endif
+
+    TRACE_5D(TRC_XSM_AVC_DECISION, ssid, tsid, tclass | (computed << 16),
+             requested, rc);
+
+    return rc;
+}
+
 /**
  * avc_has_perm - Check permissions and perform any appropriate auditing.
  * @ssid: source security identifier
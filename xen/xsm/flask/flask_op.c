@@ -65,7 +65,8 @@ integer_param("flask_enabled", flask_enabled);
         1UL<<FLASK_GETAVC_THRESHOLD | \
         1UL<<FLASK_AVC_HASHSTATS | \
         1UL<<FLASK_AVC_CACHESTATS | \
-        1UL<<FLASK_MEMBER \
+        1UL<<FLASK_MEMBER | \
+        1UL<<FLASK_HOOK_STATS \
     )
 
 static DEFINE_SPINLOCK(sel_sem);
@@ -1011,6 +1012,14 @@ long do_flask_op(XEN_GUEST_HANDLE(xsm_op_t) u_flask_op)
         break;
     }
 
+#ifdef FLASK_HOOK_PROFILE
+    case FLASK_HOOK_STATS:
+    {
+        length = avc_get_hook_stats(arg, op->size);
+        break;
+    }
+#endif
+
     default:
         length = -ENOSYS;
         break;
@@ -18,6 +18,7 @@
 #include <xen/cpumask.h>
 #include <xen/errno.h>
 #include <xen/guest_access.h>
+#include <xen/perfc.h>
 #include <public/xen.h>
 #include <public/physdev.h>
 #include <public/platform.h>
@@ -53,6 +54,80 @@ static int domain_has_evtchn(struct domain *d, struct evtchn *chn, u32 perms)
     return avc_has_perm(dsec->sid, esec->sid, SECCLASS_EVENT, perms, NULL);
 }
 
+/*
+ * Check and audit like avc_has_perm(), and tell whether the decision may
+ * be cached: all of @requested is allowed by the policy (not just let
+ * through in permissive mode) and none of it is to be audited on grant,
+ * since a cache hit bypasses avc_audit().
+ */
+static int has_perm_cacheable(u32 ssid, u32 tsid, u16 tclass, u32 requested,
+                              int *cacheable)
+{
+    struct av_decision avd;
+    int rc;
+
+    rc = avc_has_perm_noaudit(ssid, tsid, tclass, requested, &avd);
+    avc_audit(ssid, tsid, tclass, requested, &avd, rc, NULL);
+
+    *cacheable = !rc && !(requested & ~avd.allowed) &&
+                 !(requested & avd.auditallow) &&
+                 !(avd.flags & AVD_FLAGS_GRANTED);
+
+    return rc;
+}
+
+/*
+ * Grant checks against the same peer repeat for every map, so remember
+ * what has already been granted.  Only grants are cached, only for the
+ * policy generation they were decided under, and never grants the policy
+ * wants audited.
+ */
+static int domain_has_grant(struct domain *d1, struct domain *d2, u32 perms)
+{
+    struct domain_security_struct *dsec1 = d1->ssid, *dsec2 = d2->ssid;
+    struct grant_av_cache *gc;
+    u32 gen = avc_policy_gen, seq;
+    int rc, cacheable;
+
+    gc = &dsec1->grant_av[dsec2->sid % GRANT_AV_CACHE_SIZE];
+
+    seq = gc->seq;
+    rmb();
+    if ( !(seq & 1) && gc->gen == gen && gc->tsid == dsec2->sid &&
+         !(perms & ~gc->perms) )
+    {
+        rmb();
+        if ( gc->seq == seq )
+        {
+            perfc_incr(flask_grant_av_hit);
+            return 0;
+        }
+    }
+
+    perfc_incr(flask_grant_av_miss);
+
+    rc = has_perm_cacheable(dsec1->sid, dsec2->sid, SECCLASS_GRANT, perms,
+                            &cacheable);
+    if ( !cacheable || !spin_trylock(&dsec1->grant_av_lock) )
+        return rc;
+
+    gc->seq++;
+    wmb();
+    if ( gc->gen != gen || gc->tsid != dsec2->sid )
+    {
+        gc->gen = gen;
+        gc->tsid = dsec2->sid;
+        gc->perms = 0;
+    }
+    gc->perms |= perms;
+    wmb();
+    gc->seq++;
+
+    spin_unlock(&dsec1->grant_av_lock);
+
+    return rc;
+}
+
 static int domain_has_xen(struct domain *d, u32 perms)
 {
     struct domain_security_struct *dsec;
@@ -73,6 +148,7 @@ static int flask_domain_alloc_security(struct domain *d)
     memset(dsec, 0, sizeof(struct domain_security_struct));
 
     dsec->d = d;
+    spin_lock_init(&dsec->grant_av_lock);
 
     if ( is_idle_domain(d) )
     {
@@ -138,7 +214,10 @@ static int flask_evtchn_unbound(struct domain *d1, struct evtchn *chn,
     if ( rc )
         goto out;
     else
+    {
         esec->sid = newsid;
+        esec->send_gen = 0;
+    }
 
 out:
     put_domain(d2);
@@ -196,6 +275,7 @@ static int flask_evtchn_interdomain(struct domain *d1, struct evtchn *chn1,
 
     esec1->sid = newsid1;
     esec2->sid = newsid2;
+    esec1->send_gen = esec2->send_gen = 0;
 
     return rc;
 }
@@ -206,16 +286,32 @@ static void flask_evtchn_close_post(struct evtchn *chn)
     esec = chn->ssid;
 
     esec->sid = SECINITSID_UNLABELED;
+    esec->send_gen = 0;
 }
 
 static int flask_evtchn_send(struct domain *d, struct evtchn *chn)
 {
-    int rc;
+    struct domain_security_struct *dsec = d->ssid;
+    struct evtchn_security_struct *esec = chn->ssid;
+    u32 gen;
+    int rc, cacheable;
 
     switch ( chn->state )
     {
     case ECS_INTERDOMAIN:
-        rc = domain_has_evtchn(d, chn, EVENT__SEND);
+        /* The sending domain's SID never changes, only the channel's */
+        gen = avc_policy_gen;
+        if ( esec->send_gen == gen )
+        {
+            perfc_incr(flask_evtchn_av_hit);
+            rc = 0;
+            break;
+        }
+        perfc_incr(flask_evtchn_av_miss);
+        rc = has_perm_cacheable(dsec->sid, esec->sid, SECCLASS_EVENT,
+                                EVENT__SEND, &cacheable);
+        if ( cacheable )
+            esec->send_gen = gen;
     break;
     case ECS_IPI:
     case ECS_UNBOUND:
@@ -281,12 +377,12 @@ static int flask_grant_mapref(struct domain *d1, struct domain *d2,
     if ( flags & GTF_writing )
         perms |= GRANT__MAP_WRITE;
 
-    return domain_has_perm(d1, d2, SECCLASS_GRANT, perms);
+    return domain_has_grant(d1, d2, perms);
 }
 
 static int flask_grant_unmapref(struct domain *d1, struct domain *d2)
 {
-    return domain_has_perm(d1, d2, SECCLASS_GRANT, GRANT__UNMAP);
+    return domain_has_grant(d1, d2, GRANT__UNMAP);
 }
 
 static int flask_grant_setup(struct domain *d1, struct domain *d2)
@@ -301,7 +397,7 @@ static int flask_grant_transfer(struct domain *d1, struct domain *d2)
 
 static int flask_grant_copy(struct domain *d1, struct domain *d2)
 {
-    return domain_has_perm(d1, d2, SECCLASS_GRANT, GRANT__COPY);
+    return domain_has_grant(d1, d2, GRANT__COPY);
 }
 
 static int flask_grant_query_size(struct domain *d1, struct domain *d2)
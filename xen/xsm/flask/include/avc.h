@@ -94,8 +94,14 @@ int avc_add_callback(int (*callback)(u32 event, u32 ssid, u32 tsid,
 
 /* Exported to selinuxfs */
 int avc_get_hash_stats(char *buf, uint32_t size);
+#ifdef FLASK_HOOK_PROFILE
+int avc_get_hook_stats(char *buf, uint32_t size);
+#endif
 extern unsigned int avc_cache_threshold;
 
+/* Bumped on every policy load or AVC reset; never 0 */
+extern u32 avc_policy_gen;
+
 #ifdef FLASK_AVC_STATS
 DECLARE_PER_CPU(struct avc_cache_stats, avc_cache_stats);
 #endif
@@ -9,6 +9,7 @@
 #include "flask.h"
 
 int avc_ss_reset(u32 seqno);
+int avc_ss_revalidate(u32 seqno);
 
 struct av_perm_to_string {
     u16 tclass;
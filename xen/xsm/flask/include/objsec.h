@@ -17,15 +17,32 @@
 #include "flask.h"
 #include "avc.h"
 
+/*
+ * Grant permissions this domain was last granted against a few target
+ * SIDs, valid while gen matches avc_policy_gen.  Entries are filled under
+ * grant_av_lock and read locklessly, using seq to detect a concurrent fill.
+ */
+#define GRANT_AV_CACHE_SIZE 4
+
+struct grant_av_cache {
+    u32 seq;               /* odd while being filled */
+    u32 gen;
+    u32 tsid;
+    u32 perms;
+};
+
 struct domain_security_struct {
     struct domain *d;      /* back pointer to domain object */
     u32 sid;               /* current SID */
     u32 create_sid;
+    spinlock_t grant_av_lock;
+    struct grant_av_cache grant_av[GRANT_AV_CACHE_SIZE];
 };
 
 struct evtchn_security_struct {
     struct evtchn *chn;      /* back pointer to evtchn object */
     u32 sid;                 /* current SID */
+    u32 send_gen;            /* avc_policy_gen EVENT__SEND was granted at */
 };
 
 extern unsigned int selinux_checkreqprot;
@@ -55,6 +55,7 @@ struct av_decision {
 
 /* definitions of av_decision.flags */
 #define AVD_FLAGS_PERMISSIVE	0x0001
+#define AVD_FLAGS_GRANTED	0x0002	/* allowed widened by a permissive grant */
 
 int security_compute_av(u32 ssid, u32 tsid, u16 tclass, u32 requested,
                                                     struct av_decision *avd);
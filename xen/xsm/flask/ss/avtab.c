@@ -30,8 +30,17 @@
 
 static inline int avtab_hash(struct avtab_key *keyp, u16 mask)
 {
-    return ((keyp->target_class + (keyp->target_type << 2) +
-             (keyp->source_type << 9)) & mask);
+    u32 hash = (keyp->source_type << 16) ^ (keyp->target_type << 5) ^
+               keyp->target_class;
+
+    /* Fold the high bits down so that all three fields reach the mask */
+    hash *= 0x9e3779b1;
+    return (hash >> 16) & mask;
+}
+
+static inline int avtab_node_pooled(struct avtab *h, struct avtab_node *node)
+{
+    return (node >= h->pool) && (node < h->pool + h->pool_size);
 }
 
 static struct avtab_node* avtab_insert_node(struct avtab *h, int hvalue,
@@ -39,7 +48,10 @@ static struct avtab_node* avtab_insert_node(struct avtab *h, int hvalue,
                                                     struct avtab_datum *datum)
 {
     struct avtab_node * newnode;
-    newnode = xmalloc(struct avtab_node);
+    if ( h->pool_used < h->pool_size )
+        newnode = &h->pool[h->pool_used++];
+    else
+        newnode = xmalloc(struct avtab_node);
     if ( newnode == NULL )
         return NULL;
     memset(newnode, 0, sizeof(struct avtab_node));
@@ -245,7 +257,8 @@ void avtab_destroy(struct avtab *h)
         {
             temp = cur;
             cur = cur->next;
-            xfree(temp);
+            if ( !avtab_node_pooled(h, temp) )
+                xfree(temp);
         }
         h->htable[i] = NULL;
     }
@@ -253,12 +266,17 @@ void avtab_destroy(struct avtab *h)
     h->htable = NULL;
     h->nslot = 0;
     h->mask = 0;
+    xfree(h->pool);
+    h->pool = NULL;
+    h->pool_size = h->pool_used = 0;
 }
 
 int avtab_init(struct avtab *h)
 {
     h->htable = NULL;
     h->nel = 0;
+    h->pool = NULL;
+    h->pool_size = h->pool_used = 0;
     return 0;
 }
 
@@ -273,13 +291,12 @@ int avtab_alloc(struct avtab *h, u32 nrules)
     if ( nrules == 0 )
         goto avtab_alloc_out;
 
+    /* About one slot per rule */
     while ( work )
     {
         work  = work >> 1;
         shift++;
-	}
-	if ( shift > 2 )
-        shift = shift - 2;
+    }
     nslot = 1 << shift;
     if ( nslot > MAX_AVTAB_SIZE )
         nslot = MAX_AVTAB_SIZE;
@@ -511,6 +528,12 @@ int avtab_read(struct avtab *a, void *fp, struct policydb *pol)
     rc = avtab_alloc(a, nel);
     if ( rc )
         goto bad;
+
+    /* Not fatal: nodes are allocated one by one if this fails */
+    a->pool = xmalloc_array(struct avtab_node, nel);
+    a->pool_size = a->pool ? nel : 0;
+    a->pool_used = 0;
+
     for ( i = 0; i < nel; i++ )
     {
         rc = avtab_read_item(a, fp, pol, avtab_insertf, NULL);
@@ -58,6 +58,13 @@ struct avtab {
     u32 nel;    /* number of elements */
     u32 nslot;      /* number of hash slots */
     u16 mask;       /* mask to compute hash func */
+    /* Nodes are carved out of one array, sized to the rule count and
+     * allocated by avtab_read(), so that chains are close together;
+     * only overflow (and tables not built by avtab_read()) is
+     * xmalloc()ed. */
+    struct avtab_node *pool;
+    u32 pool_size;
+    u32 pool_used;
 };
 
 int avtab_init(struct avtab *);
@@ -82,7 +89,7 @@ struct avtab_node *avtab_search_node(struct avtab *h, struct avtab_key *key);
 struct avtab_node *avtab_search_node_next(struct avtab_node *node, 
                                                                 int specified);
 
-#define MAX_AVTAB_HASH_BITS 13
+#define MAX_AVTAB_HASH_BITS 16
 #define MAX_AVTAB_HASH_BUCKETS (1 << MAX_AVTAB_HASH_BITS)
 #define MAX_AVTAB_HASH_MASK (MAX_AVTAB_HASH_BUCKETS-1)
 #define MAX_AVTAB_SIZE MAX_AVTAB_HASH_BUCKETS
@@ -661,6 +661,163 @@ static void ocontext_destroy(struct ocontext *c, int i)
     xfree(c);
 }
 
+static void ocontext_bounds(int ocon, struct ocontext *c, u32 *low, u32 *high)
+{
+    switch ( ocon )
+    {
+    case OCON_PIRQ:
+        *low = *high = c->u.pirq;
+        break;
+    case OCON_IOPORT:
+        *low = c->u.ioport.low_ioport;
+        *high = c->u.ioport.high_ioport;
+        break;
+    case OCON_IOMEM:
+        *low = c->u.iomem.low_iomem;
+        *high = c->u.iomem.high_iomem;
+        break;
+    case OCON_DEVICE:
+        *low = *high = c->u.device;
+        break;
+    default:
+        BUG();
+        *low = *high = 0;
+    }
+}
+
+static u32 ocontext_low(int ocon, struct ocontext *c)
+{
+    u32 low, high;
+
+    ocontext_bounds(ocon, c, &low, &high);
+    return low;
+}
+
+/* Heapsort the entries by low bound */
+static void ocontext_sift(int ocon, struct ocontext **ent, u32 root, u32 nel)
+{
+    struct ocontext *tmp;
+    u32 child;
+
+    while ( (child = 2 * root + 1) < nel )
+    {
+        if ( child + 1 < nel &&
+             ocontext_low(ocon, ent[child]) < ocontext_low(ocon, ent[child + 1]) )
+            child++;
+        if ( ocontext_low(ocon, ent[root]) >= ocontext_low(ocon, ent[child]) )
+            return;
+        tmp = ent[root];
+        ent[root] = ent[child];
+        ent[child] = tmp;
+        root = child;
+    }
+}
+
+static void ocontext_sort(int ocon, struct ocontext **ent, u32 nel)
+{
+    struct ocontext *tmp;
+    u32 i;
+
+    for ( i = nel / 2; i-- > 0; )
+        ocontext_sift(ocon, ent, i, nel);
+
+    for ( i = nel; i-- > 1; )
+    {
+        tmp = ent[0];
+        ent[0] = ent[i];
+        ent[i] = tmp;
+        ocontext_sift(ocon, ent, 0, i);
+    }
+}
+
+/*
+ * (Re)build the sorted index of an ocontext list.  Must be called with the
+ * policy write lock held, or before the policy is visible, whenever the
+ * list changes.
+ */
+void policydb_index_ocontext(struct policydb *p, int ocon)
+{
+    struct ocontext_index *idx = &p->ocon_index[ocon];
+    struct ocontext *c;
+    u32 i, nel, low, high, prev_high;
+
+    xfree(idx->ent);
+    idx->ent = NULL;
+    idx->nel = 0;
+
+    for ( nel = 0, c = p->ocontexts[ocon]; c; c = c->next )
+        nel++;
+    if ( nel == 0 )
+        return;
+
+    idx->ent = xmalloc_array(struct ocontext *, nel);
+    if ( !idx->ent )
+        return;
+
+    for ( i = 0, c = p->ocontexts[ocon]; c; c = c->next )
+        idx->ent[i++] = c;
+    ocontext_sort(ocon, idx->ent, nel);
+
+    /* With overlaps the first match in list order wins: keep scanning */
+    for ( i = 0, prev_high = 0; i < nel; i++ )
+    {
+        ocontext_bounds(ocon, idx->ent[i], &low, &high);
+        if ( i && low <= prev_high )
+        {
+            printk(KERN_WARNING "Flask:  overlapping ocontexts (%d), "
+                   "lookups will not be indexed\n", ocon);
+            xfree(idx->ent);
+            idx->ent = NULL;
+            return;
+        }
+        prev_high = high;
+    }
+
+    idx->nel = nel;
+}
+
+/*
+ * Find the ocontext covering key, or NULL.  Must be called with the policy
+ * lock held.
+ */
+struct ocontext *policydb_ocontext_lookup(struct policydb *p, int ocon,
+                                          unsigned long key)
+{
+    struct ocontext_index *idx = &p->ocon_index[ocon];
+    struct ocontext *c;
+    u32 lo, hi, mid, low, high;
+
+    if ( !idx->ent )
+    {
+        for ( c = p->ocontexts[ocon]; c; c = c->next )
+        {
+            ocontext_bounds(ocon, c, &low, &high);
+            if ( low <= key && high >= key )
+                return c;
+        }
+        return NULL;
+    }
+
+    /* Find the last entry with low <= key */
+    lo = 0;
+    hi = idx->nel;
+    while ( lo < hi )
+    {
+        mid = lo + (hi - lo) / 2;
+        if ( ocontext_low(ocon, idx->ent[mid]) <= key )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if ( lo == 0 )
+        return NULL;
+
+    c = idx->ent[lo - 1];
+    ocontext_bounds(ocon, c, &low, &high);
+
+    return (high >= key) ? c : NULL;
+}
+
 /*
  * Free any memory allocated by a policy database structure.
  */
@@ -698,6 +855,9 @@ void policydb_destroy(struct policydb *p)
             ocontext_destroy(ctmp,i);
         }
         p->ocontexts[i] = NULL;
+        xfree(p->ocon_index[i].ent);
+        p->ocon_index[i].ent = NULL;
+        p->ocon_index[i].nel = 0;
     }
 
     cond_policydb_destroy(p);
@@ -2084,6 +2244,9 @@ int policydb_read(struct policydb *p, void *fp)
         }
     }
 
+    for ( i = OCON_PIRQ; i <= OCON_DEVICE; i++ )
+        policydb_index_ocontext(p, i);
+
     rc = next_entry(buf, fp, sizeof(u32));
     if ( rc < 0 )
         goto bad;
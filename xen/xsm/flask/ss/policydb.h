@@ -163,6 +163,16 @@ struct ocontext {
     struct ocontext *next;
 };
 
+/*
+ * The PIRQ, IOPORT, IOMEM and DEVICE ocontexts, sorted by their low bound
+ * for binary search.  Only built when no two entries overlap; otherwise,
+ * or if it could not be allocated, ent is NULL and the list is scanned.
+ */
+struct ocontext_index {
+    struct ocontext **ent;
+    u32 nel;
+};
+
 /* symbol table array indices */
 #define SYM_COMMONS 0
 #define SYM_CLASSES 1
@@ -232,6 +242,7 @@ struct policydb {
     /* security contexts of initial SIDs, unlabeled file systems,
        TCP or UDP port numbers, network interfaces and nodes */
     struct ocontext *ocontexts[OCON_NUM];
+    struct ocontext_index ocon_index[OCON_NUM];
 
     /* range transitions */
     struct range_trans *range_tr;
@@ -255,6 +266,9 @@ extern int policydb_class_isvalid(struct policydb *p, unsigned int class);
 extern int policydb_type_isvalid(struct policydb *p, unsigned int type);
 extern int policydb_role_isvalid(struct policydb *p, unsigned int role);
 extern int policydb_read(struct policydb *p, void *fp);
+extern void policydb_index_ocontext(struct policydb *p, int ocon);
+extern struct ocontext *policydb_ocontext_lookup(struct policydb *p, int ocon,
+                                                 unsigned long key);
 
 #define PERM_SYMTAB_SIZE 32
 
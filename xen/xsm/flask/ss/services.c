@@ -1399,8 +1399,8 @@ static int security_preserve_bools(struct policydb *p);
  *
  * Load a new set of security policy configuration data,
  * validate it and convert the SID table as necessary.
- * This function will flush the access vector cache after
- * loading the new policy.
+ * This function will revalidate the access vector cache after
+ * loading the new policy, dropping the decisions that changed.
  */
 int security_load_policy(void *data, size_t len)
 {
@@ -1501,7 +1501,7 @@ int security_load_policy(void *data, size_t len)
     policydb_destroy(&oldpolicydb);
     sidtab_destroy(&oldsidtab);
 
-    avc_ss_reset(seqno);
+    avc_ss_revalidate(seqno);
 
     return 0;
 
@@ -1525,14 +1525,7 @@ int security_pirq_sid(int pirq, u32 *out_sid)
 
     POLICY_RDLOCK;
 
-    c = policydb.ocontexts[OCON_PIRQ];
-    
-    while ( c )
-    {
-        if ( c->u.pirq == pirq )
-            break;
-        c = c->next;
-    }
+    c = policydb_ocontext_lookup(&policydb, OCON_PIRQ, pirq);
 
     if ( c )
     {
@@ -1566,13 +1559,7 @@ int security_iomem_sid(unsigned long mfn, u32 *out_sid)
 
     POLICY_RDLOCK;
 
-    c = policydb.ocontexts[OCON_IOMEM];
-    while ( c )
-    {
-        if ( c->u.iomem.low_iomem <= mfn  && c->u.iomem.high_iomem >= mfn )
-            break;
-        c = c->next;
-    }
+    c = policydb_ocontext_lookup(&policydb, OCON_IOMEM, mfn);
 
     if ( c )
     {
@@ -1606,14 +1593,7 @@ int security_ioport_sid(u32 ioport, u32 *out_sid)
 
     POLICY_RDLOCK;
 
-    c = policydb.ocontexts[OCON_IOPORT];
-    while ( c )
-    {
-        if ( c->u.ioport.low_ioport <= ioport &&
-             c->u.ioport.high_ioport >= ioport )
-            break;
-        c = c->next;
-    }
+    c = policydb_ocontext_lookup(&policydb, OCON_IOPORT, ioport);
 
     if ( c )
     {
@@ -1647,13 +1627,7 @@ int security_device_sid(u32 device, u32 *out_sid)
 
     POLICY_RDLOCK;
 
-    c = policydb.ocontexts[OCON_DEVICE];
-    while ( c )
-    {
-        if ( c->u.device == device )
-            break;
-        c = c->next;
-    }
+    c = policydb_ocontext_lookup(&policydb, OCON_DEVICE, device);
 
     if ( c )
     {
@@ -1884,7 +1858,7 @@ out:
     POLICY_WRUNLOCK;
     if ( !rc )
     {
-        avc_ss_reset(seqno);
+        avc_ss_revalidate(seqno);
     }
     return rc;
 }
@@ -2085,6 +2059,8 @@ int security_ocontext_add( char *ocontext, unsigned long low, unsigned long high
      default:
          ret = -EINVAL;
     }
+    if ( ret == 0 )
+        policydb_index_ocontext(&policydb, ocon);
     POLICY_WRUNLOCK;
 
     if ( ret != 0 )
@@ -2213,6 +2189,8 @@ int security_ocontext_del( char *ocontext, unsigned int low, unsigned int high )
     }
 
   out:
+    if ( ret == 0 )
+        policydb_index_ocontext(&policydb, ocon);
     POLICY_WRUNLOCK;
     return ret;
 }